@@ -0,0 +1,362 @@
+//***************************************************************************************
+// AabbBatch.cpp
+//***************************************************************************************
+
+#include "AabbBatch.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace
+{
+	// Blocks of four boxes handled by one job before it is worth splitting off another.
+	const std::size_t MinBlocksPerThread = 512;
+
+	// One range per thread taking part: the pool's workers plus the calling thread.
+	std::size_t WorkerCount(std::size_t count, std::size_t minPerWorker, const JobSystem* jobs)
+	{
+		std::size_t threads = (jobs != nullptr) ? jobs->WorkerCount() + 1 : 1;
+		return std::min(threads, std::max<std::size_t>(1, count / minPerWorker));
+	}
+
+	// Splits [0, count) into one contiguous range per worker and runs
+	// fn(begin, end, worker) on each, on jobs if there is more than one range.
+	template<typename Fn>
+	void ParallelFor(std::size_t count, std::size_t workers, JobSystem* jobs, Fn&& fn)
+	{
+		std::size_t perWorker = (count + workers - 1) / workers;
+		auto runRange = [&fn, count, perWorker](std::uint32_t w)
+		{
+			std::size_t begin = std::min(count, w*perWorker);
+			std::size_t end = std::min(count, begin + perWorker);
+			fn(begin, end, (std::size_t)w);
+		};
+
+		if(workers > 1)
+		{
+			assert(jobs != nullptr);
+			jobs->ParallelFor((std::uint32_t)workers, runRange);
+		}
+		else
+		{
+			runRange(0);
+		}
+	}
+
+	BoundingBox MakeBox(const float mn[3], const float mx[3])
+	{
+		BoundingBox box;
+		if(mn[0] > mx[0])
+		{
+			box.Center = XMFLOAT3(0.0f, 0.0f, 0.0f);
+			box.Extents = XMFLOAT3(0.0f, 0.0f, 0.0f);
+			return box;
+		}
+
+		box.Center = XMFLOAT3(0.5f*(mn[0] + mx[0]), 0.5f*(mn[1] + mx[1]), 0.5f*(mn[2] + mx[2]));
+		box.Extents = XMFLOAT3(0.5f*(mx[0] - mn[0]), 0.5f*(mx[1] - mn[1]), 0.5f*(mx[2] - mn[2]));
+		return box;
+	}
+
+	inline XMVECTOR XM_CALLCONV Load4(const std::vector<float>& v, std::size_t i)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&v[i]));
+	}
+
+	inline void XM_CALLCONV Store4(std::vector<float>& v, std::size_t i, FXMVECTOR x)
+	{
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&v[i]), x);
+	}
+}
+
+std::uint32_t AabbBatch::Add(const BoundingBox& localBounds, const XMFLOAT4X4& world, std::int32_t parent)
+{
+	std::uint32_t index = (std::uint32_t)mCount++;
+
+	// Grow by a whole block so the SIMD loops never read past the end.
+	if(index % 4 == 0)
+	{
+		std::size_t padded = index + 4;
+		for(int i = 0; i < 3; ++i)
+		{
+			mLocalCenter[i].resize(padded, 0.0f);
+			mLocalExtents[i].resize(padded, 0.0f);
+			mWorldCenter[i].resize(padded, 0.0f);
+			mWorldExtents[i].resize(padded, 0.0f);
+		}
+		for(int i = 0; i < 12; ++i)
+			mWorld[i].resize(padded, 0.0f);
+
+		mBlockDirty.push_back(0);
+	}
+
+	mParents.push_back(parent);
+
+	SetLocalBounds(index, localBounds);
+	SetWorld(index, world);
+
+	return index;
+}
+
+void AabbBatch::Clear()
+{
+	mCount = 0;
+	for(int i = 0; i < 3; ++i)
+	{
+		mLocalCenter[i].clear();
+		mLocalExtents[i].clear();
+		mWorldCenter[i].clear();
+		mWorldExtents[i].clear();
+	}
+	for(int i = 0; i < 12; ++i)
+		mWorld[i].clear();
+
+	mParents.clear();
+	mBlockDirty.clear();
+	mDirtyBlocks.clear();
+	mLastUpdateCount = 0;
+}
+
+void AabbBatch::SetWorld(std::uint32_t index, const XMFLOAT4X4& world)
+{
+	assert(index < mCount);
+
+	for(int r = 0; r < 4; ++r)
+	{
+		for(int c = 0; c < 3; ++c)
+			mWorld[r*3 + c][index] = world.m[r][c];
+	}
+
+	MarkDirty(index);
+}
+
+void AabbBatch::SetLocalBounds(std::uint32_t index, const BoundingBox& localBounds)
+{
+	assert(index < mCount);
+
+	mLocalCenter[0][index] = localBounds.Center.x;
+	mLocalCenter[1][index] = localBounds.Center.y;
+	mLocalCenter[2][index] = localBounds.Center.z;
+	mLocalExtents[0][index] = localBounds.Extents.x;
+	mLocalExtents[1][index] = localBounds.Extents.y;
+	mLocalExtents[2][index] = localBounds.Extents.z;
+
+	MarkDirty(index);
+}
+
+void AabbBatch::SetParent(std::uint32_t index, std::int32_t parent)
+{
+	assert(index < mCount);
+	mParents[index] = parent;
+}
+
+void AabbBatch::MarkDirty(std::uint32_t index)
+{
+	std::size_t block = index / 4;
+	if(!mBlockDirty[block])
+	{
+		mBlockDirty[block] = 1;
+		mDirtyBlocks.push_back((std::uint32_t)block);
+	}
+}
+
+void AabbBatch::TransformBlock(std::size_t block)
+{
+	std::size_t i = block*4;
+
+	XMVECTOR c[3] = { Load4(mLocalCenter[0], i), Load4(mLocalCenter[1], i), Load4(mLocalCenter[2], i) };
+	XMVECTOR e[3] = { Load4(mLocalExtents[0], i), Load4(mLocalExtents[1], i), Load4(mLocalExtents[2], i) };
+
+	for(int col = 0; col < 3; ++col)
+	{
+		XMVECTOR m0 = Load4(mWorld[0*3 + col], i);
+		XMVECTOR m1 = Load4(mWorld[1*3 + col], i);
+		XMVECTOR m2 = Load4(mWorld[2*3 + col], i);
+		XMVECTOR t  = Load4(mWorld[3*3 + col], i);
+
+		// Row-vector convention: p' = p*M.
+		XMVECTOR wc = XMVectorMultiplyAdd(c[0], m0, t);
+		wc = XMVectorMultiplyAdd(c[1], m1, wc);
+		wc = XMVectorMultiplyAdd(c[2], m2, wc);
+
+		XMVECTOR we = XMVectorMultiply(e[0], XMVectorAbs(m0));
+		we = XMVectorMultiplyAdd(e[1], XMVectorAbs(m1), we);
+		we = XMVectorMultiplyAdd(e[2], XMVectorAbs(m2), we);
+
+		Store4(mWorldCenter[col], i, wc);
+		Store4(mWorldExtents[col], i, we);
+	}
+}
+
+void AabbBatch::Update(UpdateMode mode, JobSystem* jobs)
+{
+	if(mode == UpdateMode::Full)
+	{
+		std::size_t blockCount = mBlockDirty.size();
+		ParallelFor(blockCount, WorkerCount(blockCount, MinBlocksPerThread, jobs), jobs, [this](std::size_t begin, std::size_t end, std::size_t)
+		{
+			for(std::size_t b = begin; b < end; ++b)
+				TransformBlock(b);
+		});
+		mLastUpdateCount = blockCount*4;
+	}
+	else
+	{
+		std::size_t blockCount = mDirtyBlocks.size();
+		ParallelFor(blockCount, WorkerCount(blockCount, MinBlocksPerThread, jobs), jobs, [this](std::size_t begin, std::size_t end, std::size_t)
+		{
+			for(std::size_t b = begin; b < end; ++b)
+				TransformBlock(mDirtyBlocks[b]);
+		});
+		mLastUpdateCount = blockCount*4;
+	}
+
+	for(std::uint32_t block : mDirtyBlocks)
+		mBlockDirty[block] = 0;
+	mDirtyBlocks.clear();
+}
+
+BoundingBox AabbBatch::GetWorldBounds(std::uint32_t index)const
+{
+	assert(index < mCount);
+
+	BoundingBox box;
+	box.Center = XMFLOAT3(mWorldCenter[0][index], mWorldCenter[1][index], mWorldCenter[2][index]);
+	box.Extents = XMFLOAT3(mWorldExtents[0][index], mWorldExtents[1][index], mWorldExtents[2][index]);
+	return box;
+}
+
+std::int32_t AabbBatch::GetParent(std::uint32_t index)const
+{
+	assert(index < mCount);
+	return mParents[index];
+}
+
+std::size_t AabbBatch::Size()const
+{
+	return mCount;
+}
+
+std::size_t AabbBatch::LastUpdateCount()const
+{
+	return mLastUpdateCount;
+}
+
+BoundingBox AabbBatch::MergeAll(JobSystem* jobs)const
+{
+	float mn[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float mx[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	// Full blocks are reduced four lanes at a time; the trailing partial block (whose
+	// padding lanes hold no real box) is handled below.
+	std::size_t fullBlocks = mCount / 4;
+	std::size_t workers = WorkerCount(fullBlocks, MinBlocksPerThread, jobs);
+	std::vector<XMFLOAT4> partial(workers*6);
+
+	ParallelFor(fullBlocks, workers, jobs, [&](std::size_t begin, std::size_t end, std::size_t w)
+	{
+		XMVECTOR vmin[3], vmax[3];
+		for(int k = 0; k < 3; ++k)
+		{
+			vmin[k] = XMVectorReplicate(FLT_MAX);
+			vmax[k] = XMVectorReplicate(-FLT_MAX);
+		}
+
+		for(std::size_t b = begin; b < end; ++b)
+		{
+			for(int k = 0; k < 3; ++k)
+			{
+				XMVECTOR c = Load4(mWorldCenter[k], b*4);
+				XMVECTOR e = Load4(mWorldExtents[k], b*4);
+				vmin[k] = XMVectorMin(vmin[k], XMVectorSubtract(c, e));
+				vmax[k] = XMVectorMax(vmax[k], XMVectorAdd(c, e));
+			}
+		}
+
+		for(int k = 0; k < 3; ++k)
+		{
+			XMStoreFloat4(&partial[w*6 + k], vmin[k]);
+			XMStoreFloat4(&partial[w*6 + 3 + k], vmax[k]);
+		}
+	});
+
+	for(std::size_t w = 0; w < workers; ++w)
+	{
+		for(int k = 0; k < 3; ++k)
+		{
+			const XMFLOAT4& a = partial[w*6 + k];
+			const XMFLOAT4& b = partial[w*6 + 3 + k];
+			mn[k] = std::min(mn[k], std::min(std::min(a.x, a.y), std::min(a.z, a.w)));
+			mx[k] = std::max(mx[k], std::max(std::max(b.x, b.y), std::max(b.z, b.w)));
+		}
+	}
+
+	for(std::size_t i = fullBlocks*4; i < mCount; ++i)
+	{
+		for(int k = 0; k < 3; ++k)
+		{
+			mn[k] = std::min(mn[k], mWorldCenter[k][i] - mWorldExtents[k][i]);
+			mx[k] = std::max(mx[k], mWorldCenter[k][i] + mWorldExtents[k][i]);
+		}
+	}
+
+	return MakeBox(mn, mx);
+}
+
+void AabbBatch::MergeIntoParents(std::uint32_t parentCount, std::vector<BoundingBox>& parentBounds,
+	JobSystem* jobs)const
+{
+	// Each worker accumulates min/max for every parent, then the partial results are
+	// reduced.  Layout: [worker][parent][min xyz, max xyz].  The per-box work is
+	// scalar, so the range is split over boxes rather than blocks.
+	std::size_t workers = WorkerCount(mCount, MinBlocksPerThread*4, jobs);
+	std::size_t stride = (std::size_t)parentCount*6;
+	std::vector<float> partial(workers*stride);
+	for(std::size_t w = 0; w < workers; ++w)
+	{
+		for(std::uint32_t p = 0; p < parentCount; ++p)
+		{
+			float* acc = &partial[w*stride + p*6];
+			acc[0] = acc[1] = acc[2] = FLT_MAX;
+			acc[3] = acc[4] = acc[5] = -FLT_MAX;
+		}
+	}
+
+	ParallelFor(mCount, workers, jobs, [&](std::size_t begin, std::size_t end, std::size_t w)
+	{
+		float* base = &partial[w*stride];
+		for(std::size_t i = begin; i < end; ++i)
+		{
+			std::int32_t p = mParents[i];
+			if(p < 0 || (std::uint32_t)p >= parentCount)
+				continue;
+
+			float* acc = base + p*6;
+			for(int k = 0; k < 3; ++k)
+			{
+				acc[k]     = std::min(acc[k], mWorldCenter[k][i] - mWorldExtents[k][i]);
+				acc[3 + k] = std::max(acc[3 + k], mWorldCenter[k][i] + mWorldExtents[k][i]);
+			}
+		}
+	});
+
+	parentBounds.resize(parentCount);
+	for(std::uint32_t p = 0; p < parentCount; ++p)
+	{
+		float mn[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float mx[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for(std::size_t w = 0; w < workers; ++w)
+		{
+			const float* acc = &partial[w*stride + p*6];
+			for(int k = 0; k < 3; ++k)
+			{
+				mn[k] = std::min(mn[k], acc[k]);
+				mx[k] = std::max(mx[k], acc[3 + k]);
+			}
+		}
+		parentBounds[p] = MakeBox(mn, mx);
+	}
+}
@@ -0,0 +1,85 @@
+//***************************************************************************************
+// AabbBatch.h
+//
+// Structure-of-arrays container for transforming many axis-aligned bounding boxes into
+// world space at once.  Boxes are processed four at a time using Arvo's method:
+//
+//   worldCenter  = localCenter*M
+//   worldExtents = localExtents*|M|   (|M| is the upper 3x3 with absolute values)
+//
+// Boxes are grouped into blocks of four.  SetWorld and SetLocalBounds mark the
+// owning block dirty so UpdateMode::Incremental only re-transforms blocks whose
+// inputs changed since the previous Update.
+//
+// Update and the merges split large batches over a JobSystem if given one, and run on
+// the calling thread otherwise.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+class AabbBatch
+{
+public:
+	enum class UpdateMode
+	{
+		Full,        // Transform every box.
+		Incremental  // Transform only blocks touched since the last Update.
+	};
+
+	// Adds a box given in local space and returns its index.  parent is an arbitrary
+	// caller-defined group id used by MergeIntoParents; -1 means no parent.
+	std::uint32_t Add(const DirectX::BoundingBox& localBounds, const DirectX::XMFLOAT4X4& world, std::int32_t parent = -1);
+	void Clear();
+
+	void SetWorld(std::uint32_t index, const DirectX::XMFLOAT4X4& world);
+	void SetLocalBounds(std::uint32_t index, const DirectX::BoundingBox& localBounds);
+	void SetParent(std::uint32_t index, std::int32_t parent);
+
+	void Update(UpdateMode mode = UpdateMode::Incremental, JobSystem* jobs = nullptr);
+
+	DirectX::BoundingBox GetWorldBounds(std::uint32_t index)const;
+	std::int32_t GetParent(std::uint32_t index)const;
+	std::size_t Size()const;
+
+	// Number of boxes transformed by the most recent Update (rounded up to whole blocks).
+	std::size_t LastUpdateCount()const;
+
+	// Union of all world-space boxes.  Returns a box with zero extents if empty.
+	DirectX::BoundingBox MergeAll(JobSystem* jobs = nullptr)const;
+
+	// Unions the world-space boxes of each parent id in [0, parentCount).  Boxes with
+	// other parent ids are ignored.  Parents with no children get zero extents.
+	void MergeIntoParents(std::uint32_t parentCount, std::vector<DirectX::BoundingBox>& parentBounds,
+		JobSystem* jobs = nullptr)const;
+
+private:
+	void MarkDirty(std::uint32_t index);
+	void TransformBlock(std::size_t block);
+
+private:
+	std::size_t mCount = 0;
+
+	// All arrays are padded to a multiple of four entries.
+	std::vector<float> mLocalCenter[3];
+	std::vector<float> mLocalExtents[3];
+
+	// Rows 0-2 (upper 3x3) and row 3 (translation) of the world matrix, one array
+	// per element: mWorld[row*3 + column].
+	std::vector<float> mWorld[12];
+
+	std::vector<float> mWorldCenter[3];
+	std::vector<float> mWorldExtents[3];
+
+	std::vector<std::int32_t> mParents;
+
+	std::vector<std::uint8_t> mBlockDirty;
+	std::vector<std::uint32_t> mDirtyBlocks;
+	std::size_t mLastUpdateCount = 0;
+};
@@ -0,0 +1,1022 @@
+//***************************************************************************************
+// BCDecoder.cpp
+//***************************************************************************************
+
+#include "BCDecoder.h"
+#include "JobSystem.h"
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+using namespace DirectX;
+
+namespace
+{
+	void Unpack565(std::uint32_t c, std::uint32_t* rgb)
+	{
+		std::uint32_t r = (c >> 11) & 31;
+		std::uint32_t g = (c >> 5) & 63;
+		std::uint32_t b = c & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	// The color block of BC1-3.  BC2 and BC3 always use four colors.  Interpolants are
+	// rounded to nearest, as the reference rasterizer computes them.
+	void DecodeColorBlock(const std::uint8_t* block, std::uint8_t* rgba, bool allowThreeColor)
+	{
+		std::uint32_t c0 = block[0] | (block[1] << 8);
+		std::uint32_t c1 = block[2] | (block[3] << 8);
+
+		std::uint32_t palette[4][4];
+		Unpack565(c0, palette[0]);
+		Unpack565(c1, palette[1]);
+		palette[0][3] = palette[1][3] = 255;
+
+		if(c0 > c1 || !allowThreeColor)
+		{
+			for(int i = 0; i < 3; ++i)
+			{
+				palette[2][i] = (2 * palette[0][i] + palette[1][i] + 1) / 3;
+				palette[3][i] = (palette[0][i] + 2 * palette[1][i] + 1) / 3;
+			}
+			palette[2][3] = palette[3][3] = 255;
+		}
+		else
+		{
+			for(int i = 0; i < 3; ++i)
+			{
+				palette[2][i] = (palette[0][i] + palette[1][i] + 1) / 2;
+				palette[3][i] = 0;
+			}
+			palette[2][3] = 255;
+			palette[3][3] = 0;
+		}
+
+		std::uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((std::uint32_t)block[7] << 24);
+		for(int p = 0; p < 16; ++p, indices >>= 2)
+		{
+			const std::uint32_t* color = palette[indices & 3];
+			for(int i = 0; i < 4; ++i)
+				rgba[4 * p + i] = (std::uint8_t)color[i];
+		}
+	}
+
+	// BC4 SNORM, into every fourth float.  -128 reads as -127, so both ends are exact.
+	void DecodeSignedAlphaBlock(const std::uint8_t* block, float* dest)
+	{
+		float a0 = std::max((float)(std::int8_t)block[0], -127.0f) / 127.0f;
+		float a1 = std::max((float)(std::int8_t)block[1], -127.0f) / 127.0f;
+
+		float palette[8] = { a0, a1 };
+		if((std::int8_t)block[0] > (std::int8_t)block[1])
+		{
+			for(int i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * a0 + i * a1) / 7.0f;
+		}
+		else
+		{
+			for(int i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * a0 + i * a1) / 5.0f;
+			palette[6] = -1.0f;
+			palette[7] = 1.0f;
+		}
+
+		std::uint64_t indices = 0;
+		for(int i = 0; i < 6; ++i)
+			indices |= (std::uint64_t)block[2 + i] << (8 * i);
+
+		for(int p = 0; p < 16; ++p, indices >>= 3)
+			dest[4 * p] = palette[indices & 7];
+	}
+
+	// The 128 bits of a BC6H or BC7 block, read least significant bit first.
+	class BlockBits
+	{
+	public:
+		explicit BlockBits(const std::uint8_t* block)
+		{
+			for(int i = 0; i < 8; ++i)
+			{
+				mLow |= (std::uint64_t)block[i] << (8 * i);
+				mHigh |= (std::uint64_t)block[8 + i] << (8 * i);
+			}
+		}
+
+		// count is at most 16.
+		std::uint32_t Read(std::uint32_t count)
+		{
+			std::uint64_t v;
+			if(mPosition >= 64)
+				v = mHigh >> (mPosition - 64);
+			else if(mPosition + count <= 64)
+				v = mLow >> mPosition;
+			else
+				v = (mLow >> mPosition) | (mHigh << (64 - mPosition));
+
+			mPosition += count;
+			return (std::uint32_t)v & ((1u << count) - 1);
+		}
+
+	private:
+		std::uint64_t mLow = 0;
+		std::uint64_t mHigh = 0;
+		std::uint32_t mPosition = 0;
+	};
+
+	// Subset of each pixel for the 64 two- and three-subset partitions of BC6H and BC7.
+	const std::uint8_t Partitions2[64][16] =
+	{
+		{ 0,0,1,1, 0,0,1,1, 0,0,1,1, 0,0,1,1 }, { 0,0,0,1, 0,0,0,1, 0,0,0,1, 0,0,0,1 },
+		{ 0,1,1,1, 0,1,1,1, 0,1,1,1, 0,1,1,1 }, { 0,0,0,1, 0,0,1,1, 0,0,1,1, 0,1,1,1 },
+		{ 0,0,0,0, 0,0,0,1, 0,0,0,1, 0,0,1,1 }, { 0,0,1,1, 0,1,1,1, 0,1,1,1, 1,1,1,1 },
+		{ 0,0,0,1, 0,0,1,1, 0,1,1,1, 1,1,1,1 }, { 0,0,0,0, 0,0,0,1, 0,0,1,1, 0,1,1,1 },
+		{ 0,0,0,0, 0,0,0,0, 0,0,0,1, 0,0,1,1 }, { 0,0,1,1, 0,1,1,1, 1,1,1,1, 1,1,1,1 },
+		{ 0,0,0,0, 0,0,0,1, 0,1,1,1, 1,1,1,1 }, { 0,0,0,0, 0,0,0,0, 0,0,0,1, 0,1,1,1 },
+		{ 0,0,0,1, 0,1,1,1, 1,1,1,1, 1,1,1,1 }, { 0,0,0,0, 0,0,0,0, 1,1,1,1, 1,1,1,1 },
+		{ 0,0,0,0, 1,1,1,1, 1,1,1,1, 1,1,1,1 }, { 0,0,0,0, 0,0,0,0, 0,0,0,0, 1,1,1,1 },
+		{ 0,0,0,0, 1,0,0,0, 1,1,1,0, 1,1,1,1 }, { 0,1,1,1, 0,0,0,1, 0,0,0,0, 0,0,0,0 },
+		{ 0,0,0,0, 0,0,0,0, 1,0,0,0, 1,1,1,0 }, { 0,1,1,1, 0,0,1,1, 0,0,0,1, 0,0,0,0 },
+		{ 0,0,1,1, 0,0,0,1, 0,0,0,0, 0,0,0,0 }, { 0,0,0,0, 1,0,0,0, 1,1,0,0, 1,1,1,0 },
+		{ 0,0,0,0, 0,0,0,0, 1,0,0,0, 1,1,0,0 }, { 0,1,1,1, 0,0,1,1, 0,0,1,1, 0,0,0,1 },
+		{ 0,0,1,1, 0,0,0,1, 0,0,0,1, 0,0,0,0 }, { 0,0,0,0, 1,0,0,0, 1,0,0,0, 1,1,0,0 },
+		{ 0,1,1,0, 0,1,1,0, 0,1,1,0, 0,1,1,0 }, { 0,0,1,1, 0,1,1,0, 0,1,1,0, 1,1,0,0 },
+		{ 0,0,0,1, 0,1,1,1, 1,1,1,0, 1,0,0,0 }, { 0,0,0,0, 1,1,1,1, 1,1,1,1, 0,0,0,0 },
+		{ 0,1,1,1, 0,0,0,1, 1,0,0,0, 1,1,1,0 }, { 0,0,1,1, 1,0,0,1, 1,0,0,1, 1,1,0,0 },
+		{ 0,1,0,1, 0,1,0,1, 0,1,0,1, 0,1,0,1 }, { 0,0,0,0, 1,1,1,1, 0,0,0,0, 1,1,1,1 },
+		{ 0,1,0,1, 1,0,1,0, 0,1,0,1, 1,0,1,0 }, { 0,0,1,1, 0,0,1,1, 1,1,0,0, 1,1,0,0 },
+		{ 0,0,1,1, 1,1,0,0, 0,0,1,1, 1,1,0,0 }, { 0,1,0,1, 0,1,0,1, 1,0,1,0, 1,0,1,0 },
+		{ 0,1,1,0, 1,0,0,1, 0,1,1,0, 1,0,0,1 }, { 0,1,0,1, 1,0,1,0, 1,0,1,0, 0,1,0,1 },
+		{ 0,1,1,1, 0,0,1,1, 1,1,0,0, 1,1,1,0 }, { 0,0,0,1, 0,0,1,1, 1,1,0,0, 1,0,0,0 },
+		{ 0,0,1,1, 0,0,1,0, 0,1,0,0, 1,1,0,0 }, { 0,0,1,1, 1,0,1,1, 1,1,0,1, 1,1,0,0 },
+		{ 0,1,1,0, 1,0,0,1, 1,0,0,1, 0,1,1,0 }, { 0,0,1,1, 1,1,0,0, 1,1,0,0, 0,0,1,1 },
+		{ 0,1,1,0, 0,1,1,0, 1,0,0,1, 1,0,0,1 }, { 0,0,0,0, 0,1,1,0, 0,1,1,0, 0,0,0,0 },
+		{ 0,1,0,0, 1,1,1,0, 0,1,0,0, 0,0,0,0 }, { 0,0,1,0, 0,1,1,1, 0,0,1,0, 0,0,0,0 },
+		{ 0,0,0,0, 0,0,1,0, 0,1,1,1, 0,0,1,0 }, { 0,0,0,0, 0,1,0,0, 1,1,1,0, 0,1,0,0 },
+		{ 0,1,1,0, 1,1,0,0, 1,0,0,1, 0,0,1,1 }, { 0,0,1,1, 0,1,1,0, 1,1,0,0, 1,0,0,1 },
+		{ 0,1,1,0, 0,0,1,1, 1,0,0,1, 1,1,0,0 }, { 0,0,1,1, 1,0,0,1, 1,1,0,0, 0,1,1,0 },
+		{ 0,1,1,0, 1,1,0,0, 1,1,0,0, 1,0,0,1 }, { 0,1,1,0, 0,0,1,1, 0,0,1,1, 1,0,0,1 },
+		{ 0,1,1,1, 1,1,1,0, 1,0,0,0, 0,0,0,1 }, { 0,0,0,1, 1,0,0,0, 1,1,1,0, 0,1,1,1 },
+		{ 0,0,0,0, 1,1,1,1, 0,0,1,1, 0,0,1,1 }, { 0,0,1,1, 0,0,1,1, 1,1,1,1, 0,0,0,0 },
+		{ 0,0,1,0, 0,0,1,0, 1,1,1,0, 1,1,1,0 }, { 0,1,0,0, 0,1,0,0, 0,1,1,1, 0,1,1,1 }
+	};
+
+	const std::uint8_t Partitions3[64][16] =
+	{
+		{ 0,0,1,1, 0,0,1,1, 0,2,2,1, 2,2,2,2 }, { 0,0,0,1, 0,0,1,1, 2,2,1,1, 2,2,2,1 },
+		{ 0,0,0,0, 2,0,0,1, 2,2,1,1, 2,2,1,1 }, { 0,2,2,2, 0,0,2,2, 0,0,1,1, 0,1,1,1 },
+		{ 0,0,0,0, 0,0,0,0, 1,1,2,2, 1,1,2,2 }, { 0,0,1,1, 0,0,1,1, 0,0,2,2, 0,0,2,2 },
+		{ 0,0,2,2, 0,0,2,2, 1,1,1,1, 1,1,1,1 }, { 0,0,1,1, 0,0,1,1, 2,2,1,1, 2,2,1,1 },
+		{ 0,0,0,0, 0,0,0,0, 1,1,1,1, 2,2,2,2 }, { 0,0,0,0, 1,1,1,1, 1,1,1,1, 2,2,2,2 },
+		{ 0,0,0,0, 1,1,1,1, 2,2,2,2, 2,2,2,2 }, { 0,0,1,2, 0,0,1,2, 0,0,1,2, 0,0,1,2 },
+		{ 0,1,1,2, 0,1,1,2, 0,1,1,2, 0,1,1,2 }, { 0,1,2,2, 0,1,2,2, 0,1,2,2, 0,1,2,2 },
+		{ 0,0,1,1, 0,1,1,2, 1,1,2,2, 1,2,2,2 }, { 0,0,1,1, 2,0,0,1, 2,2,0,0, 2,2,2,0 },
+		{ 0,0,0,1, 0,0,1,1, 0,1,1,2, 1,1,2,2 }, { 0,1,1,1, 0,0,1,1, 2,0,0,1, 2,2,0,0 },
+		{ 0,0,0,0, 1,1,2,2, 1,1,2,2, 1,1,2,2 }, { 0,0,2,2, 0,0,2,2, 0,0,2,2, 1,1,1,1 },
+		{ 0,1,1,1, 0,1,1,1, 0,2,2,2, 0,2,2,2 }, { 0,0,0,1, 0,0,0,1, 2,2,2,1, 2,2,2,1 },
+		{ 0,0,0,0, 0,0,1,1, 0,1,2,2, 0,1,2,2 }, { 0,0,0,0, 1,1,0,0, 2,2,1,0, 2,2,1,0 },
+		{ 0,1,2,2, 0,1,2,2, 0,0,1,1, 0,0,0,0 }, { 0,0,1,2, 0,0,1,2, 1,1,2,2, 2,2,2,2 },
+		{ 0,1,1,0, 1,2,2,1, 1,2,2,1, 0,1,1,0 }, { 0,0,0,0, 0,1,1,0, 1,2,2,1, 1,2,2,1 },
+		{ 0,0,2,2, 1,1,0,2, 1,1,0,2, 0,0,2,2 }, { 0,1,1,0, 0,1,1,0, 2,0,0,2, 2,2,2,2 },
+		{ 0,0,1,1, 0,1,2,2, 0,1,2,2, 0,0,1,1 }, { 0,0,0,0, 2,0,0,0, 2,2,1,1, 2,2,2,1 },
+		{ 0,0,0,0, 0,0,0,2, 1,1,2,2, 1,2,2,2 }, { 0,2,2,2, 0,0,2,2, 0,0,1,2, 0,0,1,1 },
+		{ 0,0,1,1, 0,0,1,2, 0,0,2,2, 0,2,2,2 }, { 0,1,2,0, 0,1,2,0, 0,1,2,0, 0,1,2,0 },
+		{ 0,0,0,0, 1,1,1,1, 2,2,2,2, 0,0,0,0 }, { 0,1,2,0, 1,2,0,1, 2,0,1,2, 0,1,2,0 },
+		{ 0,1,2,0, 2,0,1,2, 1,2,0,1, 0,1,2,0 }, { 0,0,1,1, 2,2,0,0, 1,1,2,2, 0,0,1,1 },
+		{ 0,0,1,1, 1,1,2,2, 2,2,0,0, 0,0,1,1 }, { 0,1,0,1, 0,1,0,1, 2,2,2,2, 2,2,2,2 },
+		{ 0,0,0,0, 0,0,0,0, 2,1,2,1, 2,1,2,1 }, { 0,0,2,2, 1,1,2,2, 0,0,2,2, 1,1,2,2 },
+		{ 0,0,2,2, 0,0,1,1, 0,0,2,2, 0,0,1,1 }, { 0,2,2,0, 1,2,2,1, 0,2,2,0, 1,2,2,1 },
+		{ 0,1,0,1, 2,2,2,2, 2,2,2,2, 0,1,0,1 }, { 0,0,0,0, 2,1,2,1, 2,1,2,1, 2,1,2,1 },
+		{ 0,1,0,1, 0,1,0,1, 0,1,0,1, 2,2,2,2 }, { 0,2,2,2, 0,1,1,1, 0,2,2,2, 0,1,1,1 },
+		{ 0,0,0,2, 1,1,1,2, 0,0,0,2, 1,1,1,2 }, { 0,0,0,0, 2,1,1,2, 2,1,1,2, 2,1,1,2 },
+		{ 0,2,2,2, 0,1,1,1, 0,1,1,1, 0,2,2,2 }, { 0,0,0,2, 1,1,1,2, 1,1,1,2, 0,0,0,2 },
+		{ 0,1,1,0, 0,1,1,0, 0,1,1,0, 2,2,2,2 }, { 0,0,0,0, 0,0,0,0, 2,1,1,2, 2,1,1,2 },
+		{ 0,1,1,0, 0,1,1,0, 2,2,2,2, 2,2,2,2 }, { 0,0,2,2, 0,0,1,1, 0,0,1,1, 0,0,2,2 },
+		{ 0,0,2,2, 1,1,2,2, 1,1,2,2, 0,0,2,2 }, { 0,0,0,0, 0,0,0,0, 0,0,0,0, 2,1,1,2 },
+		{ 0,0,0,2, 0,0,0,1, 0,0,0,2, 0,0,0,1 }, { 0,2,2,2, 1,2,2,2, 0,2,2,2, 1,2,2,2 },
+		{ 0,1,0,1, 2,2,2,2, 2,2,2,2, 2,2,2,2 }, { 0,1,1,1, 2,0,1,1, 2,2,0,1, 2,2,2,0 }
+	};
+
+	// The pixel whose index drops its top bit, for subset 1 of the two-subset
+	// partitions and subsets 1 and 2 of the three-subset ones.  Subset 0's is pixel 0.
+	const std::uint8_t Anchors2[64] =
+	{
+		15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15,
+		15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+		15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,
+		 6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+	};
+
+	const std::uint8_t Anchors3Second[64] =
+	{
+		 3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,
+		 3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+		 8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,
+		 3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3
+	};
+
+	const std::uint8_t Anchors3Third[64] =
+	{
+		15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8,
+		15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+		15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8,
+		15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8
+	};
+
+	const std::uint32_t Weights2[4] = { 0, 21, 43, 64 };
+	const std::uint32_t Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+	const std::uint32_t Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	const std::uint32_t* IndexWeights(std::uint32_t indexBits)
+	{
+		return (indexBits == 2) ? Weights2 : (indexBits == 3) ? Weights3 : Weights4;
+	}
+
+	// Reads 16 indices of indexBits bits; anchor pixels have one bit fewer.
+	void ReadIndices(BlockBits& bits, std::uint32_t indexBits, std::uint32_t subsets, std::uint32_t partition,
+		std::uint32_t* indices)
+	{
+		for(std::uint32_t p = 0; p < 16; ++p)
+		{
+			bool anchor = (p == 0) ||
+				(subsets == 2 && p == Anchors2[partition]) ||
+				(subsets == 3 && (p == Anchors3Second[partition] || p == Anchors3Third[partition]));
+
+			indices[p] = bits.Read(anchor ? indexBits - 1 : indexBits);
+		}
+	}
+
+	const std::uint8_t* PartitionSubsets(std::uint32_t subsets, std::uint32_t partition)
+	{
+		static const std::uint8_t Single[16] = {};
+		return (subsets == 1) ? Single : (subsets == 2) ? Partitions2[partition] : Partitions3[partition];
+	}
+
+	struct Bc7Mode
+	{
+		std::uint8_t Subsets;
+		std::uint8_t PartitionBits;
+		std::uint8_t RotationBits;
+		std::uint8_t IndexSelectionBits;
+		std::uint8_t ColorBits;
+		std::uint8_t AlphaBits;
+		std::uint8_t EndpointPBits; // One p-bit per endpoint.
+		std::uint8_t SharedPBits;   // One p-bit per subset.
+		std::uint8_t IndexBits;
+		std::uint8_t SecondIndexBits;
+	};
+
+	const Bc7Mode Bc7Modes[8] =
+	{
+		{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+		{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+		{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+		{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+		{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+		{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+		{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+		{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+	};
+
+	// Replicates the top bits of a bits-wide value into the low bits of a byte.
+	std::uint32_t Expand(std::uint32_t value, std::uint32_t bits)
+	{
+		value <<= 8 - bits;
+		return value | (value >> bits);
+	}
+
+	// BC6H endpoint fields: endpoint * 3 + channel, and the partition number.
+	enum Bc6hField : std::uint8_t
+	{
+		RW, GW, BW, RX, GX, BX, RY, GY, BY, RZ, GZ, BZ, PartitionField
+	};
+
+	// Count bits of the block go to bits Low.. of Field.
+	struct Bc6hBits
+	{
+		std::uint8_t Field;
+		std::uint8_t Low;
+		std::uint8_t Count;
+	};
+
+	struct Bc6hMode
+	{
+		std::uint8_t Subsets;
+		bool Transformed; // Endpoints after the first are deltas from it.
+		std::uint8_t EndpointBits;
+		std::uint8_t DeltaBits[3];
+		Bc6hBits Layout[32];
+	};
+
+	// Bit layouts in block order after the mode bits, from the BC6H format description.
+	const Bc6hMode Bc6hModes[14] =
+	{
+		{ 2, true, 10, { 5, 5, 5 }, {
+			{ GY,4,1 }, { BY,4,1 }, { BZ,4,1 }, { RW,0,10 }, { GW,0,10 }, { BW,0,10 }, { RX,0,5 }, { GZ,4,1 },
+			{ GY,0,4 }, { GX,0,5 }, { BZ,0,1 }, { GZ,0,4 }, { BX,0,5 }, { BZ,1,1 }, { BY,0,4 }, { RY,0,5 },
+			{ BZ,2,1 }, { RZ,0,5 }, { BZ,3,1 }, { PartitionField,0,5 } } },
+		{ 2, true, 7, { 6, 6, 6 }, {
+			{ GY,5,1 }, { GZ,4,1 }, { GZ,5,1 }, { RW,0,7 }, { BZ,0,1 }, { BZ,1,1 }, { BY,4,1 }, { GW,0,7 },
+			{ BY,5,1 }, { BZ,2,1 }, { GY,4,1 }, { BW,0,7 }, { BZ,3,1 }, { BZ,5,1 }, { BZ,4,1 }, { RX,0,6 },
+			{ GY,0,4 }, { GX,0,6 }, { GZ,0,4 }, { BX,0,6 }, { BY,0,4 }, { RY,0,6 }, { RZ,0,6 }, { PartitionField,0,5 } } },
+		{ 2, true, 11, { 5, 4, 4 }, {
+			{ RW,0,10 }, { GW,0,10 }, { BW,0,10 }, { RX,0,5 }, { RW,10,1 }, { GY,0,4 }, { GX,0,4 }, { GW,10,1 },
+			{ BZ,0,1 }, { GZ,0,4 }, { BX,0,4 }, { BW,10,1 }, { BZ,1,1 }, { BY,0,4 }, { RY,0,5 }, { BZ,2,1 },
+			{ RZ,0,5 }, { BZ,3,1 }, { PartitionField,0,5 } } },
+		{ 2, true, 11, { 4, 5, 4 }, {
+			{ RW,0,10 }, { GW,0,10 }, { BW,0,10 }, { RX,0,4 }, { RW,10,1 }, { GZ,4,1 }, { GY,0,4 }, { GX,0,5 },
+			{ GW,10,1 }, { GZ,0,4 }, { BX,0,4 }, { BW,10,1 }, { BZ,1,1 }, { BY,0,4 }, { RY,0,4 }, { BZ,0,1 },
+			{ BZ,2,1 }, { RZ,0,4 }, { GY,4,1 }, { BZ,3,1 }, { PartitionField,0,5 } } },
+		{ 2, true, 11, { 4, 4, 5 }, {
+			{ RW,0,10 }, { GW,0,10 }, { BW,0,10 }, { RX,0,4 }, { RW,10,1 }, { BY,4,1 }, { GY,0,4 }, { GX,0,4 },
+			{ GW,10,1 }, { BZ,0,1 }, { GZ,0,4 }, { BX,0,5 }, { BW,10,1 }, { BY,0,4 }, { RY,0,4 }, { BZ,1,1 },
+			{ BZ,2,1 }, { RZ,0,4 }, { BZ,4,1 }, { BZ,3,1 }, { PartitionField,0,5 } } },
+		{ 2, true, 9, { 5, 5, 5 }, {
+			{ RW,0,9 }, { BY,4,1 }, { GW,0,9 }, { GY,4,1 }, { BW,0,9 }, { BZ,4,1 }, { RX,0,5 }, { GZ,4,1 },
+			{ GY,0,4 }, { GX,0,5 }, { BZ,0,1 }, { GZ,0,4 }, { BX,0,5 }, { BZ,1,1 }, { BY,0,4 }, { RY,0,5 },
+			{ BZ,2,1 }, { RZ,0,5 }, { BZ,3,1 }, { PartitionField,0,5 } } },
+		{ 2, true, 8, { 6, 5, 5 }, {
+			{ RW,0,8 }, { GZ,4,1 }, { BY,4,1 }, { GW,0,8 }, { BZ,2,1 }, { GY,4,1 }, { BW,0,8 }, { BZ,3,1 },
+			{ BZ,4,1 }, { RX,0,6 }, { GY,0,4 }, { GX,0,5 }, { BZ,0,1 }, { GZ,0,4 }, { BX,0,5 }, { BZ,1,1 },
+			{ BY,0,4 }, { RY,0,6 }, { RZ,0,6 }, { PartitionField,0,5 } } },
+		{ 2, true, 8, { 5, 6, 5 }, {
+			{ RW,0,8 }, { BZ,0,1 }, { BY,4,1 }, { GW,0,8 }, { GY,5,1 }, { GY,4,1 }, { BW,0,8 }, { GZ,5,1 },
+			{ BZ,4,1 }, { RX,0,5 }, { GZ,4,1 }, { GY,0,4 }, { GX,0,6 }, { GZ,0,4 }, { BX,0,5 }, { BZ,1,1 },
+			{ BY,0,4 }, { RY,0,5 }, { BZ,2,1 }, { RZ,0,5 }, { BZ,3,1 }, { PartitionField,0,5 } } },
+		{ 2, true, 8, { 5, 5, 6 }, {
+			{ RW,0,8 }, { BZ,1,1 }, { BY,4,1 }, { GW,0,8 }, { BY,5,1 }, { GY,4,1 }, { BW,0,8 }, { BZ,5,1 },
+			{ BZ,4,1 }, { RX,0,5 }, { GZ,4,1 }, { GY,0,4 }, { GX,0,5 }, { BZ,0,1 }, { GZ,0,4 }, { BX,0,6 },
+			{ BY,0,4 }, { RY,0,5 }, { BZ,2,1 }, { RZ,0,5 }, { BZ,3,1 }, { PartitionField,0,5 } } },
+		{ 2, false, 6, { 6, 6, 6 }, {
+			{ RW,0,6 }, { GZ,4,1 }, { BZ,0,1 }, { BZ,1,1 }, { BY,4,1 }, { GW,0,6 }, { GY,5,1 }, { BY,5,1 },
+			{ BZ,2,1 }, { GY,4,1 }, { BW,0,6 }, { GZ,5,1 }, { BZ,3,1 }, { BZ,5,1 }, { BZ,4,1 }, { RX,0,6 },
+			{ GY,0,4 }, { GX,0,6 }, { GZ,0,4 }, { BX,0,6 }, { BY,0,4 }, { RY,0,6 }, { RZ,0,6 }, { PartitionField,0,5 } } },
+		{ 1, false, 10, { 10, 10, 10 }, {
+			{ RW,0,10 }, { GW,0,10 }, { BW,0,10 }, { RX,0,10 }, { GX,0,10 }, { BX,0,10 } } },
+		{ 1, true, 11, { 9, 9, 9 }, {
+			{ RW,0,10 }, { GW,0,10 }, { BW,0,10 }, { RX,0,9 }, { RW,10,1 }, { GX,0,9 }, { GW,10,1 }, { BX,0,9 },
+			{ BW,10,1 } } },
+		// Modes 12 and 13 store the high bits of the base endpoint in reverse order.
+		{ 1, true, 12, { 8, 8, 8 }, {
+			{ RW,0,10 }, { GW,0,10 }, { BW,0,10 }, { RX,0,8 }, { RW,11,1 }, { RW,10,1 }, { GX,0,8 }, { GW,11,1 },
+			{ GW,10,1 }, { BX,0,8 }, { BW,11,1 }, { BW,10,1 } } },
+		{ 1, true, 16, { 4, 4, 4 }, {
+			{ RW,0,10 }, { GW,0,10 }, { BW,0,10 }, { RX,0,4 }, { RW,15,1 }, { RW,14,1 }, { RW,13,1 }, { RW,12,1 },
+			{ RW,11,1 }, { RW,10,1 }, { GX,0,4 }, { GW,15,1 }, { GW,14,1 }, { GW,13,1 }, { GW,12,1 }, { GW,11,1 },
+			{ GW,10,1 }, { BX,0,4 }, { BW,15,1 }, { BW,14,1 }, { BW,13,1 }, { BW,12,1 }, { BW,11,1 }, { BW,10,1 } } }
+	};
+
+	// Mode of the 5-bit values whose low two bits are 2 or 3; -1 for the reserved ones.
+	const int Bc6hLongModes[32] =
+	{
+		-1, -1, 2, 10, -1, -1, 3, 11, -1, -1, 4, 12, -1, -1, 5, 13,
+		-1, -1, 6, -1, -1, -1, 7, -1, -1, -1, 8, -1, -1, -1, 9, -1
+	};
+
+	std::int32_t SignExtend(std::uint32_t value, std::uint32_t bits)
+	{
+		std::uint32_t sign = 1u << (bits - 1);
+		value &= (sign << 1) - 1;
+		return (std::int32_t)(value ^ sign) - (std::int32_t)sign;
+	}
+
+	std::int32_t Unquantize(std::int32_t value, std::uint32_t bits, bool isSigned)
+	{
+		if(!isSigned)
+		{
+			if(bits >= 15 || value == 0)
+				return value;
+			if(value == (1 << bits) - 1)
+				return 0xffff;
+			return ((value << 16) + 0x8000) >> bits;
+		}
+
+		if(bits >= 16)
+			return value;
+
+		bool negative = value < 0;
+		if(negative)
+			value = -value;
+
+		std::int32_t result;
+		if(value == 0)
+			result = 0;
+		else if(value >= (1 << (bits - 1)) - 1)
+			result = 0x7fff;
+		else
+			result = ((value << 15) + 0x4000) >> (bits - 1);
+
+		return negative ? -result : result;
+	}
+
+	// Scales an interpolated value to the bits of a half.
+	std::uint16_t FinishUnquantize(std::int32_t value, bool isSigned)
+	{
+		if(!isSigned)
+			return (std::uint16_t)((value * 31) >> 6);
+
+		if(value < 0)
+			return (std::uint16_t)(0x8000 | ((-value * 31) >> 5));
+
+		return (std::uint16_t)((value * 31) >> 5);
+	}
+
+	// sRGB to linear for each 8-bit value.
+	const float* SrgbToLinearTable()
+	{
+		struct Table
+		{
+			float Values[256];
+
+			Table()
+			{
+				for(int i = 0; i < 256; ++i)
+				{
+					float c = i / 255.0f;
+					Values[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+				}
+			}
+		};
+
+		static const Table table;
+		return table.Values;
+	}
+
+	// How a format decodes.  Formats within [0, 1] decode to bytes; SNORM and BC6H decode
+	// to floats, which the RGBA8 output maps with Scale and Bias.
+	struct FormatInfo
+	{
+		std::uint32_t BlockSize = 0;
+		void (*DecodeBytes)(const std::uint8_t*, std::uint8_t*) = nullptr;
+		void (*DecodeFloats)(const std::uint8_t*, float*) = nullptr;
+		bool Srgb = false;
+		XMFLOAT4 Scale = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+		XMFLOAT4 Bias = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+	};
+
+	void DecodeBC6HUnsigned(const std::uint8_t* block, float* rgba)
+	{
+		BCDecoder::DecodeBC6HBlock(block, rgba, false);
+	}
+
+	void DecodeBC6HSigned(const std::uint8_t* block, float* rgba)
+	{
+		BCDecoder::DecodeBC6HBlock(block, rgba, true);
+	}
+
+	bool GetFormatInfo(DXGI_FORMAT format, FormatInfo& info)
+	{
+		info.BlockSize = BCDecoder::BlockSize(format);
+
+		switch(format)
+		{
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			info.DecodeBytes = BCDecoder::DecodeBC1Block;
+			break;
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+			info.DecodeBytes = BCDecoder::DecodeBC2Block;
+			break;
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			info.DecodeBytes = BCDecoder::DecodeBC3Block;
+			break;
+		case DXGI_FORMAT_BC4_TYPELESS:
+		case DXGI_FORMAT_BC4_UNORM:
+			info.DecodeBytes = BCDecoder::DecodeBC4Block;
+			break;
+		case DXGI_FORMAT_BC4_SNORM:
+			info.DecodeFloats = BCDecoder::DecodeBC4SBlock;
+			info.Scale = XMFLOAT4(0.5f, 1.0f, 1.0f, 1.0f);
+			info.Bias = XMFLOAT4(0.5f, 0.0f, 0.0f, 0.0f);
+			break;
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+			info.DecodeBytes = BCDecoder::DecodeBC5Block;
+			break;
+		case DXGI_FORMAT_BC5_SNORM:
+			info.DecodeFloats = BCDecoder::DecodeBC5SBlock;
+			info.Scale = XMFLOAT4(0.5f, 0.5f, 1.0f, 1.0f);
+			info.Bias = XMFLOAT4(0.5f, 0.5f, 0.0f, 0.0f);
+			break;
+		case DXGI_FORMAT_BC6H_TYPELESS:
+		case DXGI_FORMAT_BC6H_UF16:
+			info.DecodeFloats = DecodeBC6HUnsigned;
+			break;
+		case DXGI_FORMAT_BC6H_SF16:
+			info.DecodeFloats = DecodeBC6HSigned;
+			break;
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			info.DecodeBytes = BCDecoder::DecodeBC7Block;
+			break;
+		default:
+			return false;
+		}
+
+		// The sRGB variants MakeSRGB produces for block formats.
+		info.Srgb = format == DXGI_FORMAT_BC1_UNORM_SRGB || format == DXGI_FORMAT_BC2_UNORM_SRGB ||
+			format == DXGI_FORMAT_BC3_UNORM_SRGB || format == DXGI_FORMAT_BC7_UNORM_SRGB;
+		return true;
+	}
+
+	void DecodeBlock(const FormatInfo& info, const std::uint8_t* block, std::uint8_t* rgba)
+	{
+		if(info.DecodeBytes != nullptr)
+		{
+			info.DecodeBytes(block, rgba);
+			return;
+		}
+
+		float values[16 * 4];
+		info.DecodeFloats(block, values);
+
+		const XMVECTOR scale = XMLoadFloat4(&info.Scale);
+		const XMVECTOR bias = XMLoadFloat4(&info.Bias);
+		const XMVECTOR max = XMVectorReplicate(255.0f);
+		for(int p = 0; p < 16; ++p)
+		{
+			XMVECTOR v = XMLoadFloat4((const XMFLOAT4*)(values + 4 * p));
+			v = XMVectorMultiplyAdd(v, scale, bias);
+			v = XMVectorRound(XMVectorMultiply(XMVectorSaturate(v), max));
+
+			XMFLOAT4 f;
+			XMStoreFloat4(&f, v);
+			rgba[4 * p + 0] = (std::uint8_t)f.x;
+			rgba[4 * p + 1] = (std::uint8_t)f.y;
+			rgba[4 * p + 2] = (std::uint8_t)f.z;
+			rgba[4 * p + 3] = (std::uint8_t)f.w;
+		}
+	}
+
+	void DecodeBlock(const FormatInfo& info, const std::uint8_t* block, float* rgba)
+	{
+		if(info.DecodeFloats != nullptr)
+		{
+			info.DecodeFloats(block, rgba);
+			return;
+		}
+
+		std::uint8_t bytes[16 * 4];
+		info.DecodeBytes(block, bytes);
+
+		if(info.Srgb)
+		{
+			const float* linear = SrgbToLinearTable();
+			for(int p = 0; p < 16; ++p)
+			{
+				for(int i = 0; i < 3; ++i)
+					rgba[4 * p + i] = linear[bytes[4 * p + i]];
+				rgba[4 * p + 3] = bytes[4 * p + 3] / 255.0f;
+			}
+			return;
+		}
+
+		const XMVECTOR scale = XMVectorReplicate(1.0f / 255.0f);
+		for(int p = 0; p < 16; ++p)
+		{
+			const std::uint8_t* b = bytes + 4 * p;
+			XMVECTOR v = XMVectorSet((float)b[0], (float)b[1], (float)b[2], (float)b[3]);
+			XMStoreFloat4((XMFLOAT4*)(rgba + 4 * p), XMVectorMultiply(v, scale));
+		}
+	}
+
+	// Decodes block row by of a surface into rows y0.. of image.
+	template<typename Image>
+	void DecodeBlockRow(const FormatInfo& info, const std::uint8_t* row, std::uint32_t width, std::uint32_t height,
+		std::uint32_t by, Image& image, std::uint32_t y0)
+	{
+		using Component = typename std::remove_reference<decltype(image.Pixels[0])>::type;
+
+		Component rgba[16 * 4];
+		const std::uint32_t blocksWide = std::max(1u, (width + 3) / 4);
+		for(std::uint32_t bx = 0; bx < blocksWide; ++bx)
+		{
+			DecodeBlock(info, row + bx * info.BlockSize, rgba);
+
+			// Edge blocks hold texels past the surface, which are dropped.
+			for(std::uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+			{
+				std::uint32_t count = std::min(4u, width - bx * 4);
+				std::memcpy(image.Pixel(bx * 4, y0 + by * 4 + y), rgba + 16 * y, 4 * count * sizeof(Component));
+			}
+		}
+	}
+
+	template<typename Image>
+	bool DecodeSurface(DXGI_FORMAT format, const std::uint8_t* bits, std::size_t rowPitch,
+		std::uint32_t width, std::uint32_t height, Image& image, JobSystem* jobs)
+	{
+		FormatInfo info;
+		if(!GetFormatInfo(format, info))
+			return false;
+
+		const std::uint32_t blocksHigh = std::max(1u, (height + 3) / 4);
+		image.Resize(width, height);
+
+		auto decodeRow = [&](std::uint32_t by)
+		{
+			DecodeBlockRow(info, bits + by * rowPitch, width, height, by, image, 0);
+		};
+
+		if(jobs != nullptr)
+		{
+			jobs->ParallelFor(blocksHigh, decodeRow);
+		}
+		else
+		{
+			for(std::uint32_t by = 0; by < blocksHigh; ++by)
+				decodeRow(by);
+		}
+
+		return true;
+	}
+
+	template<typename Image>
+	bool DecodeSubresources(const DDSTextureDesc& desc, const DDSLayout& layout, const std::uint8_t* bits,
+		std::vector<Image>& images, JobSystem* jobs)
+	{
+		FormatInfo info;
+		if(!GetFormatInfo(desc.Format, info))
+			return false;
+
+		// Block rows of every depth slice of every subresource, numbered consecutively.
+		// firstRow[i] is the number of the first row of subresource i.
+		const std::size_t count = layout.Subresources.size();
+		std::vector<std::uint32_t> firstRow(count + 1, 0);
+		images.resize(count);
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			const DDSSubresource& sub = layout.Subresources[i];
+			images[i].Resize(sub.Width, sub.Height * sub.Depth);
+			firstRow[i + 1] = firstRow[i] + (std::uint32_t)sub.NumRows * sub.Depth;
+		}
+
+		auto decodeRow = [&](std::uint32_t row)
+		{
+			std::size_t i = std::upper_bound(firstRow.begin(), firstRow.end(), row) - firstRow.begin() - 1;
+			const DDSSubresource& sub = layout.Subresources[i];
+
+			std::uint32_t local = row - firstRow[i];
+			std::uint32_t slice = local / (std::uint32_t)sub.NumRows;
+			std::uint32_t by = local % (std::uint32_t)sub.NumRows;
+
+			const std::uint8_t* rowBits = bits + sub.Offset + slice * sub.SlicePitch + by * sub.RowPitch;
+			DecodeBlockRow(info, rowBits, sub.Width, sub.Height, by, images[i], slice * sub.Height);
+		};
+
+		if(jobs != nullptr)
+		{
+			jobs->ParallelFor(firstRow[count], decodeRow);
+		}
+		else
+		{
+			for(std::uint32_t row = 0; row < firstRow[count]; ++row)
+				decodeRow(row);
+		}
+
+		return true;
+	}
+}
+
+std::uint32_t BCDecoder::BlockSize(DXGI_FORMAT format)
+{
+	switch(format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		return 8;
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+void BCDecoder::DecodeBC1Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+	DecodeColorBlock(block, rgba, true);
+}
+
+void BCDecoder::DecodeBC2Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+	DecodeColorBlock(block + 8, rgba, false);
+
+	// Explicit 4-bit alpha, two pixels per byte, low nibble first.
+	for(int p = 0; p < 16; ++p)
+	{
+		std::uint32_t a = (block[p / 2] >> (4 * (p & 1))) & 15;
+		rgba[4 * p + 3] = (std::uint8_t)(a * 17);
+	}
+}
+
+void BCDecoder::DecodeBC3Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+	DecodeColorBlock(block + 8, rgba, false);
+	DecodeAlphaBlock(block, rgba + 3);
+}
+
+void BCDecoder::DecodeBC4Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+	for(int p = 0; p < 16; ++p)
+	{
+		rgba[4 * p + 1] = 0;
+		rgba[4 * p + 2] = 0;
+		rgba[4 * p + 3] = 255;
+	}
+	DecodeAlphaBlock(block, rgba);
+}
+
+void BCDecoder::DecodeBC5Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+	for(int p = 0; p < 16; ++p)
+	{
+		rgba[4 * p + 2] = 0;
+		rgba[4 * p + 3] = 255;
+	}
+	DecodeAlphaBlock(block, rgba);
+	DecodeAlphaBlock(block + 8, rgba + 1);
+}
+
+void BCDecoder::DecodeBC7Block(const std::uint8_t* block, std::uint8_t* rgba)
+{
+	BlockBits bits(block);
+
+	// The mode is the position of the lowest set bit.
+	std::uint32_t mode = 0;
+	while(mode < 8 && bits.Read(1) == 0)
+		++mode;
+
+	if(mode == 8)
+	{
+		// Reserved: transparent black.
+		std::memset(rgba, 0, 16 * 4);
+		return;
+	}
+
+	const Bc7Mode& m = Bc7Modes[mode];
+	const std::uint32_t partition = bits.Read(m.PartitionBits);
+	const std::uint32_t rotation = bits.Read(m.RotationBits);
+	const std::uint32_t indexSelection = bits.Read(m.IndexSelectionBits);
+	const std::uint32_t endpointCount = 2u * m.Subsets;
+
+	std::uint32_t endpoints[6][4];
+	for(std::uint32_t c = 0; c < 3; ++c)
+	{
+		for(std::uint32_t e = 0; e < endpointCount; ++e)
+			endpoints[e][c] = bits.Read(m.ColorBits);
+	}
+	for(std::uint32_t e = 0; e < endpointCount; ++e)
+		endpoints[e][3] = (m.AlphaBits != 0) ? bits.Read(m.AlphaBits) : 255;
+
+	std::uint32_t colorBits = m.ColorBits;
+	std::uint32_t alphaBits = m.AlphaBits;
+	if(m.EndpointPBits != 0 || m.SharedPBits != 0)
+	{
+		std::uint32_t pbits[6];
+		if(m.EndpointPBits != 0)
+		{
+			for(std::uint32_t e = 0; e < endpointCount; ++e)
+				pbits[e] = bits.Read(1);
+		}
+		else
+		{
+			for(std::uint32_t s = 0; s < m.Subsets; ++s)
+				pbits[2 * s] = pbits[2 * s + 1] = bits.Read(1);
+		}
+
+		for(std::uint32_t e = 0; e < endpointCount; ++e)
+		{
+			for(std::uint32_t c = 0; c < (alphaBits != 0 ? 4u : 3u); ++c)
+				endpoints[e][c] = (endpoints[e][c] << 1) | pbits[e];
+		}
+
+		++colorBits;
+		if(alphaBits != 0)
+			++alphaBits;
+	}
+
+	for(std::uint32_t e = 0; e < endpointCount; ++e)
+	{
+		for(std::uint32_t c = 0; c < 3; ++c)
+			endpoints[e][c] = Expand(endpoints[e][c], colorBits);
+		if(alphaBits != 0)
+			endpoints[e][3] = Expand(endpoints[e][3], alphaBits);
+	}
+
+	std::uint32_t colorIndices[16];
+	std::uint32_t alphaIndices[16];
+	ReadIndices(bits, m.IndexBits, m.Subsets, partition, colorIndices);
+
+	std::uint32_t colorIndexBits = m.IndexBits;
+	std::uint32_t alphaIndexBits = m.IndexBits;
+	const std::uint32_t* alphaSource = colorIndices;
+	if(m.SecondIndexBits != 0)
+	{
+		ReadIndices(bits, m.SecondIndexBits, 1, 0, alphaIndices);
+		alphaSource = alphaIndices;
+		alphaIndexBits = m.SecondIndexBits;
+	}
+
+	const std::uint32_t* colorSource = colorIndices;
+	if(indexSelection != 0)
+	{
+		std::swap(colorSource, alphaSource);
+		std::swap(colorIndexBits, alphaIndexBits);
+	}
+
+	const std::uint32_t* colorWeights = IndexWeights(colorIndexBits);
+	const std::uint32_t* alphaWeights = IndexWeights(alphaIndexBits);
+	const std::uint8_t* subsets = PartitionSubsets(m.Subsets, partition);
+
+	for(std::uint32_t p = 0; p < 16; ++p)
+	{
+		const std::uint32_t* e0 = endpoints[2 * subsets[p]];
+		const std::uint32_t* e1 = endpoints[2 * subsets[p] + 1];
+		std::uint8_t* pixel = rgba + 4 * p;
+
+		std::uint32_t w = colorWeights[colorSource[p]];
+		for(std::uint32_t c = 0; c < 3; ++c)
+			pixel[c] = (std::uint8_t)(((64 - w) * e0[c] + w * e1[c] + 32) >> 6);
+
+		w = alphaWeights[alphaSource[p]];
+		pixel[3] = (std::uint8_t)(((64 - w) * e0[3] + w * e1[3] + 32) >> 6);
+
+		// Rotation swaps alpha with one of the color channels.
+		if(rotation != 0)
+			std::swap(pixel[3], pixel[rotation - 1]);
+	}
+}
+
+void BCDecoder::DecodeBC4SBlock(const std::uint8_t* block, float* rgba)
+{
+	for(int p = 0; p < 16; ++p)
+	{
+		rgba[4 * p + 1] = 0.0f;
+		rgba[4 * p + 2] = 0.0f;
+		rgba[4 * p + 3] = 1.0f;
+	}
+	DecodeSignedAlphaBlock(block, rgba);
+}
+
+void BCDecoder::DecodeBC5SBlock(const std::uint8_t* block, float* rgba)
+{
+	for(int p = 0; p < 16; ++p)
+	{
+		rgba[4 * p + 2] = 0.0f;
+		rgba[4 * p + 3] = 1.0f;
+	}
+	DecodeSignedAlphaBlock(block, rgba);
+	DecodeSignedAlphaBlock(block + 8, rgba + 1);
+}
+
+void BCDecoder::DecodeBC6HBlock(const std::uint8_t* block, float* rgba, bool isSigned)
+{
+	// Halves of the 16 pixels; alpha is 1.0.
+	PackedVector::HALF halves[16 * 4];
+	for(int p = 0; p < 16; ++p)
+	{
+		halves[4 * p + 0] = halves[4 * p + 1] = halves[4 * p + 2] = 0;
+		halves[4 * p + 3] = 0x3c00;
+	}
+
+	BlockBits bits(block);
+	int mode = (int)bits.Read(2);
+	if(mode > 1)
+		mode = Bc6hLongModes[mode | (bits.Read(3) << 2)];
+
+	if(mode >= 0)
+	{
+		const Bc6hMode& m = Bc6hModes[mode];
+
+		std::uint32_t fields[13] = {};
+		for(const Bc6hBits& run : m.Layout)
+		{
+			if(run.Count == 0)
+				break;
+			fields[run.Field] |= bits.Read(run.Count) << run.Low;
+		}
+
+		const std::uint32_t endpointCount = 2u * m.Subsets;
+		const std::uint32_t endpointBits = m.EndpointBits;
+		std::int32_t endpoints[4][3];
+		for(std::uint32_t c = 0; c < 3; ++c)
+		{
+			std::uint32_t base = fields[c];
+			endpoints[0][c] = isSigned ? SignExtend(base, endpointBits) : (std::int32_t)base;
+
+			for(std::uint32_t e = 1; e < endpointCount; ++e)
+			{
+				std::uint32_t value = fields[3 * e + c];
+				if(m.Transformed)
+				{
+					value = (base + (std::uint32_t)SignExtend(value, m.DeltaBits[c])) & ((1u << endpointBits) - 1);
+				}
+				endpoints[e][c] = isSigned ? SignExtend(value, endpointBits) : (std::int32_t)value;
+			}
+
+			for(std::uint32_t e = 0; e < endpointCount; ++e)
+				endpoints[e][c] = Unquantize(endpoints[e][c], endpointBits, isSigned);
+		}
+
+		const std::uint32_t partition = fields[PartitionField];
+		const std::uint32_t indexBits = (m.Subsets == 1) ? 4 : 3;
+		std::uint32_t indices[16];
+		ReadIndices(bits, indexBits, m.Subsets, partition, indices);
+
+		const std::uint32_t* weights = IndexWeights(indexBits);
+		const std::uint8_t* subsets = PartitionSubsets(m.Subsets, partition);
+		for(std::uint32_t p = 0; p < 16; ++p)
+		{
+			const std::int32_t* e0 = endpoints[2 * subsets[p]];
+			const std::int32_t* e1 = endpoints[2 * subsets[p] + 1];
+			std::int32_t w = (std::int32_t)weights[indices[p]];
+			for(std::uint32_t c = 0; c < 3; ++c)
+			{
+				std::int32_t value = ((64 - w) * e0[c] + w * e1[c] + 32) >> 6;
+				halves[4 * p + c] = FinishUnquantize(value, isSigned);
+			}
+		}
+	}
+	// Reserved modes decode as black.
+
+	PackedVector::XMConvertHalfToFloatStream(rgba, sizeof(float), halves, sizeof(PackedVector::HALF), 16 * 4);
+}
+
+bool BCDecoder::Decode(DXGI_FORMAT format, const std::uint8_t* bits, std::size_t rowPitch,
+	std::uint32_t width, std::uint32_t height, RgbaImage& image, JobSystem* jobs)
+{
+	return DecodeSurface(format, bits, rowPitch, width, height, image, jobs);
+}
+
+bool BCDecoder::Decode(DXGI_FORMAT format, const std::uint8_t* bits, std::size_t rowPitch,
+	std::uint32_t width, std::uint32_t height, RgbaFloatImage& image, JobSystem* jobs)
+{
+	return DecodeSurface(format, bits, rowPitch, width, height, image, jobs);
+}
+
+bool BCDecoder::DecodeTexture(const DDSTextureDesc& desc, const DDSLayout& layout,
+	const std::uint8_t* bits, std::vector<RgbaImage>& images, JobSystem* jobs)
+{
+	return DecodeSubresources(desc, layout, bits, images, jobs);
+}
+
+bool BCDecoder::DecodeTexture(const DDSTextureDesc& desc, const DDSLayout& layout,
+	const std::uint8_t* bits, std::vector<RgbaFloatImage>& images, JobSystem* jobs)
+{
+	return DecodeSubresources(desc, layout, bits, images, jobs);
+}
+
+void BCDecoder::DecodeAlphaBlock(const std::uint8_t* block, std::uint8_t* dest)
+{
+	std::uint32_t a0 = block[0];
+	std::uint32_t a1 = block[1];
+
+	std::uint32_t palette[8] = { a0, a1 };
+	if(a0 > a1)
+	{
+		for(std::uint32_t i = 1; i < 7; ++i)
+			palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+	}
+	else
+	{
+		for(std::uint32_t i = 1; i < 5; ++i)
+			palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	std::uint64_t indices = 0;
+	for(int i = 0; i < 6; ++i)
+		indices |= (std::uint64_t)block[2 + i] << (8 * i);
+
+	for(int p = 0; p < 16; ++p, indices >>= 3)
+		dest[4 * p] = (std::uint8_t)palette[indices & 7];
+}
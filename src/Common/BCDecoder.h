@@ -0,0 +1,71 @@
+//***************************************************************************************
+// BCDecoder.h
+//
+// CPU decoding of block-compressed textures, following the Direct3D reference rules
+// for palette interpolation and endpoint unquantization.  Used to measure encoder
+// quality, to validate texture files and by headless tools that need the texels of a
+// compressed file.
+//
+// Supported: BC1-BC7 in all their UNORM, SNORM, UF16/SF16, sRGB and typeless variants
+// (typeless decodes as UNORM, BC6H as UF16).  Missing channels decode as 0 for color
+// and 1 for alpha, as the sampler returns them.
+//
+// RGBA8 output holds what the file stores: sRGB formats stay sRGB-encoded, SNORM values
+// are mapped from [-1, 1] to [0, 255] and BC6H is clamped to [0, 1].  Float output holds
+// what the sampler returns: sRGB formats are converted to linear, SNORM stays signed and
+// BC6H keeps its full range.
+//
+// Whole surfaces and whole textures are decoded by block row, spread over a JobSystem
+// when given one.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSFormat.h"
+#include "RgbaImage.h"
+#include <cstdint>
+#include <vector>
+#include <dxgiformat.h>
+
+class JobSystem;
+
+class BCDecoder
+{
+public:
+	// Bytes per 4x4 block of format, or 0 if it is not a supported block format.
+	static std::uint32_t BlockSize(DXGI_FORMAT format);
+
+	// Decodes one block into rgba, 16 pixels of 4 bytes in row order.
+	static void DecodeBC1Block(const std::uint8_t* block, std::uint8_t* rgba);
+	static void DecodeBC2Block(const std::uint8_t* block, std::uint8_t* rgba);
+	static void DecodeBC3Block(const std::uint8_t* block, std::uint8_t* rgba);
+	static void DecodeBC4Block(const std::uint8_t* block, std::uint8_t* rgba);
+	static void DecodeBC5Block(const std::uint8_t* block, std::uint8_t* rgba);
+	static void DecodeBC7Block(const std::uint8_t* block, std::uint8_t* rgba);
+
+	// Decodes one block of a format with values outside [0, 1] into rgba, 16 pixels of
+	// 4 floats in row order.
+	static void DecodeBC4SBlock(const std::uint8_t* block, float* rgba);
+	static void DecodeBC5SBlock(const std::uint8_t* block, float* rgba);
+	static void DecodeBC6HBlock(const std::uint8_t* block, float* rgba, bool isSigned);
+
+	// Decodes a width x height surface whose block rows are rowPitch bytes apart.
+	// Returns false for an unsupported format.
+	static bool Decode(DXGI_FORMAT format, const std::uint8_t* bits, std::size_t rowPitch,
+		std::uint32_t width, std::uint32_t height, RgbaImage& image, JobSystem* jobs = nullptr);
+	static bool Decode(DXGI_FORMAT format, const std::uint8_t* bits, std::size_t rowPitch,
+		std::uint32_t width, std::uint32_t height, RgbaFloatImage& image, JobSystem* jobs = nullptr);
+
+	// Decodes every subresource of layout, whose offsets are into bits (as in a
+	// TextureStreamer::LoadedTexture), into one image each in layout order.  The depth
+	// slices of a volume mip are stacked top to bottom.  The block rows of all the
+	// subresources are spread over jobs together, so the small mips do not run alone.
+	// Returns false for an unsupported format.
+	static bool DecodeTexture(const DirectX::DDSTextureDesc& desc, const DirectX::DDSLayout& layout,
+		const std::uint8_t* bits, std::vector<RgbaImage>& images, JobSystem* jobs = nullptr);
+	static bool DecodeTexture(const DirectX::DDSTextureDesc& desc, const DirectX::DDSLayout& layout,
+		const std::uint8_t* bits, std::vector<RgbaFloatImage>& images, JobSystem* jobs = nullptr);
+
+	// BC4 and the BC3 alpha block: a 0-255 value per pixel into every fourth byte.
+	static void DecodeAlphaBlock(const std::uint8_t* block, std::uint8_t* dest);
+};
@@ -0,0 +1,590 @@
+//***************************************************************************************
+// BCEncoder.cpp
+//***************************************************************************************
+
+#include "BCEncoder.h"
+#include "DDSWriter.h"
+#include "JobSystem.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+	float XM_CALLCONV Sum(FXMVECTOR v)
+	{
+		XMFLOAT4 f;
+		XMStoreFloat4(&f, v);
+		return (f.x + f.y) + (f.z + f.w);
+	}
+
+	float XM_CALLCONV MinOf(FXMVECTOR v)
+	{
+		XMFLOAT4 f;
+		XMStoreFloat4(&f, v);
+		return std::min(std::min(f.x, f.y), std::min(f.z, f.w));
+	}
+
+	float XM_CALLCONV MaxOf(FXMVECTOR v)
+	{
+		XMFLOAT4 f;
+		XMStoreFloat4(&f, v);
+		return std::max(std::max(f.x, f.y), std::max(f.z, f.w));
+	}
+
+	// Packs four small non-negative integers held as floats, bitsPerIndex bits each,
+	// lowest lane first.
+	std::uint64_t XM_CALLCONV PackIndices(FXMVECTOR v, std::uint32_t bitsPerIndex)
+	{
+		XMFLOAT4 f;
+		XMStoreFloat4(&f, v);
+		return (std::uint64_t)f.x | ((std::uint64_t)f.y << bitsPerIndex) |
+			((std::uint64_t)f.z << (2 * bitsPerIndex)) | ((std::uint64_t)f.w << (3 * bitsPerIndex));
+	}
+
+	// The pixels of a block as four groups of four, structure-of-arrays.  Fit is all ones
+	// for the pixels the color endpoints are fit to; in BC1 the transparent ones are not.
+	struct ColorBlock
+	{
+		XMVECTOR R[4];
+		XMVECTOR G[4];
+		XMVECTOR B[4];
+		XMVECTOR Fit[4];
+		float Pixels[16][3];
+		bool Weight[16];
+		std::uint32_t FitCount = 0;
+	};
+
+	void LoadColorBlock(const std::uint8_t* rgba, bool alphaCutout, ColorBlock& block)
+	{
+		XMFLOAT4 r, g, b, a;
+		for(int group = 0; group < 4; ++group)
+		{
+			float* lanes[4] = { &r.x, &g.x, &b.x, &a.x };
+			for(int lane = 0; lane < 4; ++lane)
+			{
+				int p = 4 * group + lane;
+				const std::uint8_t* pixel = rgba + 4 * p;
+				for(int i = 0; i < 3; ++i)
+					block.Pixels[p][i] = pixel[i];
+
+				block.Weight[p] = !alphaCutout || pixel[3] >= 128;
+				block.FitCount += block.Weight[p] ? 1 : 0;
+
+				// XMFLOAT4 members are laid out x, y, z, w.
+				for(int i = 0; i < 4; ++i)
+					lanes[i][lane] = (i < 3) ? (float)pixel[i] : (block.Weight[p] ? 1.0f : 0.0f);
+			}
+
+			block.R[group] = XMLoadFloat4(&r);
+			block.G[group] = XMLoadFloat4(&g);
+			block.B[group] = XMLoadFloat4(&b);
+			block.Fit[group] = XMVectorGreater(XMLoadFloat4(&a), XMVectorZero());
+		}
+	}
+
+	std::uint32_t Pack565(const float* rgb)
+	{
+		std::uint32_t r = (std::uint32_t)std::min(std::max(rgb[0] * (31.0f / 255.0f) + 0.5f, 0.0f), 31.0f);
+		std::uint32_t g = (std::uint32_t)std::min(std::max(rgb[1] * (63.0f / 255.0f) + 0.5f, 0.0f), 63.0f);
+		std::uint32_t b = (std::uint32_t)std::min(std::max(rgb[2] * (31.0f / 255.0f) + 0.5f, 0.0f), 31.0f);
+		return (r << 11) | (g << 5) | b;
+	}
+
+	void Unpack565(std::uint32_t c, std::uint32_t* rgb)
+	{
+		std::uint32_t r = (c >> 11) & 31;
+		std::uint32_t g = (c >> 5) & 63;
+		std::uint32_t b = c & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	// Chooses the nearest palette entry of endpoints c0 and c1 for every fitted pixel,
+	// with the palette BCDecoder produces.  Unfitted pixels get index 3, transparent in
+	// three-color mode.  Returns the squared RGB error over the fitted pixels.
+	float ChooseColorIndices(const ColorBlock& block, std::uint32_t c0, std::uint32_t c1, bool threeColor,
+		std::uint32_t& indices)
+	{
+		std::uint32_t palette[4][3];
+		Unpack565(c0, palette[0]);
+		Unpack565(c1, palette[1]);
+		for(int i = 0; i < 3; ++i)
+		{
+			if(threeColor)
+			{
+				palette[2][i] = (palette[0][i] + palette[1][i] + 1) / 2;
+			}
+			else
+			{
+				palette[2][i] = (2 * palette[0][i] + palette[1][i] + 1) / 3;
+				palette[3][i] = (palette[0][i] + 2 * palette[1][i] + 1) / 3;
+			}
+		}
+
+		const int count = threeColor ? 3 : 4;
+		XMVECTOR pr[4], pg[4], pb[4], index[4];
+		for(int k = 0; k < count; ++k)
+		{
+			pr[k] = XMVectorReplicate((float)palette[k][0]);
+			pg[k] = XMVectorReplicate((float)palette[k][1]);
+			pb[k] = XMVectorReplicate((float)palette[k][2]);
+			index[k] = XMVectorReplicate((float)k);
+		}
+
+		XMVECTOR error = XMVectorZero();
+		indices = 0;
+		for(int group = 0; group < 4; ++group)
+		{
+			XMVECTOR best = XMVectorReplicate(FLT_MAX);
+			XMVECTOR bestIndex = XMVectorZero();
+			for(int k = 0; k < count; ++k)
+			{
+				XMVECTOR dr = XMVectorSubtract(block.R[group], pr[k]);
+				XMVECTOR dg = XMVectorSubtract(block.G[group], pg[k]);
+				XMVECTOR db = XMVectorSubtract(block.B[group], pb[k]);
+				XMVECTOR d = XMVectorMultiply(dr, dr);
+				d = XMVectorMultiplyAdd(dg, dg, d);
+				d = XMVectorMultiplyAdd(db, db, d);
+
+				XMVECTOR closer = XMVectorLess(d, best);
+				best = XMVectorSelect(best, d, closer);
+				bestIndex = XMVectorSelect(bestIndex, index[k], closer);
+			}
+
+			error = XMVectorAdd(error, XMVectorSelect(XMVectorZero(), best, block.Fit[group]));
+			bestIndex = XMVectorSelect(XMVectorReplicate(3.0f), bestIndex, block.Fit[group]);
+			indices |= (std::uint32_t)PackIndices(bestIndex, 2) << (8 * group);
+		}
+
+		return Sum(error);
+	}
+
+	// Least-squares endpoints for the given indices: each fitted pixel is modeled as
+	// w * e0 + (1 - w) * e1, w being the weight of its palette entry.  Returns false if
+	// the indices do not determine two endpoints.
+	bool RefineColorEndpoints(const ColorBlock& block, std::uint32_t indices, bool threeColor, float* e0, float* e1)
+	{
+		static const float FourColorWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		static const float ThreeColorWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+		const float* weights = threeColor ? ThreeColorWeights : FourColorWeights;
+
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[3] = {}, bx[3] = {};
+		for(int p = 0; p < 16; ++p, indices >>= 2)
+		{
+			if(!block.Weight[p])
+				continue;
+
+			float a = weights[indices & 3];
+			float b = 1.0f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for(int i = 0; i < 3; ++i)
+			{
+				ax[i] += a * block.Pixels[p][i];
+				bx[i] += b * block.Pixels[p][i];
+			}
+		}
+
+		float det = aa * bb - ab * ab;
+		if(std::fabs(det) < 1e-6f)
+			return false;
+
+		float inv = 1.0f / det;
+		for(int i = 0; i < 3; ++i)
+		{
+			e0[i] = (ax[i] * bb - bx[i] * ab) * inv;
+			e1[i] = (bx[i] * aa - ax[i] * ab) * inv;
+		}
+		return true;
+	}
+
+	// Endpoints at the extremes of the pixels along their principal axis, pulled in by a
+	// sixteenth of the range so the interpolated entries land on the pixels more often.
+	void FitPrincipalAxis(const ColorBlock& block, float* e0, float* e1)
+	{
+		XMVECTOR sumR = XMVectorZero(), sumG = XMVectorZero(), sumB = XMVectorZero();
+		for(int group = 0; group < 4; ++group)
+		{
+			sumR = XMVectorAdd(sumR, XMVectorSelect(XMVectorZero(), block.R[group], block.Fit[group]));
+			sumG = XMVectorAdd(sumG, XMVectorSelect(XMVectorZero(), block.G[group], block.Fit[group]));
+			sumB = XMVectorAdd(sumB, XMVectorSelect(XMVectorZero(), block.B[group], block.Fit[group]));
+		}
+
+		const float invCount = 1.0f / (float)block.FitCount;
+		const float mean[3] = { Sum(sumR) * invCount, Sum(sumG) * invCount, Sum(sumB) * invCount };
+		const XMVECTOR meanR = XMVectorReplicate(mean[0]);
+		const XMVECTOR meanG = XMVectorReplicate(mean[1]);
+		const XMVECTOR meanB = XMVectorReplicate(mean[2]);
+
+		XMVECTOR dR[4], dG[4], dB[4];
+		XMVECTOR crr = XMVectorZero(), crg = XMVectorZero(), crb = XMVectorZero();
+		XMVECTOR cgg = XMVectorZero(), cgb = XMVectorZero(), cbb = XMVectorZero();
+		for(int group = 0; group < 4; ++group)
+		{
+			dR[group] = XMVectorSelect(XMVectorZero(), XMVectorSubtract(block.R[group], meanR), block.Fit[group]);
+			dG[group] = XMVectorSelect(XMVectorZero(), XMVectorSubtract(block.G[group], meanG), block.Fit[group]);
+			dB[group] = XMVectorSelect(XMVectorZero(), XMVectorSubtract(block.B[group], meanB), block.Fit[group]);
+
+			crr = XMVectorMultiplyAdd(dR[group], dR[group], crr);
+			crg = XMVectorMultiplyAdd(dR[group], dG[group], crg);
+			crb = XMVectorMultiplyAdd(dR[group], dB[group], crb);
+			cgg = XMVectorMultiplyAdd(dG[group], dG[group], cgg);
+			cgb = XMVectorMultiplyAdd(dG[group], dB[group], cgb);
+			cbb = XMVectorMultiplyAdd(dB[group], dB[group], cbb);
+		}
+
+		const float cov[6] = { Sum(crr), Sum(crg), Sum(crb), Sum(cgg), Sum(cgb), Sum(cbb) };
+
+		// Power iteration, starting from the luminance direction.
+		float axis[3] = { 1.0f, 1.0f, 1.0f };
+		for(int iteration = 0; iteration < 8; ++iteration)
+		{
+			float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+			float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+			float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+
+			float largest = std::max({ std::fabs(x), std::fabs(y), std::fabs(z) });
+			if(largest < 1e-6f)
+				break;
+
+			axis[0] = x / largest;
+			axis[1] = y / largest;
+			axis[2] = z / largest;
+		}
+
+		float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		for(int i = 0; i < 3; ++i)
+			axis[i] /= length;
+
+		const XMVECTOR axisR = XMVectorReplicate(axis[0]);
+		const XMVECTOR axisG = XMVectorReplicate(axis[1]);
+		const XMVECTOR axisB = XMVectorReplicate(axis[2]);
+		XMVECTOR minT = XMVectorReplicate(FLT_MAX);
+		XMVECTOR maxT = XMVectorReplicate(-FLT_MAX);
+		for(int group = 0; group < 4; ++group)
+		{
+			XMVECTOR t = XMVectorMultiply(dR[group], axisR);
+			t = XMVectorMultiplyAdd(dG[group], axisG, t);
+			t = XMVectorMultiplyAdd(dB[group], axisB, t);
+			minT = XMVectorMin(minT, XMVectorSelect(XMVectorReplicate(FLT_MAX), t, block.Fit[group]));
+			maxT = XMVectorMax(maxT, XMVectorSelect(XMVectorReplicate(-FLT_MAX), t, block.Fit[group]));
+		}
+
+		float tMin = MinOf(minT);
+		float tMax = MaxOf(maxT);
+		float inset = (tMax - tMin) / 16.0f;
+		tMin += inset;
+		tMax -= inset;
+
+		for(int i = 0; i < 3; ++i)
+		{
+			e0[i] = mean[i] + axis[i] * tMax;
+			e1[i] = mean[i] + axis[i] * tMin;
+		}
+	}
+
+	// Puts the endpoints in the order that selects the mode: c0 > c1 for four colors and
+	// c0 <= c1 for three, remapping the indices to match.
+	void OrderColorEndpoints(std::uint32_t& c0, std::uint32_t& c1, std::uint32_t& indices, bool threeColor)
+	{
+		if(!threeColor)
+		{
+			if(c0 < c1)
+			{
+				std::swap(c0, c1);
+				indices ^= 0x55555555; // 0 <-> 1 and 2 <-> 3.
+			}
+			else if(c0 == c1)
+			{
+				// Reads as three-color mode; index 0 is the color either way.
+				indices = 0;
+			}
+		}
+		else if(c0 > c1)
+		{
+			std::swap(c0, c1);
+
+			// 0 <-> 1; 2 and 3 stay.
+			std::uint32_t low = ~(indices >> 1) & 0x55555555;
+			indices ^= low;
+		}
+	}
+
+	void EncodeColorBlock(const std::uint8_t* rgba, std::uint8_t* dest, bool alphaCutout)
+	{
+		ColorBlock block;
+		LoadColorBlock(rgba, alphaCutout, block);
+
+		// Transparent pixels need index 3 of the three-color palette.
+		const bool threeColor = block.FitCount < 16;
+
+		std::uint32_t c0 = 0, c1 = 0, indices = 0xffffffff;
+		if(block.FitCount != 0)
+		{
+			float e0[3], e1[3];
+			FitPrincipalAxis(block, e0, e1);
+			c0 = Pack565(e0);
+			c1 = Pack565(e1);
+			float error = ChooseColorIndices(block, c0, c1, threeColor, indices);
+
+			for(int pass = 0; pass < 2 && error > 0.0f; ++pass)
+			{
+				if(!RefineColorEndpoints(block, indices, threeColor, e0, e1))
+					break;
+
+				std::uint32_t refined0 = Pack565(e0);
+				std::uint32_t refined1 = Pack565(e1);
+				std::uint32_t refinedIndices;
+				float refinedError = ChooseColorIndices(block, refined0, refined1, threeColor, refinedIndices);
+				if(refinedError >= error)
+					break;
+
+				c0 = refined0;
+				c1 = refined1;
+				indices = refinedIndices;
+				error = refinedError;
+			}
+
+			OrderColorEndpoints(c0, c1, indices, threeColor);
+		}
+
+		dest[0] = (std::uint8_t)c0;
+		dest[1] = (std::uint8_t)(c0 >> 8);
+		dest[2] = (std::uint8_t)c1;
+		dest[3] = (std::uint8_t)(c1 >> 8);
+		for(int i = 0; i < 4; ++i)
+			dest[4 + i] = (std::uint8_t)(indices >> (8 * i));
+	}
+
+	// Chooses the nearest of the palette BCDecoder builds from a0 and a1 for all 16
+	// values.  Returns the squared error.
+	float ChooseAlphaIndices(const XMVECTOR* values, std::uint32_t a0, std::uint32_t a1, std::uint64_t& indices)
+	{
+		std::uint32_t palette[8] = { a0, a1 };
+		if(a0 > a1)
+		{
+			for(std::uint32_t i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+		}
+		else
+		{
+			for(std::uint32_t i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		XMVECTOR error = XMVectorZero();
+		indices = 0;
+		for(int group = 0; group < 4; ++group)
+		{
+			XMVECTOR best = XMVectorReplicate(FLT_MAX);
+			XMVECTOR bestIndex = XMVectorZero();
+			for(int k = 0; k < 8; ++k)
+			{
+				XMVECTOR d = XMVectorSubtract(values[group], XMVectorReplicate((float)palette[k]));
+				d = XMVectorMultiply(d, d);
+
+				XMVECTOR closer = XMVectorLess(d, best);
+				best = XMVectorSelect(best, d, closer);
+				bestIndex = XMVectorSelect(bestIndex, XMVectorReplicate((float)k), closer);
+			}
+
+			error = XMVectorAdd(error, best);
+			indices |= PackIndices(bestIndex, 3) << (12 * group);
+		}
+
+		return Sum(error);
+	}
+
+	// BC4, and the alpha block of BC3: the channel at every fourth byte of rgba.
+	void EncodeAlphaBlock(const std::uint8_t* rgba, std::uint8_t* dest)
+	{
+		XMVECTOR values[4];
+		std::uint32_t low = 255, high = 0;
+		std::uint32_t innerLow = 255, innerHigh = 0; // Ignoring 0 and 255.
+		for(int group = 0; group < 4; ++group)
+		{
+			XMFLOAT4 f;
+			float* lanes = &f.x;
+			for(int lane = 0; lane < 4; ++lane)
+			{
+				std::uint32_t v = rgba[4 * (4 * group + lane)];
+				lanes[lane] = (float)v;
+				low = std::min(low, v);
+				high = std::max(high, v);
+				if(v != 0 && v != 255)
+				{
+					innerLow = std::min(innerLow, v);
+					innerHigh = std::max(innerHigh, v);
+				}
+			}
+			values[group] = XMLoadFloat4(&f);
+		}
+
+		std::uint32_t a0 = high, a1 = low;
+		std::uint64_t indices = 0;
+		if(high != low)
+		{
+			float error = ChooseAlphaIndices(values, a0, a1, indices);
+
+			// Values at 0 and 255 can be left to the fixed entries of the six-value
+			// palette, which then spans only the values in between.
+			if(error > 0.0f && (low == 0 || high == 255))
+			{
+				std::uint32_t b0 = innerLow <= innerHigh ? innerLow : low;
+				std::uint32_t b1 = innerLow <= innerHigh ? innerHigh : high;
+				std::uint64_t sixIndices;
+				if(ChooseAlphaIndices(values, b0, b1, sixIndices) < error)
+				{
+					a0 = b0;
+					a1 = b1;
+					indices = sixIndices;
+				}
+			}
+		}
+
+		dest[0] = (std::uint8_t)a0;
+		dest[1] = (std::uint8_t)a1;
+		for(int i = 0; i < 6; ++i)
+			dest[2 + i] = (std::uint8_t)(indices >> (8 * i));
+	}
+}
+
+DXGI_FORMAT BCEncoder::GetDXGIFormat(Format format, bool srgb)
+{
+	switch(format)
+	{
+	case Format::BC1:
+		return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+	case Format::BC3:
+		return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+	default:
+		// Normal maps are linear data.
+		return DXGI_FORMAT_BC5_UNORM;
+	}
+}
+
+std::uint32_t BCEncoder::BlockSize(Format format)
+{
+	return (format == Format::BC1) ? 8 : 16;
+}
+
+void BCEncoder::EncodeBC1Block(const std::uint8_t* rgba, std::uint8_t* block)
+{
+	EncodeColorBlock(rgba, block, true);
+}
+
+void BCEncoder::EncodeBC3Block(const std::uint8_t* rgba, std::uint8_t* block)
+{
+	EncodeAlphaBlock(rgba + 3, block);
+	EncodeColorBlock(rgba, block + 8, false);
+}
+
+void BCEncoder::EncodeBC5Block(const std::uint8_t* rgba, std::uint8_t* block)
+{
+	EncodeAlphaBlock(rgba, block);
+	EncodeAlphaBlock(rgba + 1, block + 8);
+}
+
+std::vector<std::uint8_t> BCEncoder::Encode(const RgbaImage& image, Format format, JobSystem* jobs)
+{
+	void (*encodeBlock)(const std::uint8_t*, std::uint8_t*) = EncodeBC1Block;
+	if(format == Format::BC3)
+		encodeBlock = EncodeBC3Block;
+	else if(format == Format::BC5)
+		encodeBlock = EncodeBC5Block;
+
+	const std::uint32_t blockSize = BlockSize(format);
+	const std::uint32_t blocksWide = std::max(1u, (image.Width + 3) / 4);
+	const std::uint32_t blocksHigh = std::max(1u, (image.Height + 3) / 4);
+	const std::size_t rowPitch = (std::size_t)blocksWide * blockSize;
+
+	std::vector<std::uint8_t> bits(rowPitch * blocksHigh);
+	if(image.Width == 0 || image.Height == 0)
+		return bits;
+
+	auto encodeRow = [&](std::uint32_t by)
+	{
+		std::uint8_t rgba[16 * 4];
+		for(std::uint32_t bx = 0; bx < blocksWide; ++bx)
+		{
+			for(std::uint32_t y = 0; y < 4; ++y)
+			{
+				std::uint32_t sy = std::min(by * 4 + y, image.Height - 1);
+				for(std::uint32_t x = 0; x < 4; ++x)
+				{
+					std::uint32_t sx = std::min(bx * 4 + x, image.Width - 1);
+					std::memcpy(rgba + 4 * (4 * y + x), image.Pixel(sx, sy), 4);
+				}
+			}
+
+			encodeBlock(rgba, bits.data() + by * rowPitch + bx * blockSize);
+		}
+	};
+
+	if(jobs != nullptr)
+	{
+		jobs->ParallelFor(blocksHigh, encodeRow);
+	}
+	else
+	{
+		for(std::uint32_t by = 0; by < blocksHigh; ++by)
+			encodeRow(by);
+	}
+
+	return bits;
+}
+
+bool BCEncoder::WriteDDS(const std::string& fileName, const std::vector<RgbaImage>& mips, Format format,
+	bool srgb, JobSystem* jobs, std::string& error)
+{
+	if(mips.empty())
+	{
+		error = fileName + ": no mips to write";
+		return false;
+	}
+
+	DDSTextureDesc desc;
+	desc.Dimension = DDS_DIMENSION_TEXTURE2D;
+	desc.Format = GetDXGIFormat(format, srgb);
+	desc.Width = mips[0].Width;
+	desc.Height = mips[0].Height;
+	desc.Depth = 1;
+	desc.ArraySize = 1;
+	desc.MipCount = (std::uint32_t)mips.size();
+
+	DDSLayout layout;
+	if(!GetDDSLayout(desc, 0, layout))
+	{
+		error = fileName + ": the mips do not form a valid texture";
+		return false;
+	}
+
+	std::vector<std::uint8_t> bits(layout.TotalBytes);
+	for(std::uint32_t mip = 0; mip < desc.MipCount; ++mip)
+	{
+		const DDSSubresource& sub = layout.Subresources[mip];
+		if(mips[mip].Width != sub.Width || mips[mip].Height != sub.Height)
+		{
+			error = fileName + ": mip " + std::to_string(mip) + " is " + std::to_string(mips[mip].Width) + "x" +
+				std::to_string(mips[mip].Height) + ", expected " + std::to_string(sub.Width) + "x" + std::to_string(sub.Height);
+			return false;
+		}
+
+		std::vector<std::uint8_t> encoded = Encode(mips[mip], format, jobs);
+		assert(encoded.size() == sub.SlicePitch);
+		std::memcpy(bits.data() + sub.Offset, encoded.data(), encoded.size());
+	}
+
+	return WriteDDSFile(fileName, desc, bits.data(), bits.size(), error);
+}
@@ -0,0 +1,54 @@
+//***************************************************************************************
+// BCEncoder.h
+//
+// CPU encoder from RGBA8 to the block formats the samples use: BC1 for color (with
+// 1-bit alpha for cutouts), BC3 for color with smooth alpha and BC5 for two-channel
+// normal maps.
+//
+// Color blocks are fit along the principal axis of their pixels, then refined with two
+// least-squares passes over the chosen palette indices.  The per-block math works on
+// four pixels at a time with DirectXMath vectors, so it uses SSE2 on x86/x64 and falls
+// back to scalar code where _XM_NO_INTRINSICS_ is defined.  Alpha and BC5 channels try
+// both the 8-value and the 6-value-plus-0-and-255 palette and keep the better fit.
+//
+// Encode spreads block rows over a JobSystem; blocks are independent, so the output
+// does not depend on the number of threads.
+//***************************************************************************************
+
+#pragma once
+
+#include "RgbaImage.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <dxgiformat.h>
+
+class JobSystem;
+
+class BCEncoder
+{
+public:
+	enum class Format
+	{
+		BC1, // RGB, alpha below 128 becomes transparent black.
+		BC3, // RGBA.
+		BC5  // R and G, e.g. the x and y of a tangent-space normal map.
+	};
+
+	static DXGI_FORMAT GetDXGIFormat(Format format, bool srgb = false);
+	static std::uint32_t BlockSize(Format format);
+
+	// Encode one block of 16 RGBA8 pixels in row order.
+	static void EncodeBC1Block(const std::uint8_t* rgba, std::uint8_t* block);
+	static void EncodeBC3Block(const std::uint8_t* rgba, std::uint8_t* block);
+	static void EncodeBC5Block(const std::uint8_t* rgba, std::uint8_t* block);
+
+	// Encodes image as one surface, block rows back to back.  Pixels past the right and
+	// bottom edges of partial blocks repeat the last column and row.
+	static std::vector<std::uint8_t> Encode(const RgbaImage& image, Format format, JobSystem* jobs = nullptr);
+
+	// Encodes a mip chain, mips[0] being the top level and each next one half the size
+	// rounded down (at least 1), and writes it as a DDS file.
+	static bool WriteDDS(const std::string& fileName, const std::vector<RgbaImage>& mips, Format format,
+		bool srgb, JobSystem* jobs, std::string& error);
+};
@@ -0,0 +1,153 @@
+//***************************************************************************************
+// BuddyAllocator.cpp
+//***************************************************************************************
+
+#include "BuddyAllocator.h"
+#include <cassert>
+
+double BuddyAllocator::Stats::InternalFragmentation()const
+{
+	return AllocatedBytes == 0 ? 0.0 : double(AllocatedBytes - RequestedBytes) / double(AllocatedBytes);
+}
+
+double BuddyAllocator::Stats::ExternalFragmentation()const
+{
+	return FreeBytes == 0 ? 0.0 : 1.0 - double(LargestFreeBlock) / double(FreeBytes);
+}
+
+BuddyAllocator::BuddyAllocator(std::uint64_t capacity, std::uint64_t minBlockSize)
+	: mCapacity(capacity), mMinBlockSize(minBlockSize), mMaxOrder(0)
+{
+	assert(minBlockSize != 0 && (minBlockSize & (minBlockSize - 1)) == 0);
+	assert(capacity >= minBlockSize && capacity % minBlockSize == 0);
+
+	while(OrderSize(mMaxOrder) < capacity)
+		++mMaxOrder;
+	assert(OrderSize(mMaxOrder) == capacity && "capacity must be minBlockSize times a power of two");
+
+	mFreeLists.resize(mMaxOrder + 1);
+	mFreeLists[mMaxOrder].insert(0);
+}
+
+std::uint64_t BuddyAllocator::OrderSize(int order)const
+{
+	return mMinBlockSize << order;
+}
+
+int BuddyAllocator::OrderForSize(std::uint64_t size)const
+{
+	int order = 0;
+	while(order <= mMaxOrder && OrderSize(order) < size)
+		++order;
+	return order;
+}
+
+std::uint64_t BuddyAllocator::Allocate(std::uint64_t size, std::uint64_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+	// Blocks are aligned to their own size, so a block at least as large as the
+	// alignment satisfies it.
+	std::uint64_t needed = size > alignment ? size : alignment;
+	int order = OrderForSize(needed == 0 ? 1 : needed);
+
+	// Smallest order with a free block.
+	int found = order;
+	while(found <= mMaxOrder && mFreeLists[found].empty())
+		++found;
+
+	if(found > mMaxOrder)
+	{
+		++mFailedAllocations;
+		return InvalidOffset;
+	}
+
+	std::uint64_t offset = *mFreeLists[found].begin();
+	mFreeLists[found].erase(mFreeLists[found].begin());
+
+	// Split down to the requested order, returning the upper halves to the free lists.
+	while(found > order)
+	{
+		--found;
+		mFreeLists[found].insert(offset + OrderSize(found));
+	}
+
+	Allocation a;
+	a.Order = order;
+	a.Size = size;
+	mAllocations[offset] = a;
+
+	mRequestedBytes += size;
+	mAllocatedBytes += OrderSize(order);
+
+	return offset;
+}
+
+void BuddyAllocator::Free(std::uint64_t offset)
+{
+	auto it = mAllocations.find(offset);
+	assert(it != mAllocations.end() && "BuddyAllocator::Free of an offset that is not allocated");
+	if(it == mAllocations.end())
+		return;
+
+	int order = it->second.Order;
+	mRequestedBytes -= it->second.Size;
+	mAllocatedBytes -= OrderSize(order);
+	mAllocations.erase(it);
+
+	// Merge with the buddy for as long as it is free too.
+	while(order < mMaxOrder)
+	{
+		std::uint64_t buddy = offset ^ OrderSize(order);
+		auto b = mFreeLists[order].find(buddy);
+		if(b == mFreeLists[order].end())
+			break;
+
+		mFreeLists[order].erase(b);
+		offset = offset < buddy ? offset : buddy;
+		++order;
+	}
+
+	mFreeLists[order].insert(offset);
+}
+
+std::uint64_t BuddyAllocator::BlockSize(std::uint64_t offset)const
+{
+	auto it = mAllocations.find(offset);
+	return it == mAllocations.end() ? 0 : OrderSize(it->second.Order);
+}
+
+std::uint64_t BuddyAllocator::Capacity()const
+{
+	return mCapacity;
+}
+
+std::uint64_t BuddyAllocator::MinBlockSize()const
+{
+	return mMinBlockSize;
+}
+
+bool BuddyAllocator::Empty()const
+{
+	return mAllocations.empty();
+}
+
+BuddyAllocator::Stats BuddyAllocator::GetStats()const
+{
+	Stats s;
+	s.Capacity = mCapacity;
+	s.RequestedBytes = mRequestedBytes;
+	s.AllocatedBytes = mAllocatedBytes;
+	s.FreeBytes = mCapacity - mAllocatedBytes;
+	s.AllocationCount = (std::uint32_t)mAllocations.size();
+	s.FailedAllocations = mFailedAllocations;
+
+	for(int order = 0; order <= mMaxOrder; ++order)
+	{
+		s.FreeBlockCount += (std::uint32_t)mFreeLists[order].size();
+		if(!mFreeLists[order].empty())
+			s.LargestFreeBlock = OrderSize(order);
+	}
+
+	return s;
+}
@@ -0,0 +1,89 @@
+//***************************************************************************************
+// BuddyAllocator.h
+//
+// Binary buddy allocator over a range of offsets.  The range is split into blocks of
+// minBlockSize << order bytes; an allocation takes the smallest free block that fits,
+// splitting larger blocks in half as needed, and freeing a block merges it with its
+// buddy whenever both halves are free.  Blocks are naturally aligned to their size,
+// so any alignment up to the block size comes for free.
+//
+// Like LinearAllocator and RingAllocator it manages offsets only.  GpuHeapAllocator
+// uses it to place resources inside ID3D12Heaps; nothing here depends on D3D12.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class BuddyAllocator
+{
+public:
+	static const std::uint64_t InvalidOffset = ~std::uint64_t(0);
+
+	struct Stats
+	{
+		std::uint64_t Capacity = 0;
+		std::uint64_t RequestedBytes = 0;  // Sum of the sizes passed to Allocate.
+		std::uint64_t AllocatedBytes = 0;  // Sum of the block sizes handed out.
+		std::uint64_t FreeBytes = 0;
+		std::uint64_t LargestFreeBlock = 0;
+		std::uint32_t AllocationCount = 0;
+		std::uint32_t FreeBlockCount = 0;
+		std::uint64_t FailedAllocations = 0; // Since construction.
+
+		// Share of allocated bytes lost to rounding up to a block size.
+		double InternalFragmentation()const;
+
+		// 1 - LargestFreeBlock/FreeBytes: 0 when all free space is one block,
+		// approaching 1 as it is scattered over many small blocks.
+		double ExternalFragmentation()const;
+	};
+
+	// capacity must be minBlockSize times a power of two; minBlockSize must be a
+	// power of two.
+	BuddyAllocator(std::uint64_t capacity, std::uint64_t minBlockSize);
+
+	// Returns the offset of a block of at least 'size' bytes aligned to 'alignment'
+	// (a power of two), or InvalidOffset if no block is large enough.
+	std::uint64_t Allocate(std::uint64_t size, std::uint64_t alignment = 1);
+
+	// offset must have been returned by Allocate and not freed since.
+	void Free(std::uint64_t offset);
+
+	// Size of the block backing an allocation, or 0 if offset is not allocated.
+	std::uint64_t BlockSize(std::uint64_t offset)const;
+
+	std::uint64_t Capacity()const;
+	std::uint64_t MinBlockSize()const;
+	bool Empty()const;
+
+	Stats GetStats()const;
+
+private:
+	int OrderForSize(std::uint64_t size)const;
+	std::uint64_t OrderSize(int order)const;
+
+private:
+	struct Allocation
+	{
+		int Order;
+		std::uint64_t Size;
+	};
+
+	std::uint64_t mCapacity;
+	std::uint64_t mMinBlockSize;
+	int mMaxOrder;
+
+	// Free block offsets per order.  Ordered so allocations prefer low offsets,
+	// which keeps the top of the range free for large blocks.
+	std::vector<std::set<std::uint64_t>> mFreeLists;
+	std::unordered_map<std::uint64_t, Allocation> mAllocations;
+
+	std::uint64_t mRequestedBytes = 0;
+	std::uint64_t mAllocatedBytes = 0;
+	std::uint64_t mFailedAllocations = 0;
+};
@@ -0,0 +1,192 @@
+//***************************************************************************************
+// CommandContext.cpp
+//***************************************************************************************
+
+#include "CommandContext.h"
+#include <cassert>
+
+std::uint64_t CommandContext::Stats::TotalIssued()const
+{
+	std::uint64_t total = 0;
+	for(int i = 0; i < BindTypeCount; ++i)
+		total += Issued[i];
+	return total;
+}
+
+std::uint64_t CommandContext::Stats::TotalSaved()const
+{
+	std::uint64_t total = 0;
+	for(int i = 0; i < BindTypeCount; ++i)
+		total += Saved[i];
+	return total;
+}
+
+CommandContext::CommandContext(ICommandSink* sink)
+	: mSink(sink)
+{
+}
+
+void CommandContext::SetSink(ICommandSink* sink)
+{
+	mSink = sink;
+	Reset();
+}
+
+ICommandSink* CommandContext::GetSink()const
+{
+	return mSink;
+}
+
+void CommandContext::Reset()
+{
+	mPipelineStateValid = false;
+	mRootSignatureValid = false;
+	mDescriptorHeapValid = false;
+	for(bool& valid : mVertexBufferValid)
+		valid = false;
+	mIndexBufferValid = false;
+	mTopologyValid = false;
+	for(RootArgument& arg : mRootArguments)
+		arg = RootArgument();
+}
+
+void CommandContext::SetPipelineState(StateHandle pso)
+{
+	if(Track(BindPipelineState, !mPipelineStateValid || mPipelineState != pso))
+	{
+		mPipelineStateValid = true;
+		mPipelineState = pso;
+		mSink->SetPipelineState(pso);
+	}
+}
+
+void CommandContext::SetRootSignature(StateHandle rootSignature)
+{
+	if(Track(BindRootSignature, !mRootSignatureValid || mRootSignature != rootSignature))
+	{
+		mRootSignatureValid = true;
+		mRootSignature = rootSignature;
+
+		// A new root signature leaves all root arguments undefined.
+		for(RootArgument& arg : mRootArguments)
+			arg = RootArgument();
+
+		mSink->SetRootSignature(rootSignature);
+	}
+}
+
+void CommandContext::SetDescriptorHeap(StateHandle heap)
+{
+	if(Track(BindDescriptorHeap, !mDescriptorHeapValid || mDescriptorHeap != heap))
+	{
+		mDescriptorHeapValid = true;
+		mDescriptorHeap = heap;
+		mSink->SetDescriptorHeap(heap);
+	}
+}
+
+void CommandContext::SetVertexBuffer(std::uint32_t slot, const VertexBufferBinding& binding)
+{
+	assert(slot < MaxVertexBuffers);
+
+	if(Track(BindVertexBuffer, !mVertexBufferValid[slot] || !(mVertexBuffers[slot] == binding)))
+	{
+		mVertexBufferValid[slot] = true;
+		mVertexBuffers[slot] = binding;
+		mSink->SetVertexBuffer(slot, binding);
+	}
+}
+
+void CommandContext::SetIndexBuffer(const IndexBufferBinding& binding)
+{
+	if(Track(BindIndexBuffer, !mIndexBufferValid || !(mIndexBuffer == binding)))
+	{
+		mIndexBufferValid = true;
+		mIndexBuffer = binding;
+		mSink->SetIndexBuffer(binding);
+	}
+}
+
+void CommandContext::SetPrimitiveTopology(std::uint32_t topology)
+{
+	if(Track(BindPrimitiveTopology, !mTopologyValid || mTopology != topology))
+	{
+		mTopologyValid = true;
+		mTopology = topology;
+		mSink->SetPrimitiveTopology(topology);
+	}
+}
+
+void CommandContext::SetRootConstantBuffer(std::uint32_t rootIndex, std::uint64_t gpuAddress)
+{
+	if(TrackRootArgument(rootIndex, RootArgumentKind::ConstantBuffer, gpuAddress))
+		mSink->SetRootConstantBuffer(rootIndex, gpuAddress);
+}
+
+void CommandContext::SetRootShaderResource(std::uint32_t rootIndex, std::uint64_t gpuAddress)
+{
+	if(TrackRootArgument(rootIndex, RootArgumentKind::ShaderResource, gpuAddress))
+		mSink->SetRootShaderResource(rootIndex, gpuAddress);
+}
+
+void CommandContext::SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle)
+{
+	if(TrackRootArgument(rootIndex, RootArgumentKind::DescriptorTable, gpuHandle))
+		mSink->SetRootDescriptorTable(rootIndex, gpuHandle);
+}
+
+void CommandContext::DrawIndexed(std::uint32_t indexCount, std::uint32_t instanceCount,
+	std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance)
+{
+	++mStats.Draws;
+	mSink->DrawIndexed(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+const CommandContext::Stats& CommandContext::GetStats()const
+{
+	return mStats;
+}
+
+void CommandContext::ResetStats()
+{
+	mStats = Stats();
+}
+
+const char* CommandContext::BindTypeName(BindType type)
+{
+	switch(type)
+	{
+	case BindPipelineState:     return "pipeline_state";
+	case BindRootSignature:     return "root_signature";
+	case BindDescriptorHeap:    return "descriptor_heap";
+	case BindVertexBuffer:      return "vertex_buffer";
+	case BindIndexBuffer:       return "index_buffer";
+	case BindPrimitiveTopology: return "primitive_topology";
+	case BindRootArgument:      return "root_argument";
+	default:                    return "unknown";
+	}
+}
+
+bool CommandContext::Track(BindType type, bool changed)
+{
+	assert(mSink != nullptr);
+
+	if(changed)
+		++mStats.Issued[type];
+	else
+		++mStats.Saved[type];
+	return changed;
+}
+
+bool CommandContext::TrackRootArgument(std::uint32_t rootIndex, RootArgumentKind kind, std::uint64_t value)
+{
+	assert(rootIndex < MaxRootParameters);
+
+	RootArgument& arg = mRootArguments[rootIndex];
+	if(!Track(BindRootArgument, arg.Kind != kind || arg.Value != value))
+		return false;
+
+	arg.Kind = kind;
+	arg.Value = value;
+	return true;
+}
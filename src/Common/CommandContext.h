@@ -0,0 +1,111 @@
+//***************************************************************************************
+// CommandContext.h
+//
+// State-tracking front end for an ICommandSink.  Each bind is compared against the
+// value last sent to the sink and dropped if it would not change anything; the
+// counters record how many binds were issued and how many were saved.
+//
+// Rules that follow the D3D12 command list semantics:
+//  - Reset forgets all tracked state.  Call it whenever the underlying command list
+//    is reset, or after state is set on the list without going through the context.
+//  - Changing the root signature invalidates all root arguments.
+//***************************************************************************************
+
+#pragma once
+
+#include "CommandSink.h"
+
+class CommandContext
+{
+public:
+	enum BindType
+	{
+		BindPipelineState,
+		BindRootSignature,
+		BindDescriptorHeap,
+		BindVertexBuffer,
+		BindIndexBuffer,
+		BindPrimitiveTopology,
+		BindRootArgument,
+		BindTypeCount
+	};
+
+	struct Stats
+	{
+		std::uint64_t Issued[BindTypeCount] = {};
+		std::uint64_t Saved[BindTypeCount] = {};
+		std::uint64_t Draws = 0;
+
+		std::uint64_t TotalIssued()const;
+		std::uint64_t TotalSaved()const;
+	};
+
+	static const std::uint32_t MaxRootParameters = 16;
+	static const std::uint32_t MaxVertexBuffers = 4;
+
+	explicit CommandContext(ICommandSink* sink = nullptr);
+
+	void SetSink(ICommandSink* sink);
+	ICommandSink* GetSink()const;
+
+	// Forgets the tracked state; the next bind of every kind is always issued.
+	void Reset();
+
+	void SetPipelineState(StateHandle pso);
+	void SetRootSignature(StateHandle rootSignature);
+	void SetDescriptorHeap(StateHandle heap);
+	void SetVertexBuffer(std::uint32_t slot, const VertexBufferBinding& binding);
+	void SetIndexBuffer(const IndexBufferBinding& binding);
+	void SetPrimitiveTopology(std::uint32_t topology);
+	void SetRootConstantBuffer(std::uint32_t rootIndex, std::uint64_t gpuAddress);
+	void SetRootShaderResource(std::uint32_t rootIndex, std::uint64_t gpuAddress);
+	void SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle);
+
+	void DrawIndexed(std::uint32_t indexCount, std::uint32_t instanceCount = 1,
+		std::uint32_t startIndex = 0, std::int32_t baseVertex = 0, std::uint32_t startInstance = 0);
+
+	const Stats& GetStats()const;
+	void ResetStats();
+
+	static const char* BindTypeName(BindType type);
+
+private:
+	enum class RootArgumentKind
+	{
+		None,
+		ConstantBuffer,
+		ShaderResource,
+		DescriptorTable
+	};
+
+	struct RootArgument
+	{
+		RootArgumentKind Kind = RootArgumentKind::None;
+		std::uint64_t Value = 0;
+	};
+
+	// Returns true if the bind must be issued, and updates the counters.
+	bool Track(BindType type, bool changed);
+	bool TrackRootArgument(std::uint32_t rootIndex, RootArgumentKind kind, std::uint64_t value);
+
+private:
+	ICommandSink* mSink = nullptr;
+
+	// Each piece of state carries a valid flag so the first bind after Reset is
+	// issued even if it matches a stale value.
+	bool mPipelineStateValid = false;
+	StateHandle mPipelineState = 0;
+	bool mRootSignatureValid = false;
+	StateHandle mRootSignature = 0;
+	bool mDescriptorHeapValid = false;
+	StateHandle mDescriptorHeap = 0;
+	bool mVertexBufferValid[MaxVertexBuffers] = {};
+	VertexBufferBinding mVertexBuffers[MaxVertexBuffers];
+	bool mIndexBufferValid = false;
+	IndexBufferBinding mIndexBuffer;
+	bool mTopologyValid = false;
+	std::uint32_t mTopology = 0;
+	RootArgument mRootArguments[MaxRootParameters];
+
+	Stats mStats;
+};
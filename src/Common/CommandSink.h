@@ -0,0 +1,61 @@
+//***************************************************************************************
+// CommandSink.h
+//
+// Abstract destination for the state binds and draws the render adapter records.
+// Objects are passed as opaque handles and GPU addresses, so the interface has no
+// D3D12 dependency: D3D12CommandSink forwards to a graphics command list, and
+// RecordingCommandSink stores the calls so the layers in front of a sink (see
+// CommandContext) can be exercised without a device.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+
+// Identifies a pipeline state, root signature or descriptor heap.  0 is "none".
+using StateHandle = std::uint64_t;
+
+struct VertexBufferBinding
+{
+	std::uint64_t Address = 0;
+	std::uint32_t SizeInBytes = 0;
+	std::uint32_t StrideInBytes = 0;
+
+	bool operator==(const VertexBufferBinding& rhs)const
+	{
+		return Address == rhs.Address && SizeInBytes == rhs.SizeInBytes && StrideInBytes == rhs.StrideInBytes;
+	}
+};
+
+struct IndexBufferBinding
+{
+	std::uint64_t Address = 0;
+	std::uint32_t SizeInBytes = 0;
+	std::uint32_t Format = 0; // DXGI_FORMAT value.
+
+	bool operator==(const IndexBufferBinding& rhs)const
+	{
+		return Address == rhs.Address && SizeInBytes == rhs.SizeInBytes && Format == rhs.Format;
+	}
+};
+
+class ICommandSink
+{
+public:
+	virtual ~ICommandSink() = default;
+
+	virtual void SetPipelineState(StateHandle pso) = 0;
+	virtual void SetRootSignature(StateHandle rootSignature) = 0;
+	virtual void SetDescriptorHeap(StateHandle heap) = 0;
+	virtual void SetVertexBuffer(std::uint32_t slot, const VertexBufferBinding& binding) = 0;
+	virtual void SetIndexBuffer(const IndexBufferBinding& binding) = 0;
+	virtual void SetPrimitiveTopology(std::uint32_t topology) = 0; // D3D_PRIMITIVE_TOPOLOGY value.
+
+	// Root arguments of the graphics root signature.
+	virtual void SetRootConstantBuffer(std::uint32_t rootIndex, std::uint64_t gpuAddress) = 0;
+	virtual void SetRootShaderResource(std::uint32_t rootIndex, std::uint64_t gpuAddress) = 0;
+	virtual void SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle) = 0;
+
+	virtual void DrawIndexed(std::uint32_t indexCount, std::uint32_t instanceCount,
+		std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) = 0;
+};
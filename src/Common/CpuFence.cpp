@@ -0,0 +1,101 @@
+//***************************************************************************************
+// CpuFence.cpp
+//***************************************************************************************
+
+#include "CpuFence.h"
+#include <chrono>
+
+CpuFence::CpuFence(CpuQueue* queue, std::uint64_t initialValue)
+	: mQueue(queue), mCompleted(initialValue)
+{
+	mLastSignaled = initialValue;
+}
+
+std::uint64_t CpuFence::Signal()
+{
+	std::uint64_t value = ++mLastSignaled;
+	if(mQueue != nullptr)
+		mQueue->Signal(this, value);
+	else
+		Complete(value);
+	return value;
+}
+
+std::uint64_t CpuFence::CompletedValue()const
+{
+	return mCompleted.load(std::memory_order_acquire);
+}
+
+void CpuFence::Complete(std::uint64_t value)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(value <= mCompleted.load(std::memory_order_relaxed))
+			return;
+		mCompleted.store(value, std::memory_order_release);
+	}
+	mCondition.notify_all();
+}
+
+bool CpuFence::BlockUntil(std::uint64_t value, std::uint32_t timeoutMs)
+{
+	auto done = [this, value]() { return IsComplete(value); };
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	if(timeoutMs == Infinite)
+	{
+		mCondition.wait(lock, done);
+		return true;
+	}
+
+	return mCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), done);
+}
+
+CpuQueue::CpuQueue()
+{
+	mWorker = std::thread(&CpuQueue::WorkerMain, this);
+}
+
+CpuQueue::~CpuQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mCondition.notify_all();
+	mWorker.join();
+}
+
+void CpuQueue::Execute(std::function<void()> work)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mWork.push_back(std::move(work));
+	}
+	mCondition.notify_one();
+}
+
+void CpuQueue::Signal(CpuFence* fence, std::uint64_t value)
+{
+	Execute([fence, value]() { fence->Complete(value); });
+}
+
+void CpuQueue::WorkerMain()
+{
+	for(;;)
+	{
+		std::function<void()> work;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this]() { return mQuit || !mWork.empty(); });
+
+			// Drain outstanding work before quitting so pending fences still complete.
+			if(mWork.empty())
+				return;
+
+			work = std::move(mWork.front());
+			mWork.pop_front();
+		}
+		work();
+	}
+}
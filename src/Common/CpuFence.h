@@ -0,0 +1,73 @@
+//***************************************************************************************
+// CpuFence.h
+//
+// In-process stand-ins for a GPU fence and command queue, used to exercise frame
+// pacing logic (FrameRing and friends) without a device.
+//
+// CpuFence is the IFence stand-in: a monotonically increasing completed value that a
+// "GPU" side advances and a "CPU" side polls or blocks on.  Signal goes through the
+// CpuQueue given at construction, or completes immediately without one.
+//
+// CpuQueue plays the part of ID3D12CommandQueue.  Submitted work runs in order on a
+// worker thread, and Signal enqueues a fence update behind all previous work, so the
+// fence completes only after that work has run.
+//***************************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "Fence.h"
+
+class CpuQueue;
+
+class CpuFence : public IFence
+{
+public:
+	explicit CpuFence(CpuQueue* queue = nullptr, std::uint64_t initialValue = 0);
+
+	virtual std::uint64_t Signal() override;
+	virtual std::uint64_t CompletedValue()const override;
+
+	// Sets the completed value.  Values smaller than the current one are ignored.
+	// This is the "GPU" side and may be called from any thread.
+	void Complete(std::uint64_t value);
+
+protected:
+	virtual bool BlockUntil(std::uint64_t value, std::uint32_t timeoutMs) override;
+
+private:
+	CpuQueue* mQueue;
+	std::atomic<std::uint64_t> mCompleted;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+};
+
+class CpuQueue
+{
+public:
+	CpuQueue();
+	CpuQueue(const CpuQueue& rhs) = delete;
+	CpuQueue& operator=(const CpuQueue& rhs) = delete;
+	~CpuQueue();
+
+	void Execute(std::function<void()> work);
+
+	// Completes 'value' on 'fence' after all previously executed work has run.
+	void Signal(CpuFence* fence, std::uint64_t value);
+
+private:
+	void WorkerMain();
+
+private:
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	std::deque<std::function<void()>> mWork;
+	bool mQuit = false;
+	std::thread mWorker;
+};
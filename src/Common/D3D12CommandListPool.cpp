@@ -0,0 +1,70 @@
+//***************************************************************************************
+// D3D12CommandListPool.cpp
+//***************************************************************************************
+
+#include "D3D12CommandListPool.h"
+
+using Microsoft::WRL::ComPtr;
+
+D3D12CommandListPool::D3D12CommandListPool(ID3D12Device* device, UINT listCount, PrepareFunction prepare)
+	: mCommandLists(listCount), mSinks(listCount), mAllocators(listCount, nullptr), mPrepare(std::move(prepare))
+{
+	// Lists are created against a temporary allocator and closed right away; each
+	// frame resets them with that frame's allocator.
+	ComPtr<ID3D12CommandAllocator> allocator;
+	ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+		IID_PPV_ARGS(allocator.GetAddressOf())));
+
+	for(UINT i = 0; i < listCount; ++i)
+	{
+		ThrowIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator.Get(), nullptr,
+			IID_PPV_ARGS(mCommandLists[i].GetAddressOf())));
+		ThrowIfFailed(mCommandLists[i]->Close());
+
+		mSinks[i].SetCommandList(mCommandLists[i].Get());
+	}
+}
+
+void D3D12CommandListPool::BeginFrame(const std::vector<ComPtr<ID3D12CommandAllocator>>& allocators)
+{
+	assert(allocators.size() >= mAllocators.size());
+
+	for(std::size_t i = 0; i < mAllocators.size(); ++i)
+		mAllocators[i] = allocators[i].Get();
+}
+
+ICommandSink* D3D12CommandListPool::BeginSlice(std::uint32_t slot)
+{
+	// Each slot's allocator is used by one list once per frame, so it can be reset
+	// here, on the recording thread.
+	ThrowIfFailed(mAllocators[slot]->Reset());
+	ThrowIfFailed(mCommandLists[slot]->Reset(mAllocators[slot], nullptr));
+
+	if(mPrepare)
+		mPrepare(mCommandLists[slot].Get());
+
+	return &mSinks[slot];
+}
+
+void D3D12CommandListPool::EndSlice(std::uint32_t slot)
+{
+	ThrowIfFailed(mCommandLists[slot]->Close());
+}
+
+void D3D12CommandListPool::Execute(ID3D12CommandQueue* queue, UINT count)
+{
+	assert(count <= mCommandLists.size());
+	if(count == 0)
+		return;
+
+	std::vector<ID3D12CommandList*> lists(count);
+	for(UINT i = 0; i < count; ++i)
+		lists[i] = mCommandLists[i].Get();
+
+	queue->ExecuteCommandLists(count, lists.data());
+}
+
+UINT D3D12CommandListPool::ListCount()const
+{
+	return (UINT)mCommandLists.size();
+}
@@ -0,0 +1,47 @@
+//***************************************************************************************
+// D3D12CommandListPool.h
+//
+// ParallelRecorder::ISinkProvider backed by one graphics command list per slot.  The
+// command allocators are supplied per frame (they belong to the frame resource, since
+// an allocator cannot be reset while the GPU may still execute its commands); the
+// lists themselves are reused every frame.
+//
+// Command lists do not inherit state from each other, so every slice starts by
+// calling the prepare function given at construction, which binds what the slice
+// needs: render targets, viewport, scissor, descriptor heaps.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "D3D12CommandSink.h"
+#include "ParallelRecorder.h"
+#include <functional>
+
+class D3D12CommandListPool : public ParallelRecorder::ISinkProvider
+{
+public:
+	using PrepareFunction = std::function<void(ID3D12GraphicsCommandList* cmdList)>;
+
+	D3D12CommandListPool(ID3D12Device* device, UINT listCount, PrepareFunction prepare);
+	D3D12CommandListPool(const D3D12CommandListPool& rhs) = delete;
+	D3D12CommandListPool& operator=(const D3D12CommandListPool& rhs) = delete;
+
+	// allocators holds at least ListCount allocators for this frame, none of which
+	// the GPU may still be using.
+	void BeginFrame(const std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>>& allocators);
+
+	virtual ICommandSink* BeginSlice(std::uint32_t slot) override;
+	virtual void EndSlice(std::uint32_t slot) override;
+
+	// Submits the lists of slots [0, count) in slot order with one ExecuteCommandLists.
+	void Execute(ID3D12CommandQueue* queue, UINT count);
+
+	UINT ListCount()const;
+
+private:
+	std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> mCommandLists;
+	std::vector<D3D12CommandSink> mSinks;
+	std::vector<ID3D12CommandAllocator*> mAllocators;
+	PrepareFunction mPrepare;
+};
@@ -0,0 +1,105 @@
+//***************************************************************************************
+// D3D12CommandSink.cpp
+//***************************************************************************************
+
+#include "D3D12CommandSink.h"
+
+D3D12CommandSink::D3D12CommandSink(ID3D12GraphicsCommandList* cmdList)
+	: mCommandList(cmdList)
+{
+}
+
+void D3D12CommandSink::SetCommandList(ID3D12GraphicsCommandList* cmdList)
+{
+	mCommandList = cmdList;
+}
+
+ID3D12GraphicsCommandList* D3D12CommandSink::GetCommandList()const
+{
+	return mCommandList;
+}
+
+void D3D12CommandSink::SetPipelineState(StateHandle pso)
+{
+	mCommandList->SetPipelineState(reinterpret_cast<ID3D12PipelineState*>(pso));
+}
+
+void D3D12CommandSink::SetRootSignature(StateHandle rootSignature)
+{
+	mCommandList->SetGraphicsRootSignature(reinterpret_cast<ID3D12RootSignature*>(rootSignature));
+}
+
+void D3D12CommandSink::SetDescriptorHeap(StateHandle heap)
+{
+	ID3D12DescriptorHeap* heaps[] = { reinterpret_cast<ID3D12DescriptorHeap*>(heap) };
+	mCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
+}
+
+void D3D12CommandSink::SetVertexBuffer(std::uint32_t slot, const VertexBufferBinding& binding)
+{
+	D3D12_VERTEX_BUFFER_VIEW view;
+	view.BufferLocation = binding.Address;
+	view.SizeInBytes = binding.SizeInBytes;
+	view.StrideInBytes = binding.StrideInBytes;
+	mCommandList->IASetVertexBuffers(slot, 1, &view);
+}
+
+void D3D12CommandSink::SetIndexBuffer(const IndexBufferBinding& binding)
+{
+	D3D12_INDEX_BUFFER_VIEW view;
+	view.BufferLocation = binding.Address;
+	view.SizeInBytes = binding.SizeInBytes;
+	view.Format = (DXGI_FORMAT)binding.Format;
+	mCommandList->IASetIndexBuffer(&view);
+}
+
+void D3D12CommandSink::SetPrimitiveTopology(std::uint32_t topology)
+{
+	mCommandList->IASetPrimitiveTopology((D3D_PRIMITIVE_TOPOLOGY)topology);
+}
+
+void D3D12CommandSink::SetRootConstantBuffer(std::uint32_t rootIndex, std::uint64_t gpuAddress)
+{
+	mCommandList->SetGraphicsRootConstantBufferView(rootIndex, gpuAddress);
+}
+
+void D3D12CommandSink::SetRootShaderResource(std::uint32_t rootIndex, std::uint64_t gpuAddress)
+{
+	mCommandList->SetGraphicsRootShaderResourceView(rootIndex, gpuAddress);
+}
+
+void D3D12CommandSink::SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle)
+{
+	D3D12_GPU_DESCRIPTOR_HANDLE handle;
+	handle.ptr = gpuHandle;
+	mCommandList->SetGraphicsRootDescriptorTable(rootIndex, handle);
+}
+
+void D3D12CommandSink::DrawIndexed(std::uint32_t indexCount, std::uint32_t instanceCount,
+	std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance)
+{
+	mCommandList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+StateHandle D3D12CommandSink::ToHandle(IUnknown* object)
+{
+	return (StateHandle)reinterpret_cast<std::uintptr_t>(object);
+}
+
+VertexBufferBinding D3D12CommandSink::ToBinding(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+	VertexBufferBinding b;
+	b.Address = view.BufferLocation;
+	b.SizeInBytes = view.SizeInBytes;
+	b.StrideInBytes = view.StrideInBytes;
+	return b;
+}
+
+IndexBufferBinding D3D12CommandSink::ToBinding(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+	IndexBufferBinding b;
+	b.Address = view.BufferLocation;
+	b.SizeInBytes = view.SizeInBytes;
+	b.Format = (std::uint32_t)view.Format;
+	return b;
+}
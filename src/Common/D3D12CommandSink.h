@@ -0,0 +1,39 @@
+//***************************************************************************************
+// D3D12CommandSink.h
+//
+// ICommandSink that forwards to an ID3D12GraphicsCommandList.  Handles are the
+// addresses of the D3D12 objects; use ToHandle to make them.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "CommandSink.h"
+
+class D3D12CommandSink : public ICommandSink
+{
+public:
+	explicit D3D12CommandSink(ID3D12GraphicsCommandList* cmdList = nullptr);
+
+	void SetCommandList(ID3D12GraphicsCommandList* cmdList);
+	ID3D12GraphicsCommandList* GetCommandList()const;
+
+	virtual void SetPipelineState(StateHandle pso) override;
+	virtual void SetRootSignature(StateHandle rootSignature) override;
+	virtual void SetDescriptorHeap(StateHandle heap) override;
+	virtual void SetVertexBuffer(std::uint32_t slot, const VertexBufferBinding& binding) override;
+	virtual void SetIndexBuffer(const IndexBufferBinding& binding) override;
+	virtual void SetPrimitiveTopology(std::uint32_t topology) override;
+	virtual void SetRootConstantBuffer(std::uint32_t rootIndex, std::uint64_t gpuAddress) override;
+	virtual void SetRootShaderResource(std::uint32_t rootIndex, std::uint64_t gpuAddress) override;
+	virtual void SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle) override;
+	virtual void DrawIndexed(std::uint32_t indexCount, std::uint32_t instanceCount,
+		std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) override;
+
+	static StateHandle ToHandle(IUnknown* object);
+	static VertexBufferBinding ToBinding(const D3D12_VERTEX_BUFFER_VIEW& view);
+	static IndexBufferBinding ToBinding(const D3D12_INDEX_BUFFER_VIEW& view);
+
+private:
+	ID3D12GraphicsCommandList* mCommandList = nullptr;
+};
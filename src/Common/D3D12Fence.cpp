@@ -0,0 +1,66 @@
+//***************************************************************************************
+// D3D12Fence.cpp
+//***************************************************************************************
+
+#include "D3D12Fence.h"
+
+D3D12Fence::D3D12Fence(ID3D12Device* device, ID3D12CommandQueue* queue, UINT64 initialValue)
+	: mQueue(queue)
+{
+	mLastSignaled = initialValue;
+
+	ThrowIfFailed(device->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
+
+	mEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+	if(mEvent == nullptr)
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+}
+
+D3D12Fence::~D3D12Fence()
+{
+	if(mEvent != nullptr)
+		CloseHandle(mEvent);
+}
+
+std::uint64_t D3D12Fence::Signal()
+{
+	// The new fence point is set once the GPU has processed all commands submitted
+	// to the queue before this Signal().
+	ThrowIfFailed(mQueue->Signal(mFence.Get(), mLastSignaled + 1));
+	return ++mLastSignaled;
+}
+
+std::uint64_t D3D12Fence::CompletedValue()const
+{
+	return mFence->GetCompletedValue();
+}
+
+ID3D12Fence* D3D12Fence::Get()const
+{
+	return mFence.Get();
+}
+
+bool D3D12Fence::BlockUntil(std::uint64_t value, std::uint32_t timeoutMs)
+{
+	ThrowIfFailed(mFence->SetEventOnCompletion(value, mEvent));
+
+	// A previous wait that timed out leaves its completion request armed, so the
+	// event may fire for an older value.  Keep waiting until 'value' itself is done.
+	ULONGLONG start = GetTickCount64();
+	while(!IsComplete(value))
+	{
+		DWORD remaining = INFINITE;
+		if(timeoutMs != Infinite)
+		{
+			ULONGLONG elapsed = GetTickCount64() - start;
+			if(elapsed >= timeoutMs)
+				return false;
+			remaining = (DWORD)(timeoutMs - elapsed);
+		}
+
+		if(WaitForSingleObject(mEvent, remaining) == WAIT_TIMEOUT)
+			return IsComplete(value);
+	}
+
+	return true;
+}
@@ -0,0 +1,31 @@
+//***************************************************************************************
+// D3D12Fence.h
+//
+// IFence over an ID3D12Fence signaled on one command queue.  A single auto-reset event
+// is created up front and reused for every blocking wait.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "Fence.h"
+
+class D3D12Fence : public IFence
+{
+public:
+	D3D12Fence(ID3D12Device* device, ID3D12CommandQueue* queue, UINT64 initialValue = 0);
+	~D3D12Fence();
+
+	virtual std::uint64_t Signal() override;
+	virtual std::uint64_t CompletedValue()const override;
+
+	ID3D12Fence* Get()const;
+
+protected:
+	virtual bool BlockUntil(std::uint64_t value, std::uint32_t timeoutMs) override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+	Microsoft::WRL::ComPtr<ID3D12CommandQueue> mQueue;
+	HANDLE mEvent = nullptr;
+};
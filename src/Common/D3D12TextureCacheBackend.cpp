@@ -0,0 +1,110 @@
+//***************************************************************************************
+// D3D12TextureCacheBackend.cpp
+//***************************************************************************************
+
+#include "D3D12TextureCacheBackend.h"
+#include <cassert>
+
+D3D12TextureCacheBackend::D3D12TextureCacheBackend(TextureStreamer& streamer, D3D12TextureStreamer& uploader,
+	IFence* graphicsFence)
+	: mStreamer(streamer), mUploader(uploader), mGraphicsFence(graphicsFence)
+{
+}
+
+std::uint32_t D3D12TextureCacheBackend::Load(const std::string& fileName, std::uint32_t maxsize)
+{
+	std::uint32_t texture;
+	if(!mFreeSlots.empty())
+	{
+		texture = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		mSlots.emplace_back();
+		texture = (std::uint32_t)mSlots.size();
+	}
+
+	Slot& slot = mSlots[texture - 1];
+	slot.FileName = fileName;
+	slot.Current = mStreamer.Request(fileName, maxsize);
+	slot.Pending = TextureStreamer::InvalidHandle;
+	slot.Live = true;
+
+	return texture;
+}
+
+void D3D12TextureCacheBackend::Resize(std::uint32_t texture, std::uint32_t maxsize)
+{
+	Slot& slot = Get(texture);
+
+	// A newer size supersedes a resize still in progress.
+	if(slot.Pending != TextureStreamer::InvalidHandle)
+		Drop(slot.Pending);
+
+	slot.Pending = mStreamer.Request(slot.FileName, maxsize);
+}
+
+void D3D12TextureCacheBackend::Release(std::uint32_t texture)
+{
+	Slot& slot = Get(texture);
+
+	Drop(slot.Current);
+	if(slot.Pending != TextureStreamer::InvalidHandle)
+		Drop(slot.Pending);
+
+	slot = Slot();
+	mFreeSlots.push_back(texture);
+}
+
+bool D3D12TextureCacheBackend::GetDesc(std::uint32_t texture, DirectX::DDSTextureDesc& desc)
+{
+	return mStreamer.GetDesc(Get(texture).Current, desc);
+}
+
+void D3D12TextureCacheBackend::Update()
+{
+	for(Slot& slot : mSlots)
+	{
+		if(!slot.Live || slot.Pending == TextureStreamer::InvalidHandle)
+			continue;
+
+		if(mUploader.IsResident(slot.Pending))
+		{
+			Drop(slot.Current);
+			slot.Current = slot.Pending;
+			slot.Pending = TextureStreamer::InvalidHandle;
+		}
+		else if(mStreamer.GetState(slot.Pending) == TextureStreamer::State::Failed)
+		{
+			// Keep showing the current size.
+			Drop(slot.Pending);
+			slot.Pending = TextureStreamer::InvalidHandle;
+		}
+	}
+
+	mUploader.FreeReleased(mGraphicsFence->CompletedValue());
+}
+
+ID3D12Resource* D3D12TextureCacheBackend::Resolve(std::uint32_t texture)const
+{
+	return mUploader.Resolve(Get(texture).Current);
+}
+
+D3D12TextureCacheBackend::Slot& D3D12TextureCacheBackend::Get(std::uint32_t texture)
+{
+	assert(texture != 0 && texture <= mSlots.size() && mSlots[texture - 1].Live);
+	return mSlots[texture - 1];
+}
+
+const D3D12TextureCacheBackend::Slot& D3D12TextureCacheBackend::Get(std::uint32_t texture)const
+{
+	assert(texture != 0 && texture <= mSlots.size() && mSlots[texture - 1].Live);
+	return mSlots[texture - 1];
+}
+
+void D3D12TextureCacheBackend::Drop(TextureStreamer::Handle handle)
+{
+	// Frames recorded so far are submitted before the next signal.
+	mUploader.Release(handle, mGraphicsFence->LastSignaled() + 1);
+}
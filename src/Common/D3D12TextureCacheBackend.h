@@ -0,0 +1,63 @@
+//***************************************************************************************
+// D3D12TextureCacheBackend.h
+//
+// TextureCache::IBackend over the TextureStreamer and its D3D12 upload stage.  A
+// cache texture id stays the same for the life of the texture while the streamer
+// handle behind it changes: Resize requests a second load at the new maxsize and keeps
+// resolving to the current one until the replacement is resident, so a texture never
+// drops to the placeholder while it changes size.
+//
+// Replaced and released textures may still be sampled by frames in flight.  They are
+// handed to D3D12TextureStreamer::Release with the graphics fence value that follows
+// the work submitted so far, and freed once that value completes.
+//***************************************************************************************
+
+#pragma once
+
+#include "D3D12TextureStreamer.h"
+#include "Fence.h"
+#include "TextureCache.h"
+#include "TextureStreamer.h"
+
+class D3D12TextureCacheBackend : public TextureCache::IBackend
+{
+public:
+	// All three must outlive this object.  graphicsFence is signaled by the queue
+	// that samples the textures.
+	D3D12TextureCacheBackend(TextureStreamer& streamer, D3D12TextureStreamer& uploader, IFence* graphicsFence);
+	D3D12TextureCacheBackend(const D3D12TextureCacheBackend& rhs) = delete;
+	D3D12TextureCacheBackend& operator=(const D3D12TextureCacheBackend& rhs) = delete;
+
+	virtual std::uint32_t Load(const std::string& fileName, std::uint32_t maxsize) override;
+	virtual void Resize(std::uint32_t texture, std::uint32_t maxsize) override;
+	virtual void Release(std::uint32_t texture) override;
+	virtual bool GetDesc(std::uint32_t texture, DirectX::DDSTextureDesc& desc) override;
+
+	// Swaps in resized textures that have become resident and frees released ones
+	// the GPU is done with.  Call once per frame after D3D12TextureStreamer::Update.
+	void Update();
+
+	// The texture's current resource, or the placeholder until it is resident.
+	ID3D12Resource* Resolve(std::uint32_t texture)const;
+
+private:
+	struct Slot
+	{
+		std::string FileName;
+		TextureStreamer::Handle Current = TextureStreamer::InvalidHandle;
+		TextureStreamer::Handle Pending = TextureStreamer::InvalidHandle; // Resize in progress.
+		bool Live = false;
+	};
+
+	Slot& Get(std::uint32_t texture);
+	const Slot& Get(std::uint32_t texture)const;
+	void Drop(TextureStreamer::Handle handle);
+
+private:
+	TextureStreamer& mStreamer;
+	D3D12TextureStreamer& mUploader;
+	IFence* mGraphicsFence = nullptr;
+
+	std::vector<Slot> mSlots; // Indexed by texture id - 1.
+	std::vector<std::uint32_t> mFreeSlots;
+};
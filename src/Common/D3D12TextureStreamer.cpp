@@ -0,0 +1,274 @@
+//***************************************************************************************
+// D3D12TextureStreamer.cpp
+//***************************************************************************************
+
+#include "D3D12TextureStreamer.h"
+
+using Microsoft::WRL::ComPtr;
+
+D3D12TextureStreamer::D3D12TextureStreamer(ID3D12Device* device, TextureStreamer& streamer,
+	GpuHeapAllocator* heapAllocator, UINT64 stagingCapacity, UINT64 maxBatchBytes)
+	: md3dDevice(device), mStreamer(streamer), mHeapAllocator(heapAllocator), mMaxBatchBytes(maxBatchBytes)
+{
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	ThrowIfFailed(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(mCopyQueue.GetAddressOf())));
+
+	mFence = std::make_unique<D3D12Fence>(device, mCopyQueue.Get());
+	mBatcher = std::make_unique<UploadBatcher>(device, mFence.get(), stagingCapacity);
+
+	ComPtr<ID3D12CommandAllocator> allocator = AcquireAllocator();
+	ThrowIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, allocator.Get(), nullptr,
+		IID_PPV_ARGS(mCopyList.GetAddressOf())));
+	ThrowIfFailed(mCopyList->Close());
+	mFreeAllocators.push_back(allocator);
+
+	CreatePlaceholder();
+}
+
+D3D12TextureStreamer::~D3D12TextureStreamer()
+{
+	// The copy queue may still be writing textures and reading staging memory.
+	mFence->Flush();
+	Retire();
+}
+
+void D3D12TextureStreamer::Update()
+{
+	Retire();
+
+	mTaken.clear();
+	if(mStreamer.TakeLoaded(mTaken, mMaxBatchBytes) == 0)
+		return;
+
+	Batch batch;
+	batch.Allocator = AcquireAllocator();
+	ThrowIfFailed(mCopyList->Reset(batch.Allocator.Get(), nullptr));
+	mBatcher->Begin(mCopyList.Get());
+
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+	for(const TextureStreamer::LoadedTexture& texture : mTaken)
+	{
+		GpuAllocation resource = CreateTexture(texture);
+		if(!resource)
+		{
+			mStreamer.MarkFailed(texture.Id, "the device could not create the texture");
+			++mStats.CreateFailures;
+			continue;
+		}
+
+		subresources.resize(texture.Layout.Subresources.size());
+		for(std::size_t i = 0; i < subresources.size(); ++i)
+		{
+			const DirectX::DDSSubresource& sub = texture.Layout.Subresources[i];
+			subresources[i].pData = texture.Bits.data() + sub.Offset;
+			subresources[i].RowPitch = (LONG_PTR)sub.RowPitch;
+			subresources[i].SlicePitch = (LONG_PTR)sub.SlicePitch;
+		}
+
+		// The texture is in COMMON, which the copy queue promotes to COPY_DEST by
+		// itself, so no barriers are recorded.
+		mBatcher->UploadTexture(resource.Resource(), 0, (UINT)subresources.size(), subresources.data(),
+			D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_DEST);
+
+		batch.Handles.push_back(texture.Id);
+		batch.Textures.push_back(std::move(resource));
+		mStats.BytesUploaded += texture.Bits.size();
+		++mStats.TexturesUploaded;
+	}
+
+	ThrowIfFailed(mCopyList->Close());
+	ID3D12CommandList* cmdLists[] = { mCopyList.Get() };
+	mCopyQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+	batch.Fence = mBatcher->End();
+
+	mInFlight.push_back(std::move(batch));
+	++mStats.Batches;
+
+	// The batcher has staged the bits; drop the CPU copies now rather than next frame.
+	mTaken.clear();
+}
+
+ID3D12Resource* D3D12TextureStreamer::Resolve(TextureStreamer::Handle handle)const
+{
+	if(IsResident(handle))
+		return mResident[TextureStreamer::SlotIndex(handle)].Texture.Resource();
+
+	return mPlaceholder.Get();
+}
+
+bool D3D12TextureStreamer::IsResident(TextureStreamer::Handle handle)const
+{
+	if(handle == TextureStreamer::InvalidHandle)
+		return false;
+
+	std::uint32_t slot = TextureStreamer::SlotIndex(handle);
+	return slot < mResident.size() && mResident[slot].Handle == handle && mResident[slot].Texture;
+}
+
+void D3D12TextureStreamer::Release(TextureStreamer::Handle handle, UINT64 fenceValue)
+{
+	if(IsResident(handle))
+	{
+		assert((mReleased.empty() || mReleased.back().Fence <= fenceValue) && "fence values must not decrease");
+		ResidentTexture& resident = mResident[TextureStreamer::SlotIndex(handle)];
+		mReleased.push_back({ fenceValue, std::move(resident.Texture) });
+		resident = ResidentTexture();
+	}
+	else if(mStreamer.GetState(handle) == TextureStreamer::State::Uploading)
+	{
+		// In a batch on the copy queue; Retire frees it.  Textures still loading are
+		// discarded by the streamer and never get here.
+		mReleasedEarly.insert(handle);
+	}
+
+	mStreamer.Release(handle);
+}
+
+void D3D12TextureStreamer::FreeReleased(UINT64 completedFenceValue)
+{
+	while(!mReleased.empty() && mReleased.front().Fence <= completedFenceValue)
+	{
+		mReleased.pop_front();
+	}
+}
+
+ID3D12Resource* D3D12TextureStreamer::Placeholder()const
+{
+	return mPlaceholder.Get();
+}
+
+ID3D12CommandQueue* D3D12TextureStreamer::CopyQueue()const
+{
+	return mCopyQueue.Get();
+}
+
+const D3D12TextureStreamer::Stats& D3D12TextureStreamer::GetStats()const
+{
+	return mStats;
+}
+
+void D3D12TextureStreamer::Retire()
+{
+	UINT64 completed = mFence->CompletedValue();
+	while(!mInFlight.empty() && mInFlight.front().Fence <= completed)
+	{
+		Batch& batch = mInFlight.front();
+		for(std::size_t i = 0; i < batch.Handles.size(); ++i)
+		{
+			TextureStreamer::Handle handle = batch.Handles[i];
+			mStreamer.MarkResident(handle);
+
+			// Released while uploading: only the copy queue has touched it.
+			if(mReleasedEarly.erase(handle) != 0)
+			{
+				batch.Textures[i].Reset();
+				continue;
+			}
+
+			std::uint32_t slot = TextureStreamer::SlotIndex(handle);
+			if(slot >= mResident.size())
+				mResident.resize(slot + 1);
+
+			mResident[slot].Handle = handle;
+			mResident[slot].Texture = std::move(batch.Textures[i]);
+		}
+
+		mFreeAllocators.push_back(std::move(batch.Allocator));
+		mInFlight.pop_front();
+	}
+}
+
+ComPtr<ID3D12CommandAllocator> D3D12TextureStreamer::AcquireAllocator()
+{
+	ComPtr<ID3D12CommandAllocator> allocator;
+	if(!mFreeAllocators.empty())
+	{
+		// Only allocators of retired batches are on the free list.
+		allocator = std::move(mFreeAllocators.back());
+		mFreeAllocators.pop_back();
+		ThrowIfFailed(allocator->Reset());
+	}
+	else
+	{
+		ThrowIfFailed(md3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY,
+			IID_PPV_ARGS(allocator.GetAddressOf())));
+	}
+
+	return allocator;
+}
+
+GpuAllocation D3D12TextureStreamer::CreateTexture(const TextureStreamer::LoadedTexture& texture)
+{
+	const DirectX::DDSTextureDesc& desc = texture.Desc;
+	const DirectX::DDSSubresource& top = texture.Layout.Subresources[0];
+
+	D3D12_RESOURCE_DESC resourceDesc = {};
+	resourceDesc.Dimension = (D3D12_RESOURCE_DIMENSION)desc.Dimension;
+	resourceDesc.Alignment = 0;
+	resourceDesc.Width = top.Width;
+	resourceDesc.Height = top.Height;
+	resourceDesc.DepthOrArraySize = (UINT16)((desc.Dimension == DDS_DIMENSION_TEXTURE3D) ? top.Depth : desc.ArraySize);
+	resourceDesc.MipLevels = (UINT16)texture.Layout.MipCount;
+	resourceDesc.Format = desc.Format;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.SampleDesc.Quality = 0;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	GpuAllocation allocation;
+	HRESULT hr;
+	if(mHeapAllocator != nullptr)
+	{
+		hr = mHeapAllocator->CreateResource(resourceDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, allocation);
+	}
+	else
+	{
+		ComPtr<ID3D12Resource> resource;
+		hr = md3dDevice->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(resource.GetAddressOf()));
+		if(SUCCEEDED(hr))
+			allocation = GpuAllocation(std::move(resource));
+	}
+
+	return allocation;
+}
+
+void D3D12TextureStreamer::CreatePlaceholder()
+{
+	// Opaque mid grey, so a texture that is still loading reads as neutral.
+	const UINT32 texel = 0xff808080;
+
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, 1),
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(mPlaceholder.GetAddressOf())));
+
+	D3D12_SUBRESOURCE_DATA data = {};
+	data.pData = &texel;
+	data.RowPitch = sizeof(texel);
+	data.SlicePitch = sizeof(texel);
+
+	ComPtr<ID3D12CommandAllocator> allocator = AcquireAllocator();
+	ThrowIfFailed(mCopyList->Reset(allocator.Get(), nullptr));
+	mBatcher->Begin(mCopyList.Get());
+	mBatcher->UploadTexture(mPlaceholder.Get(), 0, 1, &data,
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_DEST);
+	ThrowIfFailed(mCopyList->Close());
+
+	ID3D12CommandList* cmdLists[] = { mCopyList.Get() };
+	mCopyQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+
+	// Resolve hands the placeholder out from the start, so it must be ready first.
+	mFence->WaitFor(mBatcher->End());
+	mFreeAllocators.push_back(allocator);
+}
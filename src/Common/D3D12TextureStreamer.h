@@ -0,0 +1,120 @@
+//***************************************************************************************
+// D3D12TextureStreamer.h
+//
+// Upload stage of the TextureStreamer.  Update, called once per frame on the render
+// thread, takes the textures the workers have finished, creates their resources and
+// records all of their copies into one command list on a dedicated copy queue.  When
+// that batch's fence completes the textures are marked resident and Resolve starts
+// returning them; until then it returns a 1x1 placeholder.
+//
+// Textures are created in the COMMON state.  The copy queue promotes them to COPY_DEST
+// implicitly and they decay back to COMMON once the batch completes, so the graphics
+// queue can promote them to a shader resource state on first use without a barrier.
+// Resolve only returns a texture after the CPU has seen its batch fence, so the
+// graphics queue never needs to wait on the copy queue.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "D3D12Fence.h"
+#include "GpuHeapAllocator.h"
+#include "TextureStreamer.h"
+#include "UploadBatcher.h"
+#include <deque>
+#include <unordered_set>
+
+class D3D12TextureStreamer
+{
+public:
+	struct Stats
+	{
+		UINT64 Batches = 0;
+		UINT64 TexturesUploaded = 0;
+		UINT64 BytesUploaded = 0;
+		UINT64 CreateFailures = 0; // Loaded textures the device would not create.
+	};
+
+	// streamer and heapAllocator must outlive this object.  maxBatchBytes bounds the
+	// texture data submitted per Update so one frame does not fill the staging ring on
+	// its own.
+	D3D12TextureStreamer(ID3D12Device* device, TextureStreamer& streamer,
+		GpuHeapAllocator* heapAllocator = nullptr,
+		UINT64 stagingCapacity = 64 * 1024 * 1024,
+		UINT64 maxBatchBytes = 16 * 1024 * 1024);
+	D3D12TextureStreamer(const D3D12TextureStreamer& rhs) = delete;
+	D3D12TextureStreamer& operator=(const D3D12TextureStreamer& rhs) = delete;
+	// The graphics queue must be idle.
+	~D3D12TextureStreamer();
+
+	// Retires completed batches and submits the textures loaded since the last call.
+	void Update();
+
+	// The texture once resident, otherwise the placeholder.
+	ID3D12Resource* Resolve(TextureStreamer::Handle handle)const;
+	bool IsResident(TextureStreamer::Handle handle)const;
+
+	// Drops a texture and releases its streamer handle.  Frames in flight may still
+	// sample it, so the resource is kept until FreeReleased sees fenceValue complete on
+	// the graphics queue.  A texture still being uploaded is dropped as soon as it
+	// arrives.
+	void Release(TextureStreamer::Handle handle, UINT64 fenceValue);
+
+	// Frees released textures whose fence value has completed.
+	void FreeReleased(UINT64 completedFenceValue);
+
+	ID3D12Resource* Placeholder()const;
+	ID3D12CommandQueue* CopyQueue()const;
+	const Stats& GetStats()const;
+
+private:
+	struct Batch
+	{
+		UINT64 Fence = 0;
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> Allocator;
+		std::vector<TextureStreamer::Handle> Handles;
+		std::vector<GpuAllocation> Textures;
+	};
+
+	void Retire();
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> AcquireAllocator();
+	GpuAllocation CreateTexture(const TextureStreamer::LoadedTexture& texture);
+	void CreatePlaceholder();
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Device> md3dDevice;
+	TextureStreamer& mStreamer;
+	GpuHeapAllocator* mHeapAllocator = nullptr;
+	UINT64 mMaxBatchBytes = 0;
+
+	Microsoft::WRL::ComPtr<ID3D12CommandQueue> mCopyQueue;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mCopyList;
+	std::unique_ptr<D3D12Fence> mFence;
+	std::unique_ptr<UploadBatcher> mBatcher;
+
+	std::deque<Batch> mInFlight;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> mFreeAllocators;
+
+	struct ResidentTexture
+	{
+		TextureStreamer::Handle Handle = TextureStreamer::InvalidHandle;
+		GpuAllocation Texture;
+	};
+
+	// Indexed by TextureStreamer::SlotIndex; Handle tells which use of the slot the
+	// texture belongs to.  Null until the texture is resident.
+	std::vector<ResidentTexture> mResident;
+	Microsoft::WRL::ComPtr<ID3D12Resource> mPlaceholder;
+
+	struct ReleasedTexture
+	{
+		UINT64 Fence = 0;
+		GpuAllocation Texture;
+	};
+
+	std::deque<ReleasedTexture> mReleased;
+	std::unordered_set<TextureStreamer::Handle> mReleasedEarly;
+
+	std::vector<TextureStreamer::LoadedTexture> mTaken;
+	Stats mStats;
+};
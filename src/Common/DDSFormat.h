@@ -0,0 +1,208 @@
+//***************************************************************************************
+// DDSFormat.h
+//
+// DDS file structures and the format helpers shared by the texture loaders and tools.
+// Nothing here touches Direct3D, so DDS parsing also builds and runs on Linux, where
+// dxgiformat.h comes from the DirectX-Headers package.
+//
+// The structures and BitsPerPixel, GetSurfaceInfo, GetDXGIFormat, MakeSRGB and
+// GetAlphaMode were split out of DDSTextureLoader.cpp (Copyright (c) Microsoft
+// Corporation) so that code other than the loaders can use them.
+//
+// ValidateDDSHeader, GetDDSTextureDesc and GetDDSLayout describe a file from its headers
+// alone: what texture it holds and where each subresource lives in the bit data.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <dxgiformat.h>
+
+//--------------------------------------------------------------------------------------
+// Macros
+//--------------------------------------------------------------------------------------
+#ifndef MAKEFOURCC
+    #define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
+                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
+                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
+#endif /* defined(MAKEFOURCC) */
+
+//--------------------------------------------------------------------------------------
+// DDS file structure definitions
+//
+// See DDS.h in the 'Texconv' sample and the 'DirectXTex' library
+//--------------------------------------------------------------------------------------
+#pragma pack(push,1)
+
+const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+struct DDS_PIXELFORMAT
+{
+    uint32_t    size;
+    uint32_t    flags;
+    uint32_t    fourCC;
+    uint32_t    RGBBitCount;
+    uint32_t    RBitMask;
+    uint32_t    GBitMask;
+    uint32_t    BBitMask;
+    uint32_t    ABitMask;
+};
+
+#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
+#define DDS_RGB         0x00000040  // DDPF_RGB
+#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
+#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
+
+#define DDS_HEADER_FLAGS_VOLUME         0x00800000  // DDSD_DEPTH
+
+#define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
+#define DDS_WIDTH  0x00000004 // DDSD_WIDTH
+
+#define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
+#define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
+#define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
+#define DDS_CUBEMAP_NEGATIVEY 0x00002200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
+#define DDS_CUBEMAP_POSITIVEZ 0x00004200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
+#define DDS_CUBEMAP_NEGATIVEZ 0x00008200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
+
+#define DDS_CUBEMAP_ALLFACES ( DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |\
+                               DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |\
+                               DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ )
+
+#define DDS_CUBEMAP 0x00000200 // DDSCAPS2_CUBEMAP
+
+enum DDS_MISC_FLAGS2
+{
+    DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7L,
+};
+
+struct DDS_HEADER
+{
+    uint32_t        size;
+    uint32_t        flags;
+    uint32_t        height;
+    uint32_t        width;
+    uint32_t        pitchOrLinearSize;
+    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+    uint32_t        mipMapCount;
+    uint32_t        reserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t        caps;
+    uint32_t        caps2;
+    uint32_t        caps3;
+    uint32_t        caps4;
+    uint32_t        reserved2;
+};
+
+enum DDS_RESOURCE_DIMENSION
+{
+    DDS_DIMENSION_TEXTURE1D = 2,
+    DDS_DIMENSION_TEXTURE2D = 3,
+    DDS_DIMENSION_TEXTURE3D = 4,
+};
+
+#define DDS_RESOURCE_MISC_TEXTURECUBE 0x4 // D3D11_RESOURCE_MISC_TEXTURECUBE
+
+struct DDS_HEADER_DXT10
+{
+    DXGI_FORMAT     dxgiFormat;
+    uint32_t        resourceDimension;
+    uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
+    uint32_t        arraySize;
+    uint32_t        miscFlags2;
+};
+
+#pragma pack(pop)
+
+namespace DirectX
+{
+    enum DDS_ALPHA_MODE
+    {
+        DDS_ALPHA_MODE_UNKNOWN       = 0,
+        DDS_ALPHA_MODE_STRAIGHT      = 1,
+        DDS_ALPHA_MODE_PREMULTIPLIED = 2,
+        DDS_ALPHA_MODE_OPAQUE        = 3,
+        DDS_ALPHA_MODE_CUSTOM        = 4,
+    };
+
+	enum class DDSStatus
+	{
+		Ok,
+		InvalidData,  // Header fields contradict each other.
+		NotSupported  // A format, dimension or size Direct3D 12 cannot create.
+	};
+
+	// Texture described by a DDS header.  Dimension is a DDS_RESOURCE_DIMENSION value,
+	// which matches D3D12_RESOURCE_DIMENSION.
+	struct DDSTextureDesc
+	{
+		std::uint32_t Dimension = 0;
+		std::uint32_t Width = 0;
+		std::uint32_t Height = 0;
+		std::uint32_t Depth = 0;
+		std::uint32_t MipCount = 0;
+		std::uint32_t ArraySize = 0; // Six per cube for cube maps.
+		DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+		bool IsCubeMap = false;
+		DDS_ALPHA_MODE AlphaMode = DDS_ALPHA_MODE_UNKNOWN;
+	};
+
+	struct DDSSubresource
+	{
+		std::uint32_t Width = 0;
+		std::uint32_t Height = 0;
+		std::uint32_t Depth = 0;
+		std::size_t RowPitch = 0;
+		std::size_t SlicePitch = 0; // Bytes per depth slice.
+		std::size_t NumRows = 0;
+		std::uint64_t Offset = 0;   // From the start of the bit data.
+		std::uint64_t Size = 0;     // SlicePitch * Depth.
+	};
+
+	struct DDSLayout
+	{
+		// Kept subresources in Direct3D subresource order: mips of array slice 0, then
+		// slice 1, and so on.
+		std::vector<DDSSubresource> Subresources;
+		std::uint32_t SkipMip = 0;  // Leading mips dropped by maxsize.
+		std::uint32_t MipCount = 0; // Mips kept per array slice.
+		std::uint64_t KeptBytes = 0;
+		std::uint64_t TotalBytes = 0; // Bit data size the header implies.
+	};
+
+	std::size_t BitsPerPixel(DXGI_FORMAT fmt);
+
+	void GetSurfaceInfo(std::size_t width,
+		std::size_t height,
+		DXGI_FORMAT fmt,
+		std::size_t* outNumBytes,
+		std::size_t* outRowBytes,
+		std::size_t* outNumRows);
+
+	DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf);
+
+	DXGI_FORMAT MakeSRGB(DXGI_FORMAT format);
+
+	// header must be followed by its DDS_HEADER_DXT10 when it has one.
+	DDS_ALPHA_MODE GetAlphaMode(const DDS_HEADER* header);
+
+	// Checks the magic number and headers at the start of ddsData, which may hold just
+	// the headers.  On success header points into ddsData and headerSize is the offset
+	// of the bit data.
+	bool ValidateDDSHeader(const std::uint8_t* ddsData,
+		std::size_t ddsDataSize,
+		const DDS_HEADER** header,
+		std::size_t* headerSize);
+
+	// Describes the texture of a header accepted by ValidateDDSHeader, applying the
+	// Direct3D 12 size limits.
+	DDSStatus GetDDSTextureDesc(const DDS_HEADER* header, DDSTextureDesc& desc);
+
+	// Locates the subresources in the bit data.  A nonzero maxsize drops the leading mips
+	// with a dimension above maxsize, the way the loaders' maxsize argument does.
+	// Returns false if that leaves nothing to load.  Callers must check TotalBytes
+	// against the bit data they actually have.
+	bool GetDDSLayout(const DDSTextureDesc& desc, std::size_t maxsize, DDSLayout& layout);
+}
@@ -0,0 +1,244 @@
+//***************************************************************************************
+// DDSInfo.cpp
+//***************************************************************************************
+
+#include "DDSInfo.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cctype>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+	const std::size_t MaxHeaderSize = sizeof(std::uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+
+	// Files per job: a header read is short, so one file alone does not cover the cost
+	// of scheduling it.
+	const std::uint32_t FilesPerJob = 16;
+
+	// Reads up to size bytes from the start of fileName.  Returns the OS error code, or
+	// 0 on success.
+	int ReadFileHead(const std::string& fileName, std::uint8_t* dest, std::size_t size,
+		std::size_t* bytesRead, std::uint64_t* fileSize);
+
+	void ListDirectory(const std::string& directory, bool recursive, std::vector<std::string>& files);
+
+	std::string JoinPath(const std::string& directory, const std::string& name)
+	{
+		if(directory.empty())
+			return name;
+
+		char last = directory.back();
+		if(last == '/' || last == '\\')
+			return directory + name;
+
+		return directory + '/' + name;
+	}
+
+	bool HasDDSExtension(const std::string& name)
+	{
+		if(name.size() < 4)
+			return false;
+
+		const char* ext = name.c_str() + name.size() - 4;
+		return ext[0] == '.' &&
+			std::tolower((unsigned char)ext[1]) == 'd' &&
+			std::tolower((unsigned char)ext[2]) == 'd' &&
+			std::tolower((unsigned char)ext[3]) == 's';
+	}
+
+#ifdef _WIN32
+
+	int ReadFileHead(const std::string& fileName, std::uint8_t* dest, std::size_t size,
+		std::size_t* bytesRead, std::uint64_t* fileSize)
+	{
+		HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if(file == INVALID_HANDLE_VALUE)
+			return (int)GetLastError();
+
+		int error = 0;
+		LARGE_INTEGER length = {};
+		DWORD read = 0;
+		if(!GetFileSizeEx(file, &length) || !ReadFile(file, dest, (DWORD)size, &read, nullptr))
+			error = (int)GetLastError();
+
+		CloseHandle(file);
+
+		*bytesRead = read;
+		*fileSize = (std::uint64_t)length.QuadPart;
+		return error;
+	}
+
+	void ListDirectory(const std::string& directory, bool recursive, std::vector<std::string>& files)
+	{
+		WIN32_FIND_DATAA found;
+		HANDLE find = FindFirstFileA(JoinPath(directory, "*").c_str(), &found);
+		if(find == INVALID_HANDLE_VALUE)
+			return;
+
+		do
+		{
+			std::string name = found.cFileName;
+			if(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			{
+				if(recursive && name != "." && name != "..")
+					ListDirectory(JoinPath(directory, name), recursive, files);
+			}
+			else if(HasDDSExtension(name))
+			{
+				files.push_back(JoinPath(directory, name));
+			}
+		} while(FindNextFileA(find, &found));
+
+		FindClose(find);
+	}
+
+#else
+
+	int ReadFileHead(const std::string& fileName, std::uint8_t* dest, std::size_t size,
+		std::size_t* bytesRead, std::uint64_t* fileSize)
+	{
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if(fd < 0)
+			return errno;
+
+		int error = 0;
+		struct stat st;
+		ssize_t read = 0;
+		if(fstat(fd, &st) != 0 || (read = pread(fd, dest, size, 0)) < 0)
+			error = errno;
+
+		close(fd);
+
+		*bytesRead = (read > 0) ? (std::size_t)read : 0;
+		*fileSize = (error == 0) ? (std::uint64_t)st.st_size : 0;
+		return error;
+	}
+
+	void ListDirectory(const std::string& directory, bool recursive, std::vector<std::string>& files)
+	{
+		DIR* dir = opendir(directory.empty() ? "." : directory.c_str());
+		if(dir == nullptr)
+			return;
+
+		while(dirent* found = readdir(dir))
+		{
+			std::string name = found->d_name;
+			if(name == "." || name == "..")
+				continue;
+
+			std::string path = JoinPath(directory, name);
+
+			struct stat st;
+			if(stat(path.c_str(), &st) != 0)
+				continue;
+
+			if(S_ISDIR(st.st_mode))
+			{
+				if(recursive)
+					ListDirectory(path, recursive, files);
+			}
+			else if(S_ISREG(st.st_mode) && HasDDSExtension(name))
+			{
+				files.push_back(std::move(path));
+			}
+		}
+
+		closedir(dir);
+	}
+
+#endif
+}
+
+bool DirectX::ReadDDSFileInfo(const std::string& fileName, DDSFileInfo& info)
+{
+	info = DDSFileInfo();
+	info.FileName = fileName;
+
+	std::uint8_t head[MaxHeaderSize];
+	std::size_t headSize = 0;
+	int error = ReadFileHead(fileName, head, sizeof(head), &headSize, &info.FileSize);
+	if(error != 0)
+	{
+		info.Error = "cannot read " + fileName + " (error " + std::to_string(error) + ")";
+		return false;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	std::size_t headerSize = 0;
+	if(!ValidateDDSHeader(head, headSize, &header, &headerSize))
+	{
+		info.Error = fileName + " is not a DDS file";
+		return false;
+	}
+	info.HeaderSize = headerSize;
+
+	switch(GetDDSTextureDesc(header, info.Desc))
+	{
+	case DDSStatus::Ok:
+		break;
+	case DDSStatus::InvalidData:
+		info.Error = fileName + " has an invalid DDS header";
+		return false;
+	default:
+		info.Error = fileName + " has an unsupported format or size";
+		return false;
+	}
+
+	DDSLayout layout;
+	if(!GetDDSLayout(info.Desc, 0, layout))
+	{
+		info.Error = fileName + " has an invalid DDS header";
+		return false;
+	}
+	info.TotalBytes = layout.TotalBytes;
+
+	if(info.TotalBytes > info.FileSize - headerSize)
+	{
+		info.Error = fileName + " is truncated";
+		return false;
+	}
+
+	info.Valid = true;
+	return true;
+}
+
+std::vector<DDSFileInfo> DirectX::ReadDDSFileInfos(const std::vector<std::string>& fileNames, JobSystem& jobs)
+{
+	std::vector<DDSFileInfo> infos(fileNames.size());
+
+	std::uint32_t count = (std::uint32_t)fileNames.size();
+	jobs.ParallelFor((count + FilesPerJob - 1) / FilesPerJob, [&](std::uint32_t job)
+	{
+		std::uint32_t end = std::min(count, (job + 1) * FilesPerJob);
+		for(std::uint32_t i = job * FilesPerJob; i < end; ++i)
+			ReadDDSFileInfo(fileNames[i], infos[i]);
+	});
+
+	return infos;
+}
+
+std::vector<std::string> DirectX::ListDDSFiles(const std::string& directory, bool recursive)
+{
+	std::vector<std::string> files;
+	ListDirectory(directory, recursive, files);
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+std::vector<DDSFileInfo> DirectX::ScanDDSDirectory(const std::string& directory, JobSystem& jobs, bool recursive)
+{
+	return ReadDDSFileInfos(ListDDSFiles(directory, recursive), jobs);
+}
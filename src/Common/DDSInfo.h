@@ -0,0 +1,47 @@
+//***************************************************************************************
+// DDSInfo.h
+//
+// Texture metadata straight from DDS headers.  ReadDDSFileInfo reads the magic number,
+// DDS_HEADER and DX10 extension (at most 148 bytes) and the file size; no pixel data is
+// read and nothing is mapped or uploaded.  The description and footprint are the ones
+// the loaders would derive, so tools and budget code can plan with them.
+//
+// ReadDDSFileInfos runs over a list of files on a JobSystem, and ScanDDSDirectory does
+// the same for the .dds files in a directory.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSFormat.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+namespace DirectX
+{
+	struct DDSFileInfo
+	{
+		std::string FileName;
+		bool Valid = false;
+		std::string Error;          // Why Valid is false.
+		DDSTextureDesc Desc;
+		std::uint64_t FileSize = 0;
+		std::uint64_t HeaderSize = 0; // Offset of the bit data.
+		std::uint64_t TotalBytes = 0; // Bytes of all subresources, as GetDDSLayout computes them.
+	};
+
+	// Fills info from the headers of fileName.  A file whose size is below HeaderSize +
+	// TotalBytes is reported as truncated, as the loaders would reject it.
+	bool ReadDDSFileInfo(const std::string& fileName, DDSFileInfo& info);
+
+	// One entry per file name, in the same order.  The reads are spread over jobs.
+	std::vector<DDSFileInfo> ReadDDSFileInfos(const std::vector<std::string>& fileNames, JobSystem& jobs);
+
+	// Paths of the files in directory whose extension is .dds in any case, sorted.
+	std::vector<std::string> ListDDSFiles(const std::string& directory, bool recursive = false);
+
+	std::vector<DDSFileInfo> ScanDDSDirectory(const std::string& directory, JobSystem& jobs,
+		bool recursive = false);
+}
@@ -0,0 +1,141 @@
+//***************************************************************************************
+// DDSWriter.cpp
+//***************************************************************************************
+
+#include "DDSWriter.h"
+#include <cstring>
+#include <fstream>
+
+using namespace DirectX;
+
+namespace
+{
+	const std::uint32_t DDS_HEADER_FLAGS_TEXTURE = 0x00001007; // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+	const std::uint32_t DDS_HEADER_FLAGS_MIPMAP = 0x00020000;  // DDSD_MIPMAPCOUNT
+	const std::uint32_t DDS_HEADER_FLAGS_PITCH = 0x00000008;   // DDSD_PITCH
+	const std::uint32_t DDS_HEADER_FLAGS_LINEARSIZE = 0x00080000; // DDSD_LINEARSIZE
+
+	const std::uint32_t DDS_SURFACE_FLAGS_TEXTURE = 0x00001000; // DDSCAPS_TEXTURE
+	const std::uint32_t DDS_SURFACE_FLAGS_MIPMAP = 0x00400008;  // DDSCAPS_COMPLEX | DDSCAPS_MIPMAP
+	const std::uint32_t DDS_SURFACE_FLAGS_CUBEMAP = 0x00000008; // DDSCAPS_COMPLEX
+
+	const std::uint32_t DDS_FLAGS_VOLUME = 0x00200000; // DDSCAPS2_VOLUME
+
+	// FourCC of the formats written with a legacy header, or 0.
+	std::uint32_t LegacyFourCC(DXGI_FORMAT format)
+	{
+		switch(format)
+		{
+		case DXGI_FORMAT_BC1_UNORM: return MAKEFOURCC('D', 'X', 'T', '1');
+		case DXGI_FORMAT_BC3_UNORM: return MAKEFOURCC('D', 'X', 'T', '5');
+		case DXGI_FORMAT_BC5_UNORM: return MAKEFOURCC('A', 'T', 'I', '2');
+		default:                    return 0;
+		}
+	}
+
+	bool IsCompressed(DXGI_FORMAT format)
+	{
+		switch(format)
+		{
+		case DXGI_FORMAT_BC1_TYPELESS: case DXGI_FORMAT_BC1_UNORM: case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC2_TYPELESS: case DXGI_FORMAT_BC2_UNORM: case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_TYPELESS: case DXGI_FORMAT_BC3_UNORM: case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC4_TYPELESS: case DXGI_FORMAT_BC4_UNORM: case DXGI_FORMAT_BC4_SNORM:
+		case DXGI_FORMAT_BC5_TYPELESS: case DXGI_FORMAT_BC5_UNORM: case DXGI_FORMAT_BC5_SNORM:
+		case DXGI_FORMAT_BC6H_TYPELESS: case DXGI_FORMAT_BC6H_UF16: case DXGI_FORMAT_BC6H_SF16:
+		case DXGI_FORMAT_BC7_TYPELESS: case DXGI_FORMAT_BC7_UNORM: case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return true;
+		default:
+			return false;
+		}
+	}
+}
+
+bool WriteDDSFile(const std::string& fileName, const DDSTextureDesc& desc,
+	const std::uint8_t* bits, std::size_t size, std::string& error)
+{
+	DDSLayout layout;
+	if(!GetDDSLayout(desc, 0, layout) || layout.TotalBytes != size)
+	{
+		error = "the bit data does not match the texture description for " + fileName;
+		return false;
+	}
+
+	std::uint32_t slices = desc.IsCubeMap ? desc.ArraySize / 6 : desc.ArraySize;
+	std::uint32_t fourCC = LegacyFourCC(desc.Format);
+	bool legacy = fourCC != 0 && desc.Dimension == DDS_DIMENSION_TEXTURE2D && slices == 1 &&
+		(desc.AlphaMode == DDS_ALPHA_MODE_UNKNOWN || desc.AlphaMode == DDS_ALPHA_MODE_STRAIGHT);
+
+	DDS_HEADER header;
+	std::memset(&header, 0, sizeof(header));
+	header.size = sizeof(DDS_HEADER);
+	header.flags = DDS_HEADER_FLAGS_TEXTURE;
+	header.width = desc.Width;
+	header.height = desc.Height;
+	header.mipMapCount = desc.MipCount;
+	header.caps = DDS_SURFACE_FLAGS_TEXTURE;
+
+	if(desc.MipCount > 1)
+	{
+		header.flags |= DDS_HEADER_FLAGS_MIPMAP;
+		header.caps |= DDS_SURFACE_FLAGS_MIPMAP;
+	}
+
+	const DDSSubresource& top = layout.Subresources[0];
+	if(IsCompressed(desc.Format))
+	{
+		header.flags |= DDS_HEADER_FLAGS_LINEARSIZE;
+		header.pitchOrLinearSize = (std::uint32_t)top.SlicePitch;
+	}
+	else
+	{
+		header.flags |= DDS_HEADER_FLAGS_PITCH;
+		header.pitchOrLinearSize = (std::uint32_t)top.RowPitch;
+	}
+
+	if(desc.Dimension == DDS_DIMENSION_TEXTURE3D)
+	{
+		header.flags |= DDS_HEADER_FLAGS_VOLUME;
+		header.depth = desc.Depth;
+		header.caps2 = DDS_FLAGS_VOLUME;
+	}
+	else if(desc.IsCubeMap)
+	{
+		header.caps |= DDS_SURFACE_FLAGS_CUBEMAP;
+		header.caps2 = DDS_CUBEMAP_ALLFACES;
+	}
+
+	header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+	header.ddspf.flags = DDS_FOURCC;
+	header.ddspf.fourCC = legacy ? fourCC : MAKEFOURCC('D', 'X', '1', '0');
+
+	DDS_HEADER_DXT10 ext;
+	std::memset(&ext, 0, sizeof(ext));
+	ext.dxgiFormat = desc.Format;
+	ext.resourceDimension = desc.Dimension;
+	ext.miscFlag = desc.IsCubeMap ? DDS_RESOURCE_MISC_TEXTURECUBE : 0;
+	ext.arraySize = slices;
+	ext.miscFlags2 = desc.AlphaMode;
+
+	std::ofstream fout(fileName, std::ios::binary | std::ios::trunc);
+	if(!fout)
+	{
+		error = "cannot create " + fileName;
+		return false;
+	}
+
+	fout.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if(!legacy)
+		fout.write(reinterpret_cast<const char*>(&ext), sizeof(ext));
+	fout.write(reinterpret_cast<const char*>(bits), (std::streamsize)size);
+
+	fout.flush();
+	if(!fout)
+	{
+		error = "cannot write " + fileName;
+		return false;
+	}
+
+	return true;
+}
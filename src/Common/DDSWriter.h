@@ -0,0 +1,18 @@
+//***************************************************************************************
+// DDSWriter.h
+//
+// Writes textures as DDS files the DDS loaders read back.  BC1, BC3 and BC5 UNORM
+// textures with one 2D slice get the legacy DXT1/DXT5/ATI2 FourCC header that older
+// tools also understand; everything else gets the DX10 extension header.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSFormat.h"
+#include <cstdint>
+#include <string>
+
+// bits holds every subresource of desc in the order and with the pitches GetDDSLayout
+// describes for maxsize 0, size bytes in all.
+bool WriteDDSFile(const std::string& fileName, const DirectX::DDSTextureDesc& desc,
+	const std::uint8_t* bits, std::size_t size, std::string& error);
@@ -0,0 +1,99 @@
+//***************************************************************************************
+// DescriptorFreeList.cpp
+//***************************************************************************************
+
+#include "DescriptorFreeList.h"
+#include <cassert>
+#include <iterator>
+
+DescriptorFreeList::DescriptorFreeList(std::uint32_t first, std::uint32_t count)
+	: mFirst(first), mCapacity(count), mFreeCount(count)
+{
+	if(count > 0)
+		mFreeRanges[first] = count;
+}
+
+std::uint32_t DescriptorFreeList::Allocate(std::uint32_t count)
+{
+	if(count == 0)
+		return InvalidIndex;
+
+	for(auto it = mFreeRanges.begin(); it != mFreeRanges.end(); ++it)
+	{
+		if(it->second < count)
+			continue;
+
+		std::uint32_t index = it->first;
+		std::uint32_t remaining = it->second - count;
+		mFreeRanges.erase(it);
+		if(remaining > 0)
+			mFreeRanges[index + count] = remaining;
+
+		mFreeCount -= count;
+		return index;
+	}
+
+	return InvalidIndex;
+}
+
+void DescriptorFreeList::Free(std::uint32_t index, std::uint32_t count)
+{
+	assert(index >= mFirst && index + count <= mFirst + mCapacity);
+
+	mFreeCount += count;
+
+	auto next = mFreeRanges.lower_bound(index);
+	assert(next == mFreeRanges.end() || index + count <= next->first);
+
+	// Merge with the following range.
+	if(next != mFreeRanges.end() && next->first == index + count)
+	{
+		count += next->second;
+		next = mFreeRanges.erase(next);
+	}
+
+	// Merge with the preceding range.
+	if(next != mFreeRanges.begin())
+	{
+		auto prev = std::prev(next);
+		assert(prev->first + prev->second <= index);
+		if(prev->first + prev->second == index)
+		{
+			prev->second += count;
+			return;
+		}
+	}
+
+	mFreeRanges[index] = count;
+}
+
+std::uint32_t DescriptorFreeList::First()const
+{
+	return mFirst;
+}
+
+std::uint32_t DescriptorFreeList::Capacity()const
+{
+	return mCapacity;
+}
+
+std::uint32_t DescriptorFreeList::FreeCount()const
+{
+	return mFreeCount;
+}
+
+std::uint32_t DescriptorFreeList::LargestFreeRange()const
+{
+	std::uint32_t largest = 0;
+	for(const auto& r : mFreeRanges)
+	{
+		if(r.second > largest)
+			largest = r.second;
+	}
+	return largest;
+}
+
+std::uint32_t DescriptorFreeList::FreeRangeCount()const
+{
+	return (std::uint32_t)mFreeRanges.size();
+}
@@ -0,0 +1,41 @@
+//***************************************************************************************
+// DescriptorFreeList.h
+//
+// First-fit free list of index ranges, used for long-lived descriptors.  Allocations
+// are contiguous so a range can back a descriptor table; freed ranges are merged with
+// free neighbors.  Indices only, so it can be exercised without a device.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+class DescriptorFreeList
+{
+public:
+	static const std::uint32_t InvalidIndex = 0xffffffff;
+
+	// Manages indices [first, first + count).
+	DescriptorFreeList(std::uint32_t first = 0, std::uint32_t count = 0);
+
+	// Returns the first index of 'count' contiguous free indices, or InvalidIndex.
+	std::uint32_t Allocate(std::uint32_t count = 1);
+
+	// index and count must describe a range returned by Allocate.
+	void Free(std::uint32_t index, std::uint32_t count = 1);
+
+	std::uint32_t First()const;
+	std::uint32_t Capacity()const;
+	std::uint32_t FreeCount()const;
+	std::uint32_t LargestFreeRange()const;
+	std::uint32_t FreeRangeCount()const;
+
+private:
+	std::uint32_t mFirst;
+	std::uint32_t mCapacity;
+	std::uint32_t mFreeCount;
+
+	// Free ranges keyed by start index.
+	std::map<std::uint32_t, std::uint32_t> mFreeRanges;
+};
@@ -0,0 +1,214 @@
+//***************************************************************************************
+// DescriptorHeapManager.cpp
+//***************************************************************************************
+
+#include "DescriptorHeapManager.h"
+
+DescriptorHeapManager::DescriptorHeapManager(ID3D12Device* device, UINT persistentCount, UINT transientCount,
+	UINT stagingCount)
+	: md3dDevice(device),
+	mPersistentCount(persistentCount),
+	mTransientCount(transientCount),
+	mPersistent(0, persistentCount),
+	mStaging(0, stagingCount),
+	mTransient(transientCount)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	heapDesc.NumDescriptors = persistentCount + transientCount;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	heapDesc.NodeMask = 0;
+	ThrowIfFailed(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(mShaderVisibleHeap.GetAddressOf())));
+
+	if(stagingCount > 0)
+	{
+		heapDesc.NumDescriptors = stagingCount;
+		heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+		ThrowIfFailed(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(mStagingHeap.GetAddressOf())));
+	}
+
+	mDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+DescriptorHeapManager::Range DescriptorHeapManager::AllocatePersistent(UINT count)
+{
+	UINT index = mPersistent.Allocate(count);
+	if(index == DescriptorFreeList::InvalidIndex)
+		return Range();
+
+	mStats.PersistentUsed += count;
+	return MakeRange(index, count);
+}
+
+void DescriptorHeapManager::FreePersistent(const Range& range)
+{
+	if(!range.IsValid())
+		return;
+
+	mPersistent.Free(range.Index, range.Count);
+	mStats.PersistentUsed -= range.Count;
+}
+
+DescriptorHeapManager::Range DescriptorHeapManager::AllocateStaging(UINT count)
+{
+	UINT index = mStaging.Allocate(count);
+	if(index == DescriptorFreeList::InvalidIndex)
+		return Range();
+
+	mStats.StagingUsed += count;
+	return MakeStagingRange(index, count);
+}
+
+void DescriptorHeapManager::FreeStaging(const Range& range)
+{
+	if(!range.IsValid())
+		return;
+
+	mStaging.Free(range.Index, range.Count);
+	mStats.StagingUsed -= range.Count;
+}
+
+DescriptorHeapManager::Range DescriptorHeapManager::AllocateTransient(UINT count)
+{
+	std::size_t offset = mTransient.Allocate(count, 1);
+	if(offset == RingAllocator::InvalidOffset)
+	{
+		++mStats.TransientOverflows;
+		return Range();
+	}
+
+	mStats.TransientUsed = (UINT)mTransient.Used();
+	if(mStats.TransientUsed > mStats.PeakTransientUsed)
+		mStats.PeakTransientUsed = mStats.TransientUsed;
+
+	return MakeRange(mPersistentCount + (UINT)offset, count);
+}
+
+void DescriptorHeapManager::QueueCopy(D3D12_CPU_DESCRIPTOR_HANDLE src, const Range& dest, UINT destOffset, UINT count)
+{
+	assert(dest.IsValid() && destOffset + count <= dest.Count);
+
+	mCopyDestStarts.push_back(CD3DX12_CPU_DESCRIPTOR_HANDLE(dest.Cpu, destOffset, mDescriptorSize));
+	mCopyDestSizes.push_back(count);
+	mCopySrcStarts.push_back(src);
+	mCopySrcSizes.push_back(count);
+}
+
+DescriptorHeapManager::Range DescriptorHeapManager::StageTable(const D3D12_CPU_DESCRIPTOR_HANDLE* srcs, UINT count)
+{
+	Range table = AllocateTransient(count);
+	if(!table.IsValid())
+		return table;
+
+	// The destination is contiguous, so it is a single range; each source is its own.
+	mCopyDestStarts.push_back(table.Cpu);
+	mCopyDestSizes.push_back(count);
+	for(UINT i = 0; i < count; ++i)
+	{
+		mCopySrcStarts.push_back(srcs[i]);
+		mCopySrcSizes.push_back(1);
+	}
+
+	return table;
+}
+
+void DescriptorHeapManager::FlushCopies()
+{
+	if(mCopySrcStarts.empty())
+		return;
+
+	md3dDevice->CopyDescriptors(
+		(UINT)mCopyDestStarts.size(), mCopyDestStarts.data(), mCopyDestSizes.data(),
+		(UINT)mCopySrcStarts.size(), mCopySrcStarts.data(), mCopySrcSizes.data(),
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	for(UINT size : mCopySrcSizes)
+		mStats.DescriptorsCopied += size;
+	++mStats.CopyBatches;
+
+	mCopyDestStarts.clear();
+	mCopyDestSizes.clear();
+	mCopySrcStarts.clear();
+	mCopySrcSizes.clear();
+}
+
+void DescriptorHeapManager::BeginFrame(UINT64 completedValue)
+{
+	mTransient.Retire(completedValue);
+	mStats.TransientUsed = (UINT)mTransient.Used();
+}
+
+void DescriptorHeapManager::Bind(ID3D12GraphicsCommandList* cmdList)
+{
+	ID3D12DescriptorHeap* heaps[] = { mShaderVisibleHeap.Get() };
+	cmdList->SetDescriptorHeaps(_countof(heaps), heaps);
+	mHeapBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool DescriptorHeapManager::UsesDescriptorTables(const D3D12_ROOT_SIGNATURE_DESC& desc)
+{
+	for(UINT i = 0; i < desc.NumParameters; ++i)
+	{
+		if(desc.pParameters[i].ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
+			return true;
+	}
+	return false;
+}
+
+void DescriptorHeapManager::EndFrame(UINT64 fenceValue)
+{
+	assert(mCopySrcStarts.empty() && "DescriptorHeapManager: FlushCopies must run before the frame is submitted");
+
+	mTransient.Submit(fenceValue);
+}
+
+ID3D12DescriptorHeap* DescriptorHeapManager::ShaderVisibleHeap()const
+{
+	return mShaderVisibleHeap.Get();
+}
+
+ID3D12DescriptorHeap* DescriptorHeapManager::StagingHeap()const
+{
+	return mStagingHeap.Get();
+}
+
+UINT DescriptorHeapManager::DescriptorSize()const
+{
+	return mDescriptorSize;
+}
+
+UINT DescriptorHeapManager::PersistentCapacity()const
+{
+	return mPersistentCount;
+}
+
+UINT DescriptorHeapManager::TransientCapacity()const
+{
+	return mTransientCount;
+}
+
+DescriptorHeapManager::Stats DescriptorHeapManager::GetStats()const
+{
+	Stats s = mStats;
+	s.HeapBinds = mHeapBinds.load(std::memory_order_relaxed);
+	return s;
+}
+
+DescriptorHeapManager::Range DescriptorHeapManager::MakeRange(UINT index, UINT count)const
+{
+	Range r;
+	r.Index = index;
+	r.Count = count;
+	r.Cpu = CD3DX12_CPU_DESCRIPTOR_HANDLE(mShaderVisibleHeap->GetCPUDescriptorHandleForHeapStart(), index, mDescriptorSize);
+	r.Gpu = CD3DX12_GPU_DESCRIPTOR_HANDLE(mShaderVisibleHeap->GetGPUDescriptorHandleForHeapStart(), index, mDescriptorSize);
+	return r;
+}
+
+DescriptorHeapManager::Range DescriptorHeapManager::MakeStagingRange(UINT index, UINT count)const
+{
+	Range r;
+	r.Index = index;
+	r.Count = count;
+	r.Cpu = CD3DX12_CPU_DESCRIPTOR_HANDLE(mStagingHeap->GetCPUDescriptorHandleForHeapStart(), index, mDescriptorSize);
+	return r;
+}
@@ -0,0 +1,137 @@
+//***************************************************************************************
+// DescriptorHeapManager.h
+//
+// Owns the application's single shader-visible CBV/SRV/UAV heap, so command lists bind
+// descriptor heaps once per frame instead of per draw.  The heap is split in two:
+//
+//   [0, persistentCount)                  Free-list region for long-lived descriptors
+//                                         such as texture SRVs.
+//   [persistentCount, + transientCount)   Ring region for descriptors written each
+//                                         frame.  EndFrame tags the frame's block with
+//                                         a fence value; BeginFrame reclaims blocks
+//                                         whose fence has completed.
+//
+// A separate CPU-only staging heap holds descriptors that are created once and copied
+// into the shader-visible heap as needed.  Copies are queued and issued together by
+// FlushCopies with a single CopyDescriptors call; this must happen before the command
+// list that reads the destination descriptors is executed.
+//
+// The index bookkeeping lives in DescriptorFreeList and RingAllocator, which do not
+// need a device.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "DescriptorFreeList.h"
+#include "RingAllocator.h"
+#include <atomic>
+
+class DescriptorHeapManager
+{
+public:
+	static const UINT InvalidIndex = DescriptorFreeList::InvalidIndex;
+
+	// A contiguous run of descriptors.  Gpu is null for staging ranges.
+	struct Range
+	{
+		UINT Index = InvalidIndex;
+		UINT Count = 0;
+		CD3DX12_CPU_DESCRIPTOR_HANDLE Cpu{ D3D12_DEFAULT };
+		CD3DX12_GPU_DESCRIPTOR_HANDLE Gpu{ D3D12_DEFAULT };
+
+		bool IsValid()const { return Index != InvalidIndex; }
+	};
+
+	struct Stats
+	{
+		UINT PersistentUsed = 0;
+		UINT StagingUsed = 0;
+		UINT TransientUsed = 0;      // Includes blocks of frames still in flight.
+		UINT PeakTransientUsed = 0;
+		UINT TransientOverflows = 0; // AllocateTransient calls that failed.
+		UINT64 DescriptorsCopied = 0;
+		UINT64 CopyBatches = 0;      // CopyDescriptors calls.
+		UINT64 HeapBinds = 0;        // SetDescriptorHeaps calls made by Bind.
+	};
+
+	DescriptorHeapManager(ID3D12Device* device, UINT persistentCount = 4096, UINT transientCount = 16384,
+		UINT stagingCount = 4096);
+	DescriptorHeapManager(const DescriptorHeapManager& rhs) = delete;
+	DescriptorHeapManager& operator=(const DescriptorHeapManager& rhs) = delete;
+	~DescriptorHeapManager() = default;
+
+	// Shader-visible descriptors that stay valid until freed.  Free only after the
+	// GPU has finished with every command list that references them.
+	Range AllocatePersistent(UINT count = 1);
+	void FreePersistent(const Range& range);
+
+	// CPU-only descriptors to create views in and copy from.
+	Range AllocateStaging(UINT count = 1);
+	void FreeStaging(const Range& range);
+
+	// Shader-visible descriptors valid for the current frame only.  Returns an
+	// invalid range when the ring is full.
+	Range AllocateTransient(UINT count);
+
+	// Queues a copy of count descriptors starting at src into dest, starting at
+	// destOffset.  src is normally in the staging heap.
+	void QueueCopy(D3D12_CPU_DESCRIPTOR_HANDLE src, const Range& dest, UINT destOffset = 0, UINT count = 1);
+
+	// Gathers count descriptors, which need not be contiguous, into a transient
+	// table and returns it.  The copies are queued like QueueCopy.
+	Range StageTable(const D3D12_CPU_DESCRIPTOR_HANDLE* srcs, UINT count);
+
+	// Issues all queued copies.
+	void FlushCopies();
+
+	// Call once the fence of the frame that last used this frame's slot has been
+	// waited on.  Reclaims transient blocks of frames with fence <= completedValue.
+	void BeginFrame(UINT64 completedValue);
+
+	// Binds the shader-visible heap.  Once per command list is enough, and only
+	// needed when the root signature has descriptor tables.  May be called from the
+	// threads recording command lists.
+	void Bind(ID3D12GraphicsCommandList* cmdList);
+
+	// True if a root signature reads descriptors through tables, which needs the heap
+	// bound.  Root descriptors and static samplers do not.
+	static bool UsesDescriptorTables(const D3D12_ROOT_SIGNATURE_DESC& desc);
+
+	// Call after the frame's command lists are submitted, with the fence value
+	// signaled behind them.
+	void EndFrame(UINT64 fenceValue);
+
+	ID3D12DescriptorHeap* ShaderVisibleHeap()const;
+	ID3D12DescriptorHeap* StagingHeap()const;
+	UINT DescriptorSize()const;
+	UINT PersistentCapacity()const;
+	UINT TransientCapacity()const;
+	Stats GetStats()const;
+
+private:
+	Range MakeRange(UINT index, UINT count)const;
+	Range MakeStagingRange(UINT index, UINT count)const;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Device> md3dDevice;
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mShaderVisibleHeap;
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mStagingHeap;
+	UINT mDescriptorSize = 0;
+
+	UINT mPersistentCount = 0;
+	UINT mTransientCount = 0;
+
+	DescriptorFreeList mPersistent;
+	DescriptorFreeList mStaging;
+	RingAllocator mTransient;
+
+	// Pending copies, in the layout CopyDescriptors takes.
+	std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mCopyDestStarts;
+	std::vector<UINT> mCopyDestSizes;
+	std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mCopySrcStarts;
+	std::vector<UINT> mCopySrcSizes;
+
+	Stats mStats;
+	std::atomic<UINT64> mHeapBinds{ 0 };
+};
@@ -0,0 +1,141 @@
+//***************************************************************************************
+// DrawQueue.cpp
+//***************************************************************************************
+
+#include "DrawQueue.h"
+#include <cassert>
+
+std::uint64_t SortKey::Make(std::uint32_t pass, std::uint32_t pipeline, std::uint32_t material,
+	std::uint32_t depth, std::uint32_t user)
+{
+	assert(pass < 16 && pipeline < 4096 && material < 65536 && depth <= MaxDepth && user < 256);
+
+	return ((std::uint64_t)pass << 60) |
+		((std::uint64_t)pipeline << 48) |
+		((std::uint64_t)material << 32) |
+		((std::uint64_t)depth << 8) |
+		(std::uint64_t)user;
+}
+
+std::uint32_t SortKey::QuantizeDepth(float viewDepth, float nearZ, float farZ, bool backToFront)
+{
+	float t = (farZ > nearZ) ? (viewDepth - nearZ) / (farZ - nearZ) : 0.0f;
+	if(t < 0.0f)
+		t = 0.0f;
+	if(t > 1.0f)
+		t = 1.0f;
+
+	std::uint32_t depth = (std::uint32_t)(t*MaxDepth + 0.5f);
+	return backToFront ? MaxDepth - depth : depth;
+}
+
+std::uint32_t SortKey::GetPass(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> 60);
+}
+
+std::uint32_t SortKey::GetPipeline(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> 48) & 0xfff;
+}
+
+std::uint32_t SortKey::GetMaterial(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> 32) & 0xffff;
+}
+
+std::uint32_t SortKey::GetDepth(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> 8) & MaxDepth;
+}
+
+void DrawQueue::Reserve(std::size_t count)
+{
+	mPackets.reserve(count);
+	mOrder.reserve(count);
+	mScratch.reserve(count);
+}
+
+void DrawQueue::Clear()
+{
+	mPackets.clear();
+	mOrder.clear();
+}
+
+void DrawQueue::Push(const DrawPacket& packet)
+{
+	Entry e;
+	e.Key = packet.Key;
+	e.Index = (std::uint32_t)mPackets.size();
+
+	mPackets.push_back(packet);
+	mOrder.push_back(e);
+}
+
+void DrawQueue::Append(const DrawQueue& other)
+{
+	mPackets.reserve(mPackets.size() + other.mPackets.size());
+	mOrder.reserve(mOrder.size() + other.mOrder.size());
+
+	for(const Entry& o : other.mOrder)
+		Push(other.mPackets[o.Index]);
+}
+
+void DrawQueue::Sort()
+{
+	mLastSkippedPasses = 0;
+
+	const std::size_t n = mOrder.size();
+	if(n < 2)
+		return;
+
+	mScratch.resize(n);
+
+	// One pass per key byte, least significant first.  A byte that is the same for
+	// every key would not move anything, so its pass is skipped.
+	for(int shift = 0; shift < 64; shift += 8)
+	{
+		std::size_t counts[256] = {};
+		for(const Entry& e : mOrder)
+			++counts[(e.Key >> shift) & 0xff];
+
+		if(counts[(mOrder[0].Key >> shift) & 0xff] == n)
+		{
+			++mLastSkippedPasses;
+			continue;
+		}
+
+		std::size_t offset = 0;
+		for(std::size_t& c : counts)
+		{
+			std::size_t count = c;
+			c = offset;
+			offset += count;
+		}
+
+		for(const Entry& e : mOrder)
+			mScratch[counts[(e.Key >> shift) & 0xff]++] = e;
+
+		mOrder.swap(mScratch);
+	}
+}
+
+std::size_t DrawQueue::Size()const
+{
+	return mOrder.size();
+}
+
+bool DrawQueue::Empty()const
+{
+	return mOrder.empty();
+}
+
+const DrawPacket& DrawQueue::operator[](std::size_t i)const
+{
+	return mPackets[mOrder[i].Index];
+}
+
+int DrawQueue::LastSkippedPasses()const
+{
+	return mLastSkippedPasses;
+}
@@ -0,0 +1,98 @@
+//***************************************************************************************
+// DrawQueue.h
+//
+// Deferred draw submission.  Callers push DrawPackets in any order; Sort orders them by
+// their 64-bit key with an LSD radix sort so the renderer walks them grouped by pass,
+// then pipeline state, then material, then depth, which keeps state changes between
+// consecutive draws to a minimum.
+//
+// A DrawQueue is not thread-safe.  Worker threads each fill their own queue and the
+// results are combined with Append before sorting; since the sort is stable, packets
+// with equal keys stay in append order.
+//
+// Key layout, most significant bits first:
+//
+//   63..60  pass        (16)
+//   59..48  pipeline    (4096)
+//   47..32  material    (65536)
+//   31..8   depth       (24-bit quantized)
+//    7..0   user        (tie breaker)
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+struct SortKey
+{
+	enum Pass
+	{
+		PassOpaque = 0,
+		PassTransparent = 1,
+		PassOverlay = 2
+	};
+
+	static const std::uint32_t MaxDepth = (1u << 24) - 1;
+
+	static std::uint64_t Make(std::uint32_t pass, std::uint32_t pipeline, std::uint32_t material,
+		std::uint32_t depth, std::uint32_t user = 0);
+
+	// Maps a view depth in [nearZ, farZ] to the 24-bit depth field.  Opaque geometry
+	// sorts front to back; pass backToFront for blended geometry.
+	static std::uint32_t QuantizeDepth(float viewDepth, float nearZ, float farZ, bool backToFront = false);
+
+	static std::uint32_t GetPass(std::uint64_t key);
+	static std::uint32_t GetPipeline(std::uint64_t key);
+	static std::uint32_t GetMaterial(std::uint64_t key);
+	static std::uint32_t GetDepth(std::uint64_t key);
+};
+
+struct DrawPacket
+{
+	std::uint64_t Key = 0;
+	std::uint32_t Geometry = 0; // Renderer-defined mesh id.
+	DirectX::XMFLOAT4X4 WorldViewProj;
+	DirectX::XMFLOAT4 Color;
+
+	// Instanced packets take their transforms and colors from InstanceCount entries
+	// at GPU address InstanceBuffer instead of WorldViewProj and Color.
+	std::uint32_t InstanceCount = 1;
+	std::uint64_t InstanceBuffer = 0;
+};
+
+class DrawQueue
+{
+public:
+	void Reserve(std::size_t count);
+	void Clear();
+
+	void Push(const DrawPacket& packet);
+	void Append(const DrawQueue& other);
+
+	// Orders the packets by key.  Packets pushed after Sort are not ordered until
+	// the next Sort.
+	void Sort();
+
+	std::size_t Size()const;
+	bool Empty()const;
+
+	// i-th packet in key order (after Sort) or push order (before).
+	const DrawPacket& operator[](std::size_t i)const;
+
+	// Radix passes skipped by the last Sort because every key had the same byte.
+	int LastSkippedPasses()const;
+
+private:
+	struct Entry
+	{
+		std::uint64_t Key;
+		std::uint32_t Index;
+	};
+
+	std::vector<DrawPacket> mPackets;
+	std::vector<Entry> mOrder;
+	std::vector<Entry> mScratch;
+	int mLastSkippedPasses = 0;
+};
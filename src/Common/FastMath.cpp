@@ -0,0 +1,271 @@
+//***************************************************************************************
+// FastMath.cpp
+//***************************************************************************************
+
+#include "FastMath.h"
+#include <cmath>
+
+using namespace DirectX;
+
+FastMath::Mode FastMath::sMode = FastMath::Mode::Fast;
+
+namespace
+{
+	// sin(y) and cos(y) for y in [-pi/2, pi/2]: 11-degree and 10-degree minimax
+	// polynomials in y^2 (the sine result is multiplied by y afterwards).
+	const float gSinCoeffs[] = { -2.3889859e-08f, 2.7525562e-06f, -0.00019840874f, 0.0083333310f, -0.16666667f, 1.0f };
+	const float gCosCoeffs[] = { -2.6051615e-07f, 2.4760495e-05f, -0.0013888378f, 0.041666638f, -0.5f, 1.0f };
+
+	// atan(t)/t for t in [0, 1] as a polynomial in t^2.  Abramowitz & Stegun 4.4.49.
+	const float gAtanCoeffs[] = { 0.0028662257f, -0.0161657367f, 0.0429096138f, -0.0752896400f,
+		0.1065626393f, -0.1420889944f, 0.1999355085f, -0.3333314528f, 1.0f };
+
+	// acos(x)/sqrt(1-x) for x in [0, 1].  Abramowitz & Stegun 4.4.46.
+	const float gAcosCoeffs[] = { -0.0012624911f, 0.0066700901f, -0.0170881256f, 0.0308918810f,
+		-0.0501743046f, 0.0889789874f, -0.2145988016f, 1.5707963050f };
+
+	// Horner evaluation, highest order coefficient first.
+	template<int N>
+	inline float Poly(float x, const float (&coeffs)[N])
+	{
+		float r = coeffs[0];
+		for(int i = 1; i < N; ++i)
+			r = r*x + coeffs[i];
+		return r;
+	}
+
+	template<int N>
+	inline XMVECTOR XM_CALLCONV Poly(FXMVECTOR x, const float (&coeffs)[N])
+	{
+		XMVECTOR r = XMVectorReplicate(coeffs[0]);
+		for(int i = 1; i < N; ++i)
+			r = XMVectorMultiplyAdd(r, x, XMVectorReplicate(coeffs[i]));
+		return r;
+	}
+
+	// Loads up to four floats, padding the remaining lanes with 'pad'.
+	inline XMVECTOR XM_CALLCONV LoadPartial(const float* src, std::size_t count, float pad)
+	{
+		XMFLOAT4 v(pad, pad, pad, pad);
+		float* dst = &v.x;
+		for(std::size_t i = 0; i < count; ++i)
+			dst[i] = src[i];
+		return XMLoadFloat4(&v);
+	}
+
+	inline void XM_CALLCONV StorePartial(float* dst, std::size_t count, FXMVECTOR v)
+	{
+		XMFLOAT4 tmp;
+		XMStoreFloat4(&tmp, v);
+		const float* src = &tmp.x;
+		for(std::size_t i = 0; i < count; ++i)
+			dst[i] = src[i];
+	}
+}
+
+void FastMath::SetMode(Mode mode)
+{
+	sMode = mode;
+}
+
+FastMath::Mode FastMath::GetMode()
+{
+	return sMode;
+}
+
+void FastMath::SinCos(float x, float* sinOut, float* cosOut)
+{
+	if(sMode == Mode::Precise)
+	{
+		*sinOut = sinf(x);
+		*cosOut = cosf(x);
+		return;
+	}
+
+	// Map x to y in [-pi, pi] with x = 2*pi*quotient + y.
+	float quotient = XM_1DIV2PI*x;
+	quotient = floorf(quotient + 0.5f);
+	float y = x - XM_2PI*quotient;
+
+	// Map y to [-pi/2, pi/2] with sin(y) = sin(x).
+	float sign = 1.0f;
+	if(y > XM_PIDIV2)
+	{
+		y = XM_PI - y;
+		sign = -1.0f;
+	}
+	else if(y < -XM_PIDIV2)
+	{
+		y = -XM_PI - y;
+		sign = -1.0f;
+	}
+
+	float y2 = y*y;
+	*sinOut = Poly(y2, gSinCoeffs)*y;
+	*cosOut = Poly(y2, gCosCoeffs)*sign;
+}
+
+float FastMath::Atan2(float y, float x)
+{
+	if(sMode == Mode::Precise)
+		return atan2f(y, x);
+
+	float ax = fabsf(x);
+	float ay = fabsf(y);
+	float mx = ax > ay ? ax : ay;
+	float mn = ax > ay ? ay : ax;
+	if(mx == 0.0f)
+		return 0.0f;
+
+	float t = mn / mx;
+	float r = Poly(t*t, gAtanCoeffs)*t;
+	if(ay > ax)
+		r = XM_PIDIV2 - r;
+	if(x < 0.0f)
+		r = XM_PI - r;
+
+	return (y < 0.0f) ? -r : r;
+}
+
+float FastMath::Acos(float x)
+{
+	if(sMode == Mode::Precise)
+		return acosf(x);
+
+	float ax = fabsf(x);
+	float omx = 1.0f - ax;
+	if(omx < 0.0f)
+		omx = 0.0f;
+
+	float r = Poly(ax < 1.0f ? ax : 1.0f, gAcosCoeffs)*sqrtf(omx);
+
+	// acos(x) = pi - acos(-x) when x < 0.
+	return (x >= 0.0f) ? r : XM_PI - r;
+}
+
+void XM_CALLCONV FastMath::SinCosEst(FXMVECTOR x, XMVECTOR* sinOut, XMVECTOR* cosOut)
+{
+	// Map x to y in [-pi, pi] with x = 2*pi*quotient + y.
+	XMVECTOR quotient = XMVectorRound(XMVectorMultiply(x, XMVectorReplicate(XM_1DIV2PI)));
+	XMVECTOR y = XMVectorNegativeMultiplySubtract(XMVectorReplicate(XM_2PI), quotient, x);
+
+	// Map y to [-pi/2, pi/2] with sin(y) = sin(x).
+	XMVECTOR sign = XMVectorAndInt(y, XMVectorReplicate(-0.0f));
+	XMVECTOR c = XMVectorOrInt(XMVectorReplicate(XM_PI), sign);
+	XMVECTOR inRange = XMVectorLessOrEqual(XMVectorAbs(y), XMVectorReplicate(XM_PIDIV2));
+	y = XMVectorSelect(XMVectorSubtract(c, y), y, inRange);
+	XMVECTOR cosSign = XMVectorSelect(XMVectorReplicate(-1.0f), XMVectorReplicate(1.0f), inRange);
+
+	XMVECTOR y2 = XMVectorMultiply(y, y);
+	*sinOut = XMVectorMultiply(Poly(y2, gSinCoeffs), y);
+	*cosOut = XMVectorMultiply(Poly(y2, gCosCoeffs), cosSign);
+}
+
+XMVECTOR XM_CALLCONV FastMath::Atan2Est(FXMVECTOR y, FXMVECTOR x)
+{
+	XMVECTOR zero = XMVectorZero();
+	XMVECTOR ax = XMVectorAbs(x);
+	XMVECTOR ay = XMVectorAbs(y);
+	XMVECTOR mx = XMVectorMax(ax, ay);
+	XMVECTOR mn = XMVectorMin(ax, ay);
+
+	// t = min/max is in [0, 1].  Lanes with x = y = 0 would divide 0 by 0.
+	XMVECTOR t = XMVectorDivide(mn, mx);
+	t = XMVectorSelect(t, zero, XMVectorEqual(mx, zero));
+
+	XMVECTOR r = XMVectorMultiply(Poly(XMVectorMultiply(t, t), gAtanCoeffs), t);
+	r = XMVectorSelect(r, XMVectorSubtract(XMVectorReplicate(XM_PIDIV2), r), XMVectorGreater(ay, ax));
+	r = XMVectorSelect(r, XMVectorSubtract(XMVectorReplicate(XM_PI), r), XMVectorLess(x, zero));
+
+	// r is nonnegative here, so copying the sign of y is a single OR.
+	return XMVectorOrInt(r, XMVectorAndInt(y, XMVectorReplicate(-0.0f)));
+}
+
+XMVECTOR XM_CALLCONV FastMath::AcosEst(FXMVECTOR x)
+{
+	XMVECTOR one = XMVectorReplicate(1.0f);
+	XMVECTOR xc = XMVectorClamp(x, XMVectorNegate(one), one);
+	XMVECTOR ax = XMVectorAbs(xc);
+	XMVECTOR root = XMVectorSqrt(XMVectorMax(XMVectorSubtract(one, ax), XMVectorZero()));
+
+	XMVECTOR r = XMVectorMultiply(Poly(ax, gAcosCoeffs), root);
+
+	// acos(x) = pi - acos(-x) when x < 0.
+	XMVECTOR nonnegative = XMVectorGreaterOrEqual(xc, XMVectorZero());
+	return XMVectorSelect(XMVectorSubtract(XMVectorReplicate(XM_PI), r), r, nonnegative);
+}
+
+void FastMath::SinCosArray(const float* x, float* sinOut, float* cosOut, std::size_t count)
+{
+	if(sMode == Mode::Precise)
+	{
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			float v = x[i];
+			sinOut[i] = sinf(v);
+			cosOut[i] = cosf(v);
+		}
+		return;
+	}
+
+	std::size_t i = 0;
+	XMVECTOR s, c;
+	for(; i + 4 <= count; i += 4)
+	{
+		SinCosEst(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + i)), &s, &c);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(sinOut + i), s);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(cosOut + i), c);
+	}
+
+	if(i < count)
+	{
+		SinCosEst(LoadPartial(x + i, count - i, 0.0f), &s, &c);
+		StorePartial(sinOut + i, count - i, s);
+		StorePartial(cosOut + i, count - i, c);
+	}
+}
+
+void FastMath::Atan2Array(const float* y, const float* x, float* out, std::size_t count)
+{
+	if(sMode == Mode::Precise)
+	{
+		for(std::size_t i = 0; i < count; ++i)
+			out[i] = atan2f(y[i], x[i]);
+		return;
+	}
+
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		XMVECTOR r = Atan2Est(
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(y + i)),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + i)));
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(out + i), r);
+	}
+
+	if(i < count)
+	{
+		XMVECTOR r = Atan2Est(LoadPartial(y + i, count - i, 0.0f), LoadPartial(x + i, count - i, 1.0f));
+		StorePartial(out + i, count - i, r);
+	}
+}
+
+void FastMath::AcosArray(const float* x, float* out, std::size_t count)
+{
+	if(sMode == Mode::Precise)
+	{
+		for(std::size_t i = 0; i < count; ++i)
+			out[i] = acosf(x[i]);
+		return;
+	}
+
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		XMVECTOR r = AcosEst(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + i)));
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(out + i), r);
+	}
+
+	if(i < count)
+		StorePartial(out + i, count - i, AcosEst(LoadPartial(x + i, count - i, 0.0f)));
+}
@@ -0,0 +1,52 @@
+//***************************************************************************************
+// FastMath.h
+//
+// Polynomial approximations of the transcendental functions used by the procedural
+// geometry and animation code.  Every function has a scalar form and an array form;
+// the array forms evaluate four floats at a time with DirectXMath vector operations.
+//
+// Maximum absolute error, measured against double precision libm:
+//   SinCos : 2.2e-7 for |x| <= pi and 3.9e-7 for |x| <= 10.  The range reduction
+//            loses accuracy in proportion to |x| beyond that.
+//   Atan2  : 3.0e-7 radians for all finite (y, x).  Atan2(0, 0) returns 0.
+//   Acos   : 4.4e-7 radians for x in [-1, 1].  Inputs outside are clamped.
+//
+// The scalar and array functions honor a global mode.  In Mode::Precise they forward
+// to the C runtime, which is useful when comparing generated meshes against the
+// reference implementation.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+
+class FastMath
+{
+public:
+	enum class Mode
+	{
+		Precise, // C runtime sinf/cosf/atan2f/acosf.
+		Fast     // Polynomial approximations documented above.
+	};
+
+	static void SetMode(Mode mode);
+	static Mode GetMode();
+
+	static void SinCos(float x, float* sinOut, float* cosOut);
+	static float Atan2(float y, float x);
+	static float Acos(float x);
+
+	// Array forms.  Input and output arrays may alias.
+	static void SinCosArray(const float* x, float* sinOut, float* cosOut, std::size_t count);
+	static void Atan2Array(const float* y, const float* x, float* out, std::size_t count);
+	static void AcosArray(const float* x, float* out, std::size_t count);
+
+	// Vector kernels used by the array forms.  These ignore the mode.
+	static void XM_CALLCONV SinCosEst(DirectX::FXMVECTOR x, DirectX::XMVECTOR* sinOut, DirectX::XMVECTOR* cosOut);
+	static DirectX::XMVECTOR XM_CALLCONV Atan2Est(DirectX::FXMVECTOR y, DirectX::FXMVECTOR x);
+	static DirectX::XMVECTOR XM_CALLCONV AcosEst(DirectX::FXMVECTOR x);
+
+private:
+	static Mode sMode;
+};
@@ -0,0 +1,58 @@
+//***************************************************************************************
+// Fence.cpp
+//***************************************************************************************
+
+#include "Fence.h"
+#include "GameTimer.h"
+
+bool IFence::IsComplete(std::uint64_t value)const
+{
+	return CompletedValue() >= value;
+}
+
+std::uint64_t IFence::LastSignaled()const
+{
+	return mLastSignaled;
+}
+
+bool IFence::WaitFor(std::uint64_t value, std::uint32_t timeoutMs)
+{
+	++mStats.WaitCount;
+	if(IsComplete(value))
+	{
+		mStats.LastWaitNs = 0;
+		return true;
+	}
+
+	std::int64_t start = GameTimer::Now();
+	bool completed = BlockUntil(value, timeoutMs);
+	std::int64_t elapsed = GameTimer::Now() - start;
+
+	++mStats.BlockedCount;
+	if(!completed)
+		++mStats.TimeoutCount;
+	mStats.TotalWaitNs += elapsed;
+	mStats.LastWaitNs = elapsed;
+	if(elapsed > mStats.MaxWaitNs)
+		mStats.MaxWaitNs = elapsed;
+	mFrameWaitNs += elapsed;
+
+	return completed;
+}
+
+void IFence::Flush()
+{
+	WaitFor(Signal());
+}
+
+const FenceWaitStats& IFence::WaitStats()const
+{
+	return mStats;
+}
+
+std::int64_t IFence::TakeFrameWaitTime()
+{
+	std::int64_t ns = mFrameWaitNs;
+	mFrameWaitNs = 0;
+	return ns;
+}
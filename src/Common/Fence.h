@@ -0,0 +1,70 @@
+//***************************************************************************************
+// Fence.h
+//
+// Abstract fence shared by the GPU queue (D3D12Fence) and the in-process stand-in used
+// without a device (CpuFence).  Signal enqueues a new value behind all work submitted
+// so far; the value completes once that work has finished.
+//
+// WaitFor measures how long the caller was blocked.  The totals are kept in
+// FenceWaitStats, and TakeFrameWaitTime returns the time blocked since it was last
+// called so the frame loop can attribute waits to individual frames.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+
+struct FenceWaitStats
+{
+	std::uint64_t WaitCount = 0;    // WaitFor calls.
+	std::uint64_t BlockedCount = 0; // WaitFor calls that had to block.
+	std::uint64_t TimeoutCount = 0; // WaitFor calls that timed out.
+	std::int64_t TotalWaitNs = 0;
+	std::int64_t MaxWaitNs = 0;
+	std::int64_t LastWaitNs = 0;
+};
+
+class IFence
+{
+public:
+	static const std::uint32_t Infinite = 0xffffffff;
+
+	IFence() = default;
+	IFence(const IFence& rhs) = delete;
+	IFence& operator=(const IFence& rhs) = delete;
+	virtual ~IFence() = default;
+
+	// Enqueues a signal of the next fence value and returns that value.
+	virtual std::uint64_t Signal() = 0;
+
+	virtual std::uint64_t CompletedValue()const = 0;
+
+	bool IsComplete(std::uint64_t value)const;
+
+	// Most recent value returned by Signal.
+	std::uint64_t LastSignaled()const;
+
+	// Blocks until 'value' has completed or timeoutMs milliseconds have passed.
+	// Returns true if the value completed.
+	bool WaitFor(std::uint64_t value, std::uint32_t timeoutMs = Infinite);
+
+	// Signals a new value and waits for it, i.e. waits for all submitted work.
+	void Flush();
+
+	const FenceWaitStats& WaitStats()const;
+
+	// Nanoseconds spent blocked in WaitFor since the previous call.
+	std::int64_t TakeFrameWaitTime();
+
+protected:
+	// Blocks until 'value' completes or the timeout expires.  Called only when the
+	// value has not completed yet.  Returns true if the value completed.
+	virtual bool BlockUntil(std::uint64_t value, std::uint32_t timeoutMs) = 0;
+
+protected:
+	std::uint64_t mLastSignaled = 0;
+
+private:
+	FenceWaitStats mStats;
+	std::int64_t mFrameWaitNs = 0;
+};
@@ -0,0 +1,85 @@
+//***************************************************************************************
+// FixedStepScheduler.cpp
+//***************************************************************************************
+
+#include "FixedStepScheduler.h"
+#include <cassert>
+
+FixedStepScheduler::FixedStepScheduler(double stepSeconds, int maxStepsPerFrame)
+{
+	SetStep(stepSeconds);
+	SetMaxStepsPerFrame(maxStepsPerFrame);
+}
+
+void FixedStepScheduler::SetStep(double stepSeconds)
+{
+	assert(stepSeconds > 0.0);
+	mStep = (std::int64_t)(stepSeconds*1.0e9 + 0.5);
+	if(mStep < 1)
+		mStep = 1;
+}
+
+void FixedStepScheduler::SetMaxStepsPerFrame(int maxStepsPerFrame)
+{
+	assert(maxStepsPerFrame > 0);
+	mMaxStepsPerFrame = maxStepsPerFrame;
+}
+
+double FixedStepScheduler::StepSeconds()const
+{
+	return mStep*1.0e-9;
+}
+
+std::int64_t FixedStepScheduler::StepNanoseconds()const
+{
+	return mStep;
+}
+
+int FixedStepScheduler::MaxStepsPerFrame()const
+{
+	return mMaxStepsPerFrame;
+}
+
+int FixedStepScheduler::Advance(std::int64_t frameNanoseconds)
+{
+	if(frameNanoseconds > 0)
+		mAccumulator += frameNanoseconds;
+
+	std::int64_t steps = mAccumulator / mStep;
+	if(steps > mMaxStepsPerFrame)
+	{
+		// Keep the fractional part so Alpha stays continuous, drop the whole steps
+		// we cannot afford.
+		std::int64_t excess = (steps - mMaxStepsPerFrame)*mStep;
+		mDropped += excess;
+		mAccumulator -= excess;
+		steps = mMaxStepsPerFrame;
+	}
+
+	mAccumulator -= steps*mStep;
+	mStepCount += steps;
+
+	return (int)steps;
+}
+
+float FixedStepScheduler::Alpha()const
+{
+	return (float)((double)mAccumulator / (double)mStep);
+}
+
+std::uint64_t FixedStepScheduler::StepCount()const
+{
+	return mStepCount;
+}
+
+double FixedStepScheduler::DroppedSeconds()const
+{
+	return mDropped*1.0e-9;
+}
+
+void FixedStepScheduler::Reset()
+{
+	mAccumulator = 0;
+	mStepCount = 0;
+	mDropped = 0;
+}
@@ -0,0 +1,52 @@
+//***************************************************************************************
+// FixedStepScheduler.h
+//
+// Accumulator for running simulation at a fixed rate independent of the render rate.
+// Each frame the measured frame time is added to the accumulator and Advance returns
+// how many whole simulation steps to run.  The remainder is exposed as an interpolation
+// factor for rendering between the previous and current simulation states.
+//
+// If a frame takes so long that more than MaxStepsPerFrame steps are owed, the excess
+// time is dropped instead of carried over.  Otherwise a slow simulation makes every
+// following frame slower still (the "spiral of death").
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+
+class FixedStepScheduler
+{
+public:
+	explicit FixedStepScheduler(double stepSeconds = 1.0/60.0, int maxStepsPerFrame = 8);
+
+	void SetStep(double stepSeconds);
+	void SetMaxStepsPerFrame(int maxStepsPerFrame);
+
+	double StepSeconds()const;
+	std::int64_t StepNanoseconds()const;
+	int MaxStepsPerFrame()const;
+
+	// Adds the elapsed frame time and returns the number of steps to simulate.
+	int Advance(std::int64_t frameNanoseconds);
+
+	// Fraction of a step left in the accumulator, in [0, 1).  Blend factor from the
+	// previous simulation state (0) towards the current one (1).
+	float Alpha()const;
+
+	// Total steps handed out since construction or Reset.
+	std::uint64_t StepCount()const;
+
+	// Total time discarded by the MaxStepsPerFrame clamp, in seconds.
+	double DroppedSeconds()const;
+
+	void Reset();
+
+private:
+	std::int64_t mStep;
+	int mMaxStepsPerFrame;
+
+	std::int64_t mAccumulator = 0;
+	std::uint64_t mStepCount = 0;
+	std::int64_t mDropped = 0;
+};
@@ -0,0 +1,61 @@
+//***************************************************************************************
+// FrameRing.cpp
+//***************************************************************************************
+
+#include "FrameRing.h"
+#include <cassert>
+
+FrameRing::FrameRing(int frameCount)
+{
+	Reset(frameCount);
+}
+
+void FrameRing::Reset(int frameCount)
+{
+	assert(frameCount > 0);
+
+	mFences.assign(frameCount, 0);
+
+	// The first BeginFrame moves to slot 0.
+	mCurrent = frameCount - 1;
+}
+
+int FrameRing::FrameCount()const
+{
+	return (int)mFences.size();
+}
+
+int FrameRing::CurrentIndex()const
+{
+	return mCurrent;
+}
+
+std::uint64_t FrameRing::BeginFrame()
+{
+	mCurrent = (mCurrent + 1) % (int)mFences.size();
+	return mFences[mCurrent];
+}
+
+void FrameRing::EndFrame(std::uint64_t fenceValue)
+{
+	// Fence values only grow; a smaller value means frames were submitted out of order.
+	assert(fenceValue >= mFences[mCurrent]);
+
+	mFences[mCurrent] = fenceValue;
+}
+
+std::uint64_t FrameRing::SlotFence(int index)const
+{
+	return mFences[index];
+}
+
+int FrameRing::FramesInFlight(std::uint64_t completedValue)const
+{
+	int count = 0;
+	for(std::uint64_t fence : mFences)
+	{
+		if(fence > completedValue)
+			++count;
+	}
+	return count;
+}
@@ -0,0 +1,44 @@
+//***************************************************************************************
+// FrameRing.h
+//
+// Bookkeeping for a circular array of frame resources.  The CPU records frame N+1
+// while the GPU is still executing frame N, so each slot remembers the fence value
+// signaled after its commands were submitted.  Before a slot is reused the caller
+// waits until that value has completed.
+//
+// FrameRing only deals in indices and fence values, so it has no D3D12 dependency
+// and can be driven by a CpuFence in place of an ID3D12Fence.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class FrameRing
+{
+public:
+	explicit FrameRing(int frameCount = 3);
+
+	// Discards all fence values and resizes the ring.  Only call once the GPU is idle.
+	void Reset(int frameCount);
+
+	int FrameCount()const;
+	int CurrentIndex()const;
+
+	// Moves to the next slot and returns the fence value that must complete before
+	// that slot's resources may be reused.  0 means the slot was never submitted.
+	std::uint64_t BeginFrame();
+
+	// Records the fence value signaled after the current slot's work was submitted.
+	void EndFrame(std::uint64_t fenceValue);
+
+	std::uint64_t SlotFence(int index)const;
+
+	// Number of slots whose fence has not completed given the fence's completed value.
+	int FramesInFlight(std::uint64_t completedValue)const;
+
+private:
+	std::vector<std::uint64_t> mFences;
+	int mCurrent = 0;
+};
@@ -0,0 +1,290 @@
+//***************************************************************************************
+// FrameStats.cpp
+//***************************************************************************************
+
+#include "FrameStats.h"
+#include "GameTimer.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+	std::size_t RoundUpPow2(std::size_t v)
+	{
+		std::size_t p = 1;
+		while(p < v)
+			p <<= 1;
+		return p;
+	}
+
+	double ToMs(std::int64_t ns)
+	{
+		return ns / 1000000.0;
+	}
+
+	// Nearest-rank percentiles of 'values', which is reordered.
+	FrameStats::Percentiles ComputePercentiles(std::vector<std::int64_t>& values)
+	{
+		FrameStats::Percentiles p;
+		if(values.empty())
+			return p;
+
+		std::sort(values.begin(), values.end());
+
+		double sum = 0.0;
+		for(std::int64_t v : values)
+			sum += (double)v;
+
+		auto rank = [&values](double q)
+		{
+			std::size_t i = (std::size_t)(q*values.size());
+			if(i >= values.size())
+				i = values.size() - 1;
+			return ToMs(values[i]);
+		};
+
+		p.MeanMs = sum / values.size() / 1000000.0;
+		p.P50Ms = rank(0.50);
+		p.P95Ms = rank(0.95);
+		p.P99Ms = rank(0.99);
+		p.MaxMs = ToMs(values.back());
+		return p;
+	}
+
+	void WritePercentilesJson(std::ostream& os, const FrameStats::Percentiles& p)
+	{
+		os << "{ \"mean_ms\": " << p.MeanMs << ", \"p50_ms\": " << p.P50Ms << ", \"p95_ms\": " << p.P95Ms
+			<< ", \"p99_ms\": " << p.P99Ms << ", \"max_ms\": " << p.MaxMs << " }";
+	}
+}
+
+FrameStats::FrameStats(std::size_t capacity, std::size_t maxHistory)
+	: mRing(RoundUpPow2(capacity < 2 ? 2 : capacity)),
+	mMask(mRing.size() - 1),
+	mMaxHistory(maxHistory < 1 ? 1 : maxHistory)
+{
+}
+
+void FrameStats::BeginFrame()
+{
+	std::int64_t now = GameTimer::Now();
+
+	// Each sample reports the time since the previous frame started.
+	std::int64_t interval = (mFrameNumber > 0) ? now - mFrameStart : 0;
+
+	mCurrent = Sample();
+	mCurrent.Frame = mFrameNumber++;
+	mCurrent.IntervalNs = interval;
+	mFrameStart = now;
+}
+
+void FrameStats::BeginPhase(Phase phase)
+{
+	mPhaseStart[phase] = GameTimer::Now();
+}
+
+void FrameStats::EndPhase(Phase phase)
+{
+	mCurrent.PhaseNs[phase] += GameTimer::Now() - mPhaseStart[phase];
+}
+
+void FrameStats::AddFenceWait(std::int64_t ns)
+{
+	mCurrent.FenceWaitNs += ns;
+}
+
+void FrameStats::EndFrame()
+{
+	mCurrent.CpuNs = GameTimer::Now() - mFrameStart;
+
+	// The first frame has no predecessor; its CPU time is the best available interval.
+	if(mCurrent.Frame == 0)
+		mCurrent.IntervalNs = mCurrent.CpuNs;
+
+	std::uint64_t write = mWriteIndex.load(std::memory_order_relaxed);
+	std::uint64_t read = mReadIndex.load(std::memory_order_acquire);
+	if(write - read >= mRing.size())
+	{
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	mRing[write & mMask] = mCurrent;
+	mWriteIndex.store(write + 1, std::memory_order_release);
+}
+
+std::uint64_t FrameStats::DroppedCount()const
+{
+	return mDropped.load(std::memory_order_relaxed);
+}
+
+std::size_t FrameStats::Drain()
+{
+	std::uint64_t read = mReadIndex.load(std::memory_order_relaxed);
+	std::uint64_t write = mWriteIndex.load(std::memory_order_acquire);
+
+	std::size_t count = (std::size_t)(write - read);
+	for(; read != write; ++read)
+	{
+		if(mHistory.size() < mMaxHistory)
+		{
+			mHistory.push_back(mRing[read & mMask]);
+		}
+		else
+		{
+			mHistory[mHistoryStart] = mRing[read & mMask];
+			mHistoryStart = (mHistoryStart + 1) % mMaxHistory;
+		}
+	}
+	mReadIndex.store(read, std::memory_order_release);
+
+	return count;
+}
+
+FrameStats::Summary FrameStats::Summarize(std::size_t lastCount)const
+{
+	Summary s;
+
+	std::size_t n = mHistory.size();
+	if(lastCount != 0 && lastCount < n)
+		n = lastCount;
+	s.Count = n;
+	if(n == 0)
+		return s;
+
+	const std::size_t first = mHistory.size() - n;
+	std::vector<const Sample*> samples(n);
+	for(std::size_t i = 0; i < n; ++i)
+		samples[i] = &HistorySample(first + i);
+
+	std::vector<std::int64_t> values(n);
+
+	for(std::size_t i = 0; i < n; ++i)
+		values[i] = samples[i]->IntervalNs;
+	s.Interval = ComputePercentiles(values);
+
+	for(std::size_t i = 0; i < n; ++i)
+		values[i] = samples[i]->CpuNs;
+	s.Cpu = ComputePercentiles(values);
+
+	for(int p = 0; p < PhaseCount; ++p)
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			values[i] = samples[i]->PhaseNs[p];
+		s.Phases[p] = ComputePercentiles(values);
+	}
+
+	for(std::size_t i = 0; i < n; ++i)
+		values[i] = samples[i]->FenceWaitNs;
+	s.FenceWait = ComputePercentiles(values);
+
+	return s;
+}
+
+std::vector<std::uint64_t> FrameStats::Histogram(double bucketMs, std::size_t bucketCount)const
+{
+	std::vector<std::uint64_t> buckets(bucketCount, 0);
+	if(bucketCount == 0 || bucketMs <= 0.0)
+		return buckets;
+
+	for(const Sample& sample : mHistory)
+	{
+		// Order does not matter here, so the ring is read as stored.
+		double b = ToMs(sample.IntervalNs) / bucketMs;
+		std::size_t i = (b >= (double)(bucketCount - 1)) ? bucketCount - 1 : (std::size_t)b;
+		++buckets[i];
+	}
+
+	return buckets;
+}
+
+std::size_t FrameStats::HistorySize()const
+{
+	return mHistory.size();
+}
+
+const FrameStats::Sample& FrameStats::HistorySample(std::size_t index)const
+{
+	index += mHistoryStart;
+	if(index >= mHistory.size())
+		index -= mHistory.size();
+	return mHistory[index];
+}
+
+bool FrameStats::DumpCsv(const std::string& filename)const
+{
+	std::ofstream fout(filename);
+	if(!fout)
+		return false;
+
+	fout << std::fixed << std::setprecision(4);
+
+	fout << "frame,interval_ms,cpu_ms";
+	for(int p = 0; p < PhaseCount; ++p)
+		fout << "," << PhaseName((Phase)p) << "_ms";
+	fout << ",fence_wait_ms\n";
+
+	for(std::size_t i = 0; i < mHistory.size(); ++i)
+	{
+		const Sample& s = HistorySample(i);
+		fout << s.Frame << "," << ToMs(s.IntervalNs) << "," << ToMs(s.CpuNs);
+		for(int p = 0; p < PhaseCount; ++p)
+			fout << "," << ToMs(s.PhaseNs[p]);
+		fout << "," << ToMs(s.FenceWaitNs) << "\n";
+	}
+
+	return fout.good();
+}
+
+bool FrameStats::DumpJson(const std::string& filename)const
+{
+	std::ofstream fout(filename);
+	if(!fout)
+		return false;
+
+	const double bucketMs = 1.0;
+	const std::size_t bucketCount = 100;
+
+	Summary s = Summarize();
+	std::vector<std::uint64_t> hist = Histogram(bucketMs, bucketCount);
+
+	fout << std::fixed << std::setprecision(4);
+	fout << "{\n";
+	fout << "  \"frames\": " << s.Count << ",\n";
+	fout << "  \"dropped\": " << DroppedCount() << ",\n";
+	fout << "  \"interval\": ";
+	WritePercentilesJson(fout, s.Interval);
+	fout << ",\n  \"cpu\": ";
+	WritePercentilesJson(fout, s.Cpu);
+	fout << ",\n  \"phases\": {\n";
+	for(int p = 0; p < PhaseCount; ++p)
+	{
+		fout << "    \"" << PhaseName((Phase)p) << "\": ";
+		WritePercentilesJson(fout, s.Phases[p]);
+		fout << ((p + 1 < PhaseCount) ? ",\n" : "\n");
+	}
+	fout << "  },\n";
+	fout << "  \"fence_wait\": ";
+	WritePercentilesJson(fout, s.FenceWait);
+	fout << ",\n";
+	fout << "  \"histogram\": { \"bucket_ms\": " << bucketMs << ", \"counts\": [";
+	for(std::size_t i = 0; i < hist.size(); ++i)
+		fout << ((i == 0) ? "" : ", ") << hist[i];
+	fout << "] }\n";
+	fout << "}\n";
+
+	return fout.good();
+}
+
+const char* FrameStats::PhaseName(Phase phase)
+{
+	switch(phase)
+	{
+	case PhaseUpdate:      return "update";
+	case PhaseRecord:      return "record";
+	case PhaseSubmit:      return "submit";
+	case PhasePresentWait: return "present_wait";
+	default:               return "unknown";
+	}
+}
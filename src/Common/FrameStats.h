@@ -0,0 +1,128 @@
+//***************************************************************************************
+// FrameStats.h
+//
+// Per-frame CPU timing collection.  The frame loop records one Sample per frame into a
+// single-producer/single-consumer lock-free ring, so the reporting side may run on
+// another thread.  Drained samples are kept in a history used for percentile
+// summaries, histograms and the CSV/JSON dumps written at exit.  The history is a
+// ring of its own, so a full one costs the same per frame as one still filling up.
+//***************************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class FrameStats
+{
+public:
+	enum Phase
+	{
+		PhaseUpdate = 0,  // Update + FixedUpdate.
+		PhaseRecord,      // Command list recording.
+		PhaseSubmit,      // Close + ExecuteCommandLists.
+		PhasePresentWait, // Present and waiting on the GPU.
+		PhaseCount
+	};
+
+	struct Sample
+	{
+		std::uint64_t Frame = 0;
+		std::int64_t IntervalNs = 0; // BeginFrame to the next BeginFrame.
+		std::int64_t CpuNs = 0;      // BeginFrame to EndFrame.
+		std::int64_t PhaseNs[PhaseCount] = {};
+		std::int64_t FenceWaitNs = 0; // Time blocked on GPU fences, part of the phases.
+	};
+
+	struct Percentiles
+	{
+		double MeanMs = 0.0;
+		double P50Ms = 0.0;
+		double P95Ms = 0.0;
+		double P99Ms = 0.0;
+		double MaxMs = 0.0;
+	};
+
+	struct Summary
+	{
+		std::size_t Count = 0;
+		Percentiles Interval;
+		Percentiles Cpu;
+		Percentiles Phases[PhaseCount];
+		Percentiles FenceWait;
+	};
+
+	// RAII helper that times one phase of the current frame.
+	class ScopedPhase
+	{
+	public:
+		ScopedPhase(FrameStats& stats, Phase phase) : mStats(stats), mPhase(phase) { mStats.BeginPhase(mPhase); }
+		~ScopedPhase() { mStats.EndPhase(mPhase); }
+		ScopedPhase(const ScopedPhase& rhs) = delete;
+		ScopedPhase& operator=(const ScopedPhase& rhs) = delete;
+	private:
+		FrameStats& mStats;
+		Phase mPhase;
+	};
+
+	// capacity is rounded up to a power of two.  maxHistory bounds the memory kept
+	// for the exit dumps; once reached, each new sample replaces the oldest.
+	explicit FrameStats(std::size_t capacity = 1024, std::size_t maxHistory = 1 << 20);
+	FrameStats(const FrameStats& rhs) = delete;
+	FrameStats& operator=(const FrameStats& rhs) = delete;
+
+	//
+	// Producer side (frame loop thread).
+	//
+	void BeginFrame();
+	void BeginPhase(Phase phase);
+	void EndPhase(Phase phase);
+	void AddFenceWait(std::int64_t ns);
+	void EndFrame();
+
+	// Samples lost because the ring was full.
+	std::uint64_t DroppedCount()const;
+
+	//
+	// Consumer side (one thread at a time).
+	//
+
+	// Moves pending samples from the ring into the history.  Returns how many.
+	std::size_t Drain();
+
+	// Summary of the most recent 'lastCount' history samples (0 = all of them).
+	Summary Summarize(std::size_t lastCount = 0)const;
+
+	// Frame interval histogram over the whole history.  Bucket i counts intervals in
+	// [i*bucketMs, (i+1)*bucketMs); the last bucket also holds everything above.
+	std::vector<std::uint64_t> Histogram(double bucketMs, std::size_t bucketCount)const;
+
+	// History samples, oldest first.
+	std::size_t HistorySize()const;
+	const Sample& HistorySample(std::size_t index)const;
+
+	bool DumpCsv(const std::string& filename)const;
+	bool DumpJson(const std::string& filename)const;
+
+	static const char* PhaseName(Phase phase);
+
+private:
+	std::vector<Sample> mRing;
+	std::size_t mMask;
+	std::atomic<std::uint64_t> mWriteIndex{ 0 };
+	std::atomic<std::uint64_t> mReadIndex{ 0 };
+	std::atomic<std::uint64_t> mDropped{ 0 };
+
+	// Producer-only state.
+	Sample mCurrent;
+	std::int64_t mFrameStart = 0;
+	std::int64_t mPhaseStart[PhaseCount] = {};
+	std::uint64_t mFrameNumber = 0;
+
+	// Consumer-only state.
+	std::vector<Sample> mHistory;
+	std::size_t mMaxHistory;
+	std::size_t mHistoryStart = 0; // Index of the oldest sample once mHistory is full.
+};
@@ -2,21 +2,51 @@
 // GameTimer.cpp by Frank Luna (C) 2011 All Rights Reserved.
 //***************************************************************************************
 
-#include <windows.h>
 #include "GameTimer.h"
+#include <chrono>
+
+namespace
+{
+	const double SecondsPerNanosecond = 1.0e-9;
+}
 
 GameTimer::GameTimer()
-: mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0), 
-  mPausedTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
+: mDeltaTime(0), mBaseTime(0), mPausedTime(0), mStopTime(0),
+  mPrevTime(0), mCurrTime(0), mStopped(false)
 {
-	__int64 countsPerSec;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec;
+}
+
+std::int64_t GameTimer::Now()
+{
+	// steady_clock is monotonic and is backed by QueryPerformanceCounter on Windows
+	// and clock_gettime(CLOCK_MONOTONIC) on Linux.
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+float GameTimer::TotalTime()const
+{
+	return (float)TotalTimeSeconds();
+}
+
+float GameTimer::DeltaTime()const
+{
+	return (float)DeltaTimeSeconds();
+}
+
+double GameTimer::TotalTimeSeconds()const
+{
+	return TotalTimeNanoseconds()*SecondsPerNanosecond;
+}
+
+double GameTimer::DeltaTimeSeconds()const
+{
+	return mDeltaTime*SecondsPerNanosecond;
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
 // time when the clock is stopped.
-float GameTimer::TotalTime()const
+std::int64_t GameTimer::TotalTimeNanoseconds()const
 {
 	// If we are stopped, do not count the time that has passed since we stopped.
 	// Moreover, if we previously already had a pause, the distance 
@@ -29,7 +59,7 @@ float GameTimer::TotalTime()const
 
 	if( mStopped )
 	{
-		return (float)(((mStopTime - mPausedTime)-mBaseTime)*mSecondsPerCount);
+		return (mStopTime - mPausedTime)-mBaseTime;
 	}
 
 	// The distance mCurrTime - mBaseTime includes paused time,
@@ -44,30 +74,30 @@ float GameTimer::TotalTime()const
 	
 	else
 	{
-		return (float)(((mCurrTime-mPausedTime)-mBaseTime)*mSecondsPerCount);
+		return (mCurrTime-mPausedTime)-mBaseTime;
 	}
 }
 
-float GameTimer::DeltaTime()const
+std::int64_t GameTimer::DeltaTimeNanoseconds()const
 {
-	return (float)mDeltaTime;
+	return mDeltaTime;
 }
 
 void GameTimer::Reset()
 {
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	std::int64_t currTime = Now();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
+	mCurrTime = currTime;
+	mPausedTime = 0;
 	mStopTime = 0;
 	mStopped  = false;
 }
 
 void GameTimer::Start()
 {
-	__int64 startTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
+	std::int64_t startTime = Now();
 
 
 	// Accumulate the time elapsed between stop and start pairs.
@@ -90,10 +120,7 @@ void GameTimer::Stop()
 {
 	if( !mStopped )
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-
-		mStopTime = currTime;
+		mStopTime = Now();
 		mStopped  = true;
 	}
 }
@@ -102,16 +129,14 @@ void GameTimer::Tick()
 {
 	if( mStopped )
 	{
-		mDeltaTime = 0.0;
+		mDeltaTime = 0;
 		return;
 	}
 
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-	mCurrTime = currTime;
+	mCurrTime = Now();
 
 	// Time difference between this frame and the previous.
-	mDeltaTime = (mCurrTime - mPrevTime)*mSecondsPerCount;
+	mDeltaTime = mCurrTime - mPrevTime;
 
 	// Prepare for next frame.
 	mPrevTime = mCurrTime;
@@ -119,9 +144,9 @@ void GameTimer::Tick()
 	// Force nonnegative.  The DXSDK's CDXUTTimer mentions that if the 
 	// processor goes into a power save mode or we get shuffled to another
 	// processor, then mDeltaTime can be negative.
-	if(mDeltaTime < 0.0)
+	if(mDeltaTime < 0)
 	{
-		mDeltaTime = 0.0;
+		mDeltaTime = 0;
 	}
 }
 
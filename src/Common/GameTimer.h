@@ -5,6 +5,8 @@
 #ifndef GAMETIMER_H
 #define GAMETIMER_H
 
+#include <cstdint>
+
 class GameTimer
 {
 public:
@@ -13,22 +15,33 @@ public:
 	float TotalTime()const; // in seconds
 	float DeltaTime()const; // in seconds
 
+	// Full precision accessors.  A float only resolves milliseconds for the first few
+	// hours of uptime, so long running code should prefer these.
+	double TotalTimeSeconds()const;
+	double DeltaTimeSeconds()const;
+	std::int64_t TotalTimeNanoseconds()const;
+	std::int64_t DeltaTimeNanoseconds()const;
+
 	void Reset(); // Call before message loop.
 	void Start(); // Call when unpaused.
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
 
+	// Current reading of the monotonic clock in nanoseconds.  The epoch is unspecified,
+	// so only differences between readings are meaningful.
+	static std::int64_t Now();
+
 private:
-	double mSecondsPerCount;
-	double mDeltaTime;
+	// All times are in nanoseconds of the monotonic clock.
+	std::int64_t mDeltaTime;
 
-	__int64 mBaseTime;
-	__int64 mPausedTime;
-	__int64 mStopTime;
-	__int64 mPrevTime;
-	__int64 mCurrTime;
+	std::int64_t mBaseTime;
+	std::int64_t mPausedTime;
+	std::int64_t mStopTime;
+	std::int64_t mPrevTime;
+	std::int64_t mCurrTime;
 
 	bool mStopped;
 };
 
-#endif // GAMETIMER_H
\ No newline at end of file
+#endif // GAMETIMER_H
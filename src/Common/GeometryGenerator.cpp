@@ -3,6 +3,7 @@
 //***************************************************************************************
 
 #include "GeometryGenerator.h"
+#include "FastMath.h"
 #include <algorithm>
 
 using namespace DirectX;
@@ -119,10 +120,22 @@ GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32
 	float phiStep   = XM_PI/stackCount;
 	float thetaStep = 2.0f*XM_PI/sliceCount;
 
+	// Every ring uses the same slice angles, so evaluate their sines and cosines once.
+	std::vector<float> sinTheta, cosTheta;
+	RingSinCos(sliceCount, sinTheta, cosTheta);
+
+	std::vector<float> phiAngles(stackCount-1), sinPhi(stackCount-1), cosPhi(stackCount-1);
+	for(uint32 i = 1; i <= stackCount-1; ++i)
+		phiAngles[i-1] = i*phiStep;
+	FastMath::SinCosArray(phiAngles.data(), sinPhi.data(), cosPhi.data(), phiAngles.size());
+
+	meshData.Vertices.reserve(2 + (stackCount-1)*(sliceCount+1));
+
 	// Compute vertices for each stack ring (do not count the poles as rings).
 	for(uint32 i = 1; i <= stackCount-1; ++i)
 	{
-		float phi = i*phiStep;
+		float phi = phiAngles[i-1];
+		float rSinPhi = radius*sinPhi[i-1];
 
 		// Vertices of ring.
         for(uint32 j = 0; j <= sliceCount; ++j)
@@ -132,14 +145,14 @@ GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32
 			Vertex v;
 
 			// spherical to cartesian
-			v.Position.x = radius*sinf(phi)*cosf(theta);
-			v.Position.y = radius*cosf(phi);
-			v.Position.z = radius*sinf(phi)*sinf(theta);
+			v.Position.x = rSinPhi*cosTheta[j];
+			v.Position.y = radius*cosPhi[i-1];
+			v.Position.z = rSinPhi*sinTheta[j];
 
 			// Partial derivative of P with respect to theta
-			v.TangentU.x = -radius*sinf(phi)*sinf(theta);
+			v.TangentU.x = -rSinPhi*sinTheta[j];
 			v.TangentU.y = 0.0f;
-			v.TangentU.z = +radius*sinf(phi)*cosf(theta);
+			v.TangentU.z = +rSinPhi*cosTheta[j];
 
 			XMVECTOR T = XMLoadFloat3(&v.TangentU);
 			XMStoreFloat3(&v.TangentU, XMVector3Normalize(T));
@@ -343,8 +356,13 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(float radius, uin
 	for(uint32 i = 0; i < numSubdivisions; ++i)
 		Subdivide(meshData);
 
+	const size_t vertexCount = meshData.Vertices.size();
+
+	// Spherical coordinates are evaluated in batches, so gather the inputs first.
+	std::vector<float> px(vertexCount), py(vertexCount), pz(vertexCount);
+
 	// Project vertices onto sphere and scale.
-	for(uint32 i = 0; i < meshData.Vertices.size(); ++i)
+	for(uint32 i = 0; i < vertexCount; ++i)
 	{
 		// Project onto unit sphere.
 		XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&meshData.Vertices[i].Position));
@@ -355,22 +373,37 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(float radius, uin
 		XMStoreFloat3(&meshData.Vertices[i].Position, p);
 		XMStoreFloat3(&meshData.Vertices[i].Normal, n);
 
-		// Derive texture coordinates from spherical coordinates.
-        float theta = atan2f(meshData.Vertices[i].Position.z, meshData.Vertices[i].Position.x);
+		px[i] = meshData.Vertices[i].Position.x;
+		py[i] = meshData.Vertices[i].Position.y / radius;
+		pz[i] = meshData.Vertices[i].Position.z;
+	}
+
+	// Derive texture coordinates from spherical coordinates.  The outputs reuse the
+	// input arrays: px <- theta, py <- phi.
+	FastMath::Atan2Array(pz.data(), px.data(), px.data(), vertexCount);
+	FastMath::AcosArray(py.data(), py.data(), vertexCount);
 
-        // Put in [0, 2pi].
-        if(theta < 0.0f)
-            theta += XM_2PI;
+	// Put theta in [0, 2pi].
+	for(uint32 i = 0; i < vertexCount; ++i)
+	{
+		if(px[i] < 0.0f)
+			px[i] += XM_2PI;
+	}
 
-		float phi = acosf(meshData.Vertices[i].Position.y / radius);
+	std::vector<float> sinTheta(vertexCount), cosTheta(vertexCount);
+	std::vector<float> sinPhi(vertexCount), cosPhi(vertexCount);
+	FastMath::SinCosArray(px.data(), sinTheta.data(), cosTheta.data(), vertexCount);
+	FastMath::SinCosArray(py.data(), sinPhi.data(), cosPhi.data(), vertexCount);
 
-		meshData.Vertices[i].TexC.x = theta/XM_2PI;
-		meshData.Vertices[i].TexC.y = phi/XM_PI;
+	for(uint32 i = 0; i < vertexCount; ++i)
+	{
+		meshData.Vertices[i].TexC.x = px[i]/XM_2PI;
+		meshData.Vertices[i].TexC.y = py[i]/XM_PI;
 
 		// Partial derivative of P with respect to theta
-		meshData.Vertices[i].TangentU.x = -radius*sinf(phi)*sinf(theta);
+		meshData.Vertices[i].TangentU.x = -radius*sinPhi[i]*sinTheta[i];
 		meshData.Vertices[i].TangentU.y = 0.0f;
-		meshData.Vertices[i].TangentU.z = +radius*sinf(phi)*cosf(theta);
+		meshData.Vertices[i].TangentU.z = +radius*sinPhi[i]*cosTheta[i];
 
 		XMVECTOR T = XMLoadFloat3(&meshData.Vertices[i].TangentU);
 		XMStoreFloat3(&meshData.Vertices[i].TangentU, XMVector3Normalize(T));
@@ -394,6 +427,12 @@ GeometryGenerator::MeshData GeometryGenerator::CreateCylinder(float bottomRadius
 
 	uint32 ringCount = stackCount+1;
 
+	// Every ring uses the same slice angles, so evaluate their sines and cosines once.
+	std::vector<float> sinTheta, cosTheta;
+	RingSinCos(sliceCount, sinTheta, cosTheta);
+
+	meshData.Vertices.reserve(ringCount*(sliceCount+1) + 2*(sliceCount+2));
+
 	// Compute vertices for each stack ring starting at the bottom and moving up.
 	for(uint32 i = 0; i < ringCount; ++i)
 	{
@@ -401,13 +440,12 @@ GeometryGenerator::MeshData GeometryGenerator::CreateCylinder(float bottomRadius
 		float r = bottomRadius + i*radiusStep;
 
 		// vertices of ring
-		float dTheta = 2.0f*XM_PI/sliceCount;
 		for(uint32 j = 0; j <= sliceCount; ++j)
 		{
 			Vertex vertex;
 
-			float c = cosf(j*dTheta);
-			float s = sinf(j*dTheta);
+			float c = cosTheta[j];
+			float s = sinTheta[j];
 
 			vertex.Position = XMFLOAT3(r*c, y, r*s);
 
@@ -479,13 +517,15 @@ void GeometryGenerator::BuildCylinderTopCap(float bottomRadius, float topRadius,
 	uint32 baseIndex = (uint32)meshData.Vertices.size();
 
 	float y = 0.5f*height;
-	float dTheta = 2.0f*XM_PI/sliceCount;
+
+	std::vector<float> sinTheta, cosTheta;
+	RingSinCos(sliceCount, sinTheta, cosTheta);
 
 	// Duplicate cap ring vertices because the texture coordinates and normals differ.
 	for(uint32 i = 0; i <= sliceCount; ++i)
 	{
-		float x = topRadius*cosf(i*dTheta);
-		float z = topRadius*sinf(i*dTheta);
+		float x = topRadius*cosTheta[i];
+		float z = topRadius*sinTheta[i];
 
 		// Scale down by the height to try and make top cap texture coord area
 		// proportional to base.
@@ -519,12 +559,14 @@ void GeometryGenerator::BuildCylinderBottomCap(float bottomRadius, float topRadi
 	uint32 baseIndex = (uint32)meshData.Vertices.size();
 	float y = -0.5f*height;
 
+	std::vector<float> sinTheta, cosTheta;
+	RingSinCos(sliceCount, sinTheta, cosTheta);
+
 	// vertices of ring
-	float dTheta = 2.0f*XM_PI/sliceCount;
 	for(uint32 i = 0; i <= sliceCount; ++i)
 	{
-		float x = bottomRadius*cosf(i*dTheta);
-		float z = bottomRadius*sinf(i*dTheta);
+		float x = bottomRadius*cosTheta[i];
+		float z = bottomRadius*sinTheta[i];
 
 		// Scale down by the height to try and make top cap texture coord area
 		// proportional to base.
@@ -548,6 +590,19 @@ void GeometryGenerator::BuildCylinderBottomCap(float bottomRadius, float topRadi
 	}
 }
 
+void GeometryGenerator::RingSinCos(uint32 sliceCount, std::vector<float>& sinTheta, std::vector<float>& cosTheta)
+{
+	float dTheta = 2.0f*XM_PI/sliceCount;
+
+	std::vector<float> theta(sliceCount+1);
+	for(uint32 i = 0; i <= sliceCount; ++i)
+		theta[i] = i*dTheta;
+
+	sinTheta.resize(sliceCount+1);
+	cosTheta.resize(sliceCount+1);
+	FastMath::SinCosArray(theta.data(), sinTheta.data(), cosTheta.data(), theta.size());
+}
+
 GeometryGenerator::MeshData GeometryGenerator::CreateGrid(float width, float depth, uint32 m, uint32 n)
 {
     MeshData meshData;
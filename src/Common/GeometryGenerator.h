@@ -115,5 +115,8 @@ private:
     Vertex MidPoint(const Vertex& v0, const Vertex& v1);
     void BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
     void BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
+
+	// Sines and cosines of the sliceCount+1 evenly spaced angles i*2pi/sliceCount.
+	static void RingSinCos(uint32 sliceCount, std::vector<float>& sinTheta, std::vector<float>& cosTheta);
 };
 
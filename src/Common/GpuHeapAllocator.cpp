@@ -0,0 +1,340 @@
+//***************************************************************************************
+// GpuHeapAllocator.cpp
+//***************************************************************************************
+
+#include "GpuHeapAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+	void AddStats(BuddyAllocator::Stats& totals, const BuddyAllocator::Stats& b)
+	{
+		totals.Capacity += b.Capacity;
+		totals.RequestedBytes += b.RequestedBytes;
+		totals.AllocatedBytes += b.AllocatedBytes;
+		totals.FreeBytes += b.FreeBytes;
+		totals.AllocationCount += b.AllocationCount;
+		totals.FreeBlockCount += b.FreeBlockCount;
+		totals.FailedAllocations += b.FailedAllocations;
+		if(b.LargestFreeBlock > totals.LargestFreeBlock)
+			totals.LargestFreeBlock = b.LargestFreeBlock;
+	}
+}
+
+GpuAllocation::GpuAllocation(ComPtr<ID3D12Resource> resource)
+	: mResource(std::move(resource))
+{
+}
+
+GpuAllocation::GpuAllocation(GpuAllocation&& rhs) noexcept
+{
+	*this = std::move(rhs);
+}
+
+GpuAllocation& GpuAllocation::operator=(GpuAllocation&& rhs) noexcept
+{
+	if(this != &rhs)
+	{
+		Reset();
+		mResource = std::move(rhs.mResource);
+		mBlocks = rhs.mBlocks;
+		mBlockOffset = rhs.mBlockOffset;
+		mOffset = rhs.mOffset;
+		mShared = rhs.mShared;
+		rhs.mBlocks = nullptr;
+		rhs.Reset();
+	}
+	return *this;
+}
+
+GpuAllocation::~GpuAllocation()
+{
+	Reset();
+}
+
+void GpuAllocation::Reset()
+{
+	if(mBlocks != nullptr)
+		mBlocks->Free(mBlockOffset);
+
+	mResource = nullptr;
+	mBlocks = nullptr;
+	mBlockOffset = 0;
+	mOffset = 0;
+	mShared = false;
+}
+
+ID3D12Resource* GpuAllocation::Resource()const
+{
+	return mResource.Get();
+}
+
+UINT64 GpuAllocation::Offset()const
+{
+	return mOffset;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS GpuAllocation::GpuAddress()const
+{
+	return mResource->GetGPUVirtualAddress() + mOffset;
+}
+
+bool GpuAllocation::IsShared()const
+{
+	return mShared;
+}
+
+GpuAllocation::operator bool()const
+{
+	return mResource != nullptr;
+}
+
+GpuHeapAllocator::GpuHeapAllocator(ID3D12Device* device, UINT64 pageSize, UINT64 sharedBufferSize)
+	: md3dDevice(device), mPageSize(pageSize), mSharedBufferSize(sharedBufferSize)
+{
+	assert(sharedBufferSize <= pageSize);
+}
+
+GpuHeapAllocator::~GpuHeapAllocator()
+{
+	// Allocations free their blocks into the pages, so none may outlive them.
+	for(auto& shared : mSharedBuffers)
+		assert(shared->Ranges->Empty() && "GpuAllocation outlived its GpuHeapAllocator");
+	mSharedBuffers.clear();
+
+	for(auto& pages : mPages)
+	{
+		for(auto& page : pages)
+			assert(page->Blocks->Empty() && "GpuAllocation outlived its GpuHeapAllocator");
+	}
+}
+
+GpuHeapAllocator::Page* GpuHeapAllocator::AddPage(Pool pool)
+{
+	D3D12_HEAP_DESC heapDesc = {};
+	heapDesc.SizeInBytes = mPageSize;
+	heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	heapDesc.Flags = (pool == Pool::Buffers) ?
+		D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS : D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+
+	auto page = std::make_unique<Page>();
+	if(FAILED(md3dDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(page->Heap.GetAddressOf()))))
+		return nullptr;
+
+	// Only textures can use the 4KB small resource alignment.
+	UINT64 minBlock = (pool == Pool::Buffers) ?
+		D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+	page->Blocks = std::make_unique<BuddyAllocator>(mPageSize, minBlock);
+
+	mPages[(int)pool].push_back(std::move(page));
+	return mPages[(int)pool].back().get();
+}
+
+HRESULT GpuHeapAllocator::CreateResource(
+	const D3D12_RESOURCE_DESC& descIn,
+	D3D12_RESOURCE_STATES initialState,
+	const D3D12_CLEAR_VALUE* clearValue,
+	GpuAllocation& allocation)
+{
+	allocation.Reset();
+
+	D3D12_RESOURCE_DESC desc = descIn;
+	bool isBuffer = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
+	if(isBuffer && desc.Width <= MaxSharedBufferRange && desc.Flags == D3D12_RESOURCE_FLAG_NONE &&
+		initialState == D3D12_RESOURCE_STATE_COMMON)
+	{
+		return AllocateShared(desc.Width, allocation);
+	}
+
+	bool isTarget = (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) != 0;
+	Pool pool = isBuffer ? Pool::Buffers : Pool::Textures;
+
+	D3D12_RESOURCE_ALLOCATION_INFO info = {};
+	if(!isTarget)
+	{
+		// Ask for the small alignment first; the runtime reports the default one
+		// instead if this texture does not qualify.
+		if(!isBuffer && desc.Alignment == 0)
+		{
+			desc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+			info = md3dDevice->GetResourceAllocationInfo(0, 1, &desc);
+			if(info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+				desc.Alignment = 0;
+		}
+
+		if(desc.Alignment == 0 || isBuffer)
+			info = md3dDevice->GetResourceAllocationInfo(0, 1, &desc);
+	}
+
+	if(isTarget || info.SizeInBytes == UINT64_MAX || info.SizeInBytes > mPageSize)
+	{
+		++mCommittedFallbacks[(int)pool];
+		ComPtr<ID3D12Resource> resource;
+		HRESULT hr = md3dDevice->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&descIn,
+			initialState,
+			clearValue,
+			IID_PPV_ARGS(resource.GetAddressOf()));
+		if(SUCCEEDED(hr))
+			allocation = GpuAllocation(std::move(resource));
+		return hr;
+	}
+
+	// First page with room, adding one if none has.
+	Page* page = nullptr;
+	UINT64 offset = BuddyAllocator::InvalidOffset;
+	for(auto& p : mPages[(int)pool])
+	{
+		offset = p->Blocks->Allocate(info.SizeInBytes, info.Alignment);
+		if(offset != BuddyAllocator::InvalidOffset)
+		{
+			page = p.get();
+			break;
+		}
+	}
+
+	if(page == nullptr)
+	{
+		page = AddPage(pool);
+		if(page == nullptr)
+			return E_OUTOFMEMORY;
+		offset = page->Blocks->Allocate(info.SizeInBytes, info.Alignment);
+	}
+
+	ComPtr<ID3D12Resource> resource;
+	HRESULT hr = md3dDevice->CreatePlacedResource(
+		page->Heap.Get(),
+		offset,
+		&desc,
+		initialState,
+		clearValue,
+		IID_PPV_ARGS(resource.GetAddressOf()));
+
+	if(FAILED(hr))
+	{
+		page->Blocks->Free(offset);
+		return hr;
+	}
+
+	allocation.mResource = std::move(resource);
+	allocation.mBlocks = page->Blocks.get();
+	allocation.mBlockOffset = offset;
+
+	return S_OK;
+}
+
+HRESULT GpuHeapAllocator::AllocateShared(UINT64 byteSize, GpuAllocation& allocation)
+{
+	const UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+
+	// First shared buffer with room, adding one if none has.
+	SharedBuffer* shared = nullptr;
+	UINT64 offset = BuddyAllocator::InvalidOffset;
+	for(auto& s : mSharedBuffers)
+	{
+		offset = s->Ranges->Allocate(byteSize, alignment);
+		if(offset != BuddyAllocator::InvalidOffset)
+		{
+			shared = s.get();
+			break;
+		}
+	}
+
+	if(shared == nullptr)
+	{
+		// The backing buffer is too large to be shared itself, so this does not recurse.
+		auto added = std::make_unique<SharedBuffer>();
+		HRESULT hr = CreateResource(CD3DX12_RESOURCE_DESC::Buffer(mSharedBufferSize),
+			D3D12_RESOURCE_STATE_COMMON, nullptr, added->Backing);
+		if(FAILED(hr))
+			return hr;
+
+		added->Ranges = std::make_unique<BuddyAllocator>(mSharedBufferSize, alignment);
+		mSharedBuffers.push_back(std::move(added));
+		shared = mSharedBuffers.back().get();
+		offset = shared->Ranges->Allocate(byteSize, alignment);
+	}
+
+	allocation.mResource = shared->Backing.mResource;
+	allocation.mBlocks = shared->Ranges.get();
+	allocation.mBlockOffset = offset;
+	allocation.mOffset = offset;
+	allocation.mShared = true;
+
+	return S_OK;
+}
+
+GpuAllocation GpuHeapAllocator::CreateBuffer(UINT64 byteSize, D3D12_RESOURCE_STATES initialState,
+	D3D12_RESOURCE_FLAGS flags)
+{
+	GpuAllocation buffer;
+	ThrowIfFailed(CreateResource(CD3DX12_RESOURCE_DESC::Buffer(byteSize, flags), initialState, nullptr, buffer));
+	return buffer;
+}
+
+GpuAllocation GpuHeapAllocator::CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState)
+{
+	GpuAllocation texture;
+	ThrowIfFailed(CreateResource(desc, initialState, nullptr, texture));
+	return texture;
+}
+
+void GpuHeapAllocator::TrimEmptyPages()
+{
+	// Shared buffers first, so the blocks they free can empty their pages.
+	bool keptShared = false;
+	for(auto it = mSharedBuffers.begin(); it != mSharedBuffers.end();)
+	{
+		if((*it)->Ranges->Empty())
+		{
+			if(keptShared)
+			{
+				it = mSharedBuffers.erase(it);
+				continue;
+			}
+			keptShared = true;
+		}
+		++it;
+	}
+
+	for(auto& pages : mPages)
+	{
+		bool keptOne = false;
+		for(auto it = pages.begin(); it != pages.end();)
+		{
+			if((*it)->Blocks->Empty())
+			{
+				if(keptOne)
+				{
+					it = pages.erase(it);
+					continue;
+				}
+				keptOne = true;
+			}
+			++it;
+		}
+	}
+}
+
+GpuHeapAllocator::PoolStats GpuHeapAllocator::GetStats(Pool pool)const
+{
+	PoolStats s;
+	s.PageCount = (UINT32)mPages[(int)pool].size();
+	s.CommittedFallbacks = mCommittedFallbacks[(int)pool];
+
+	for(const auto& p : mPages[(int)pool])
+		AddStats(s.Totals, p->Blocks->GetStats());
+
+	if(pool == Pool::Buffers)
+	{
+		s.SharedBufferCount = (UINT32)mSharedBuffers.size();
+		for(const auto& shared : mSharedBuffers)
+			AddStats(s.SharedTotals, shared->Ranges->GetStats());
+	}
+
+	return s;
+}
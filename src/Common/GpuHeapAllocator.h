@@ -0,0 +1,138 @@
+//***************************************************************************************
+// GpuHeapAllocator.h
+//
+// Creates default heap buffers and textures as placed resources inside large
+// ID3D12Heaps instead of one committed resource each.  Heaps are allocated in pages of
+// a fixed size per pool and each page is sub-allocated with a BuddyAllocator.
+//
+// Buffers and non render target textures live in separate pools so the heaps work on
+// resource heap tier 1.  Buffers must be placed at 64KB boundaries; small textures
+// use the 4KB placement alignment when the device allows it.  Render targets, depth
+// buffers and resources larger than a page fall back to committed resources.
+//
+// Small buffers do not get a 64KB block each.  They are ranges of a shared placed
+// buffer that is itself a block of a buffer page, sub-allocated with a BuddyAllocator
+// at constant buffer alignment, so they are addressed by Resource() plus Offset().
+//
+// Every allocation is a GpuAllocation that returns its block when it is reset or
+// destroyed, which must not happen before the GPU is done with the resource.  The
+// allocator must outlive its allocations.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "BuddyAllocator.h"
+
+// A resource from GpuHeapAllocator together with the heap block it occupies.  Move
+// only; the block is freed when the allocation is reset, destroyed or assigned over.
+class GpuAllocation
+{
+public:
+	GpuAllocation() = default;
+	// Wraps a resource that does not come from an allocator, so callers can hold
+	// placed and committed resources alike.  Reset only releases it.
+	explicit GpuAllocation(Microsoft::WRL::ComPtr<ID3D12Resource> resource);
+	GpuAllocation(GpuAllocation&& rhs) noexcept;
+	GpuAllocation& operator=(GpuAllocation&& rhs) noexcept;
+	GpuAllocation(const GpuAllocation& rhs) = delete;
+	GpuAllocation& operator=(const GpuAllocation& rhs) = delete;
+	~GpuAllocation();
+
+	void Reset();
+
+	// For a shared buffer range, the shared buffer; Offset is where the range starts.
+	ID3D12Resource* Resource()const;
+	UINT64 Offset()const;
+	D3D12_GPU_VIRTUAL_ADDRESS GpuAddress()const;
+	bool IsShared()const;
+	explicit operator bool()const;
+
+private:
+	friend class GpuHeapAllocator;
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> mResource;
+	BuddyAllocator* mBlocks = nullptr; // Page or shared buffer the block is from; null if none.
+	UINT64 mBlockOffset = 0;
+	UINT64 mOffset = 0;
+	bool mShared = false;
+};
+
+class GpuHeapAllocator
+{
+public:
+	enum class Pool
+	{
+		Buffers,
+		Textures,
+		Count
+	};
+
+	struct PoolStats
+	{
+		UINT32 PageCount = 0;
+		UINT32 CommittedFallbacks = 0; // Resources of this kind that were not placed.
+		BuddyAllocator::Stats Totals;   // Summed over the pool's pages.  LargestFreeBlock is the max.
+
+		// Buffers only: the shared buffers and the ranges handed out of them.  Each
+		// shared buffer also counts as one allocation in Totals.
+		UINT32 SharedBufferCount = 0;
+		BuddyAllocator::Stats SharedTotals;
+	};
+
+	// Buffers up to this size may be ranges of a shared buffer; see CreateResource.
+	static const UINT64 MaxSharedBufferRange = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT / 2;
+
+	explicit GpuHeapAllocator(ID3D12Device* device, UINT64 pageSize = 64 * 1024 * 1024,
+		UINT64 sharedBufferSize = 4 * 1024 * 1024);
+	GpuHeapAllocator(const GpuHeapAllocator& rhs) = delete;
+	GpuHeapAllocator& operator=(const GpuHeapAllocator& rhs) = delete;
+	~GpuHeapAllocator();
+
+	// Creates a default heap resource, placed when possible.  HRESULT based so the
+	// texture loaders can use it.  A buffer of at most MaxSharedBufferRange bytes with
+	// no flags, created in the COMMON state, is a range of a shared buffer.  Shared
+	// buffers stay in COMMON, so such a buffer must only reach other states through
+	// implicit promotion.  Its range is aligned for a constant buffer view.
+	HRESULT CreateResource(
+		const D3D12_RESOURCE_DESC& desc,
+		D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE* clearValue,
+		GpuAllocation& allocation);
+
+	// Throwing convenience wrappers.
+	GpuAllocation CreateBuffer(UINT64 byteSize, D3D12_RESOURCE_STATES initialState,
+		D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE);
+	GpuAllocation CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState);
+
+	// Releases shared buffers and pages with no allocations, keeping at most one empty
+	// of each per pool.
+	void TrimEmptyPages();
+
+	PoolStats GetStats(Pool pool)const;
+
+private:
+	struct Page
+	{
+		Microsoft::WRL::ComPtr<ID3D12Heap> Heap;
+		std::unique_ptr<BuddyAllocator> Blocks;
+	};
+
+	struct SharedBuffer
+	{
+		GpuAllocation Backing;
+		std::unique_ptr<BuddyAllocator> Ranges;
+	};
+
+	Page* AddPage(Pool pool);
+	HRESULT AllocateShared(UINT64 byteSize, GpuAllocation& allocation);
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Device> md3dDevice;
+	UINT64 mPageSize;
+	UINT64 mSharedBufferSize;
+
+	std::vector<std::unique_ptr<Page>> mPages[(int)Pool::Count];
+	UINT32 mCommittedFallbacks[(int)Pool::Count] = {};
+	std::vector<std::unique_ptr<SharedBuffer>> mSharedBuffers;
+};
@@ -0,0 +1,168 @@
+//***************************************************************************************
+// JobSystem.cpp
+//***************************************************************************************
+
+#include "JobSystem.h"
+
+bool JobCounter::IsDone()const
+{
+	return mPending.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem(unsigned workerCount)
+{
+	if(workerCount == 0)
+	{
+		unsigned hardware = std::thread::hardware_concurrency();
+		workerCount = (hardware > 1) ? hardware - 1 : 1;
+	}
+
+	for(unsigned i = 0; i < workerCount; ++i)
+		mWorkers.emplace_back(&JobSystem::WorkerMain, this);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mCondition.notify_all();
+
+	for(std::thread& worker : mWorkers)
+		worker.join();
+}
+
+unsigned JobSystem::WorkerCount()const
+{
+	return (unsigned)mWorkers.size();
+}
+
+void JobSystem::Schedule(std::function<void()> job, JobCounter* counter)
+{
+	if(counter != nullptr)
+		counter->mPending.fetch_add(1, std::memory_order_relaxed);
+
+	bool waiting;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.push_back({ std::move(job), counter });
+		waiting = mWaiting > 0;
+	}
+	mCondition.notify_one();
+
+	// A thread in Wait may be the only one free to run it, e.g. when every worker is
+	// itself waiting inside a job.
+	if(waiting)
+		mWaitCondition.notify_all();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while(!counter.IsDone())
+	{
+		if(TryRunOne())
+			continue;
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		++mWaiting;
+		mWaitCondition.wait(lock, [this, &counter]() { return counter.IsDone() || !mJobs.empty(); });
+		--mWaiting;
+	}
+
+	// Every job on counter has finished, so nothing else touches mException now.
+	std::exception_ptr exception;
+	std::swap(exception, counter.mException);
+	if(exception)
+		std::rethrow_exception(exception);
+}
+
+void JobSystem::ParallelFor(std::uint32_t count, const std::function<void(std::uint32_t)>& job)
+{
+	if(count == 0)
+		return;
+
+	// Index 0 runs on the calling thread; the rest go to the pool.
+	JobCounter counter;
+	for(std::uint32_t i = 1; i < count; ++i)
+		Schedule([&job, i]() { job(i); }, &counter);
+
+	// Wait even if job(0) throws: the queued jobs reference job and counter.
+	try
+	{
+		job(0);
+	}
+	catch(...)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(!counter.mException)
+			counter.mException = std::current_exception();
+	}
+
+	Wait(counter);
+}
+
+bool JobSystem::TryRunOne()
+{
+	Job job;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(mJobs.empty())
+			return false;
+
+		job = std::move(mJobs.front());
+		mJobs.pop_front();
+	}
+
+	Run(job);
+	return true;
+}
+
+void JobSystem::Run(Job& job)
+{
+	if(job.Counter == nullptr)
+	{
+		job.Function();
+		return;
+	}
+
+	try
+	{
+		job.Function();
+	}
+	catch(...)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(!job.Counter->mException)
+			job.Counter->mException = std::current_exception();
+	}
+
+	if(job.Counter->mPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		// Taking the lock orders this notify after a waiter's check of the counter, so
+		// the wakeup cannot be lost.
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+		}
+		mWaitCondition.notify_all();
+	}
+}
+
+void JobSystem::WorkerMain()
+{
+	for(;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this]() { return mQuit || !mJobs.empty(); });
+			if(mQuit && mJobs.empty())
+				return;
+
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+		}
+
+		Run(job);
+	}
+}
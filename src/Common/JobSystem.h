@@ -0,0 +1,83 @@
+//***************************************************************************************
+// JobSystem.h
+//
+// Fixed pool of worker threads running short jobs from a shared queue.  Completion is
+// tracked with a JobCounter: Schedule increments it, the job's completion decrements
+// it, and Wait returns once it reaches zero.  The waiting thread runs queued jobs
+// itself while there are any, so waiting from inside a job cannot deadlock the pool,
+// and sleeps on a condition variable once the queue is empty.  An exception thrown by
+// a job is stored in its counter and rethrown by Wait on the waiting thread.
+//***************************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter& rhs) = delete;
+	JobCounter& operator=(const JobCounter& rhs) = delete;
+
+	bool IsDone()const;
+
+private:
+	friend class JobSystem;
+	std::atomic<std::uint32_t> mPending{ 0 };
+	std::exception_ptr mException; // First exception thrown by a job; guarded by the JobSystem mutex.
+};
+
+class JobSystem
+{
+public:
+	// workerCount == 0 uses one worker per hardware thread, minus the calling thread.
+	explicit JobSystem(unsigned workerCount = 0);
+	JobSystem(const JobSystem& rhs) = delete;
+	JobSystem& operator=(const JobSystem& rhs) = delete;
+	~JobSystem();
+
+	unsigned WorkerCount()const;
+
+	// Queues job.  counter, if given, must outlive the job.  A job scheduled without a
+	// counter has nowhere to report an exception and must not throw.
+	void Schedule(std::function<void()> job, JobCounter* counter = nullptr);
+
+	// Returns once every job scheduled with counter has finished, running queued jobs
+	// on the calling thread in the meantime.  Rethrows the first exception any of those
+	// jobs threw; the counter can be reused afterwards.
+	void Wait(JobCounter& counter);
+
+	// Runs job(i) for every i in [0, count) and returns when all have finished.  The
+	// calling thread takes part, so count == 1 runs inline.  If any job(i) throws, the
+	// rest still run and the first exception is rethrown once all have finished.
+	void ParallelFor(std::uint32_t count, const std::function<void(std::uint32_t)>& job);
+
+private:
+	struct Job
+	{
+		std::function<void()> Function;
+		JobCounter* Counter;
+	};
+
+	bool TryRunOne();
+	void Run(Job& job);
+	void WorkerMain();
+
+private:
+	std::mutex mMutex;
+	std::condition_variable mCondition;     // Workers: a job was queued or mQuit was set.
+	std::condition_variable mWaitCondition; // Wait: a job was queued or a counter reached zero.
+	std::deque<Job> mJobs;
+	unsigned mWaiting = 0;                  // Threads blocked on mWaitCondition.
+	bool mQuit = false;
+	std::vector<std::thread> mWorkers;
+};
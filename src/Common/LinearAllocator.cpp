@@ -0,0 +1,72 @@
+//***************************************************************************************
+// LinearAllocator.cpp
+//***************************************************************************************
+
+#include "LinearAllocator.h"
+#include <cassert>
+
+LinearAllocator::LinearAllocator(std::size_t capacity, std::size_t defaultAlignment)
+	: mCapacity(capacity), mDefaultAlignment(defaultAlignment)
+{
+	assert(defaultAlignment != 0 && (defaultAlignment & (defaultAlignment - 1)) == 0);
+}
+
+std::size_t LinearAllocator::Allocate(std::size_t size)
+{
+	return Allocate(size, mDefaultAlignment);
+}
+
+std::size_t LinearAllocator::Allocate(std::size_t size, std::size_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+	std::size_t offset = AlignUp(mOffset, alignment);
+
+	// Written to avoid overflow when size is close to SIZE_MAX.
+	if(offset > mCapacity || size > mCapacity - offset)
+	{
+		++mFailedCount;
+		return InvalidOffset;
+	}
+
+	mOffset = offset + size;
+	if(mOffset > mPeakUsed)
+		mPeakUsed = mOffset;
+
+	return offset;
+}
+
+void LinearAllocator::Reset()
+{
+	mOffset = 0;
+}
+
+std::size_t LinearAllocator::Capacity()const
+{
+	return mCapacity;
+}
+
+std::size_t LinearAllocator::Used()const
+{
+	return mOffset;
+}
+
+std::size_t LinearAllocator::Remaining()const
+{
+	return mCapacity - mOffset;
+}
+
+std::size_t LinearAllocator::PeakUsed()const
+{
+	return mPeakUsed;
+}
+
+std::size_t LinearAllocator::FailedCount()const
+{
+	return mFailedCount;
+}
+
+std::size_t LinearAllocator::AlignUp(std::size_t value, std::size_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
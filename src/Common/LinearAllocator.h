@@ -0,0 +1,48 @@
+//***************************************************************************************
+// LinearAllocator.h
+//
+// Bump allocator over a fixed range of offsets.  It manages offsets only, not memory,
+// so the same logic serves mapped GPU upload buffers and plain CPU arrays.  Individual
+// allocations are never freed; Reset releases everything at once, typically when the
+// GPU has finished with the frame that used the range.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+
+class LinearAllocator
+{
+public:
+	static const std::size_t InvalidOffset = ~std::size_t(0);
+
+	// defaultAlignment must be a power of two.  256 matches the placement alignment
+	// D3D12 requires for constant buffer views and root CBVs.
+	explicit LinearAllocator(std::size_t capacity = 0, std::size_t defaultAlignment = 256);
+
+	// Returns the offset of a block of 'size' bytes, or InvalidOffset if the range is
+	// exhausted.  alignment must be a power of two.
+	std::size_t Allocate(std::size_t size);
+	std::size_t Allocate(std::size_t size, std::size_t alignment);
+
+	void Reset();
+
+	std::size_t Capacity()const;
+	std::size_t Used()const;
+	std::size_t Remaining()const;
+
+	// Largest Used() value seen since construction, for sizing the capacity.
+	std::size_t PeakUsed()const;
+
+	// Allocations that failed since construction.
+	std::size_t FailedCount()const;
+
+	static std::size_t AlignUp(std::size_t value, std::size_t alignment);
+
+private:
+	std::size_t mCapacity;
+	std::size_t mDefaultAlignment;
+	std::size_t mOffset = 0;
+	std::size_t mPeakUsed = 0;
+	std::size_t mFailedCount = 0;
+};
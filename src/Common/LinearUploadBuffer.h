@@ -0,0 +1,107 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "LinearAllocator.h"
+
+// A persistently mapped upload buffer handed out in slices by a LinearAllocator.
+// Each frame resource owns one and resets it once the GPU has finished with that
+// frame, so every draw can write its constants to a fresh slice instead of sharing
+// one slot that the GPU may still be reading.
+class LinearUploadBuffer
+{
+public:
+    struct Allocation
+    {
+        BYTE* CpuAddress = nullptr; // nullptr if the buffer was exhausted
+        D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+        UINT64 Offset = 0;
+        UINT64 Size = 0;
+    };
+
+    LinearUploadBuffer(ID3D12Device* device, UINT64 byteSize,
+        UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT) :
+        mAllocator((std::size_t)byteSize, (std::size_t)alignment)
+    {
+        ThrowIfFailed(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&mUploadBuffer)));
+
+        ThrowIfFailed(mUploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
+        mGpuAddress = mUploadBuffer->GetGPUVirtualAddress();
+    }
+
+    LinearUploadBuffer(const LinearUploadBuffer& rhs) = delete;
+    LinearUploadBuffer& operator=(const LinearUploadBuffer& rhs) = delete;
+    ~LinearUploadBuffer()
+    {
+        if(mUploadBuffer != nullptr)
+            mUploadBuffer->Unmap(0, nullptr);
+
+        mMappedData = nullptr;
+    }
+
+    Allocation Allocate(UINT64 byteSize)
+    {
+        return MakeAllocation(mAllocator.Allocate((std::size_t)byteSize), byteSize);
+    }
+
+    Allocation Allocate(UINT64 byteSize, UINT64 alignment)
+    {
+        return MakeAllocation(mAllocator.Allocate((std::size_t)byteSize, (std::size_t)alignment), byteSize);
+    }
+
+    // Copies data into a new slice and returns its GPU address, or 0 if the buffer
+    // is exhausted.  Constant buffer data is padded to a multiple of 256 bytes since
+    // the hardware reads constants in 256 byte units.
+    template<typename T>
+    D3D12_GPU_VIRTUAL_ADDRESS PushConstants(const T& data)
+    {
+        Allocation a = Allocate(d3dUtil::CalcConstantBufferByteSize(sizeof(T)));
+        if(a.CpuAddress == nullptr)
+            return 0;
+
+        memcpy(a.CpuAddress, &data, sizeof(T));
+        return a.GpuAddress;
+    }
+
+    // Only call once the GPU has finished with every slice handed out so far.
+    void Reset()
+    {
+        mAllocator.Reset();
+    }
+
+    ID3D12Resource* Resource()const
+    {
+        return mUploadBuffer.Get();
+    }
+
+    const LinearAllocator& Allocator()const
+    {
+        return mAllocator;
+    }
+
+private:
+    Allocation MakeAllocation(std::size_t offset, UINT64 byteSize)
+    {
+        Allocation a;
+        if(offset == LinearAllocator::InvalidOffset)
+            return a;
+
+        a.CpuAddress = mMappedData + offset;
+        a.GpuAddress = mGpuAddress + offset;
+        a.Offset = offset;
+        a.Size = byteSize;
+        return a;
+    }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
+    BYTE* mMappedData = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS mGpuAddress = 0;
+
+    LinearAllocator mAllocator;
+};
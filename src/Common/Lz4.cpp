@@ -0,0 +1,231 @@
+//***************************************************************************************
+// Lz4.cpp
+//***************************************************************************************
+
+#include "Lz4.h"
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	const std::size_t MinMatch = 4;
+	const std::size_t LastLiterals = 5;  // The block always ends with this many literals.
+	const std::size_t MatchStartLimit = 12; // No match starts within this many bytes of the end.
+	const std::size_t MaxOffset = 65535;
+	const unsigned HashLog = 14;
+	const std::size_t WildCopy = 16;
+
+	std::uint32_t Read32(const std::uint8_t* p)
+	{
+		std::uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	std::uint32_t Hash(std::uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - HashLog);
+	}
+
+	// Appends the bytes of a length of 15 or more beyond the token nibble.
+	std::uint8_t* WriteLength(std::uint8_t* op, std::size_t length)
+	{
+		while(length >= 255)
+		{
+			*op++ = 255;
+			length -= 255;
+		}
+		*op++ = (std::uint8_t)length;
+		return op;
+	}
+
+	bool ReadLength(const std::uint8_t*& ip, const std::uint8_t* end, std::size_t& length)
+	{
+		std::uint8_t b;
+		do
+		{
+			if(ip == end)
+				return false;
+			b = *ip++;
+			length += b;
+		} while(b == 255);
+
+		return true;
+	}
+
+	// Bytes a sequence with these lengths takes, at most.
+	std::size_t SequenceBound(std::size_t literals, std::size_t matchLength)
+	{
+		return 1 + literals / 255 + 1 + literals + 2 + matchLength / 255 + 1;
+	}
+}
+
+std::size_t Lz4CompressBound(std::size_t srcSize)
+{
+	return srcSize + srcSize / 255 + 16;
+}
+
+std::size_t Lz4Compress(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstCapacity)
+{
+	std::uint8_t* op = dst;
+	std::uint8_t* const opEnd = dst + dstCapacity;
+
+	std::size_t anchor = 0;
+
+	if(srcSize > MatchStartLimit)
+	{
+		// Positions + 1, so 0 means empty.
+		std::vector<std::uint32_t> table((std::size_t)1 << HashLog, 0);
+
+		const std::size_t matchEnd = srcSize - LastLiterals;
+		const std::size_t lastStart = srcSize - MatchStartLimit;
+
+		std::size_t ip = 0;
+		std::size_t misses = 0;
+		while(ip <= lastStart)
+		{
+			std::uint32_t sequence = Read32(src + ip);
+			std::uint32_t& slot = table[Hash(sequence)];
+			std::size_t candidate = slot;
+			slot = (std::uint32_t)(ip + 1);
+
+			if(candidate == 0 || ip - (candidate - 1) > MaxOffset || Read32(src + candidate - 1) != sequence)
+			{
+				// Step faster through data that does not match, as LZ4 does.
+				ip += 1 + (misses++ >> 6);
+				continue;
+			}
+			misses = 0;
+
+			std::size_t ref = candidate - 1;
+			while(ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1])
+			{
+				--ip;
+				--ref;
+			}
+
+			std::size_t length = MinMatch;
+			while(ip + length < matchEnd && src[ip + length] == src[ref + length])
+				++length;
+
+			std::size_t literals = ip - anchor;
+			if(SequenceBound(literals, length) > (std::size_t)(opEnd - op))
+				return 0;
+
+			std::uint8_t* token = op++;
+			*token = (std::uint8_t)((literals >= 15 ? 15 : literals) << 4);
+			if(literals >= 15)
+				op = WriteLength(op, literals - 15);
+
+			std::memcpy(op, src + anchor, literals);
+			op += literals;
+
+			std::size_t offset = ip - ref;
+			*op++ = (std::uint8_t)offset;
+			*op++ = (std::uint8_t)(offset >> 8);
+
+			std::size_t matchCode = length - MinMatch;
+			*token |= (std::uint8_t)(matchCode >= 15 ? 15 : matchCode);
+			if(matchCode >= 15)
+				op = WriteLength(op, matchCode - 15);
+
+			ip += length;
+			anchor = ip;
+
+			// Index a position inside the match so the next one is found sooner.
+			if(ip - 2 <= lastStart)
+				table[Hash(Read32(src + ip - 2))] = (std::uint32_t)(ip - 2 + 1);
+		}
+	}
+
+	std::size_t literals = srcSize - anchor;
+	if(1 + literals / 255 + 1 + literals > (std::size_t)(opEnd - op))
+		return 0;
+
+	*op++ = (std::uint8_t)((literals >= 15 ? 15 : literals) << 4);
+	if(literals >= 15)
+		op = WriteLength(op, literals - 15);
+
+	if(literals != 0)
+		std::memcpy(op, src + anchor, literals);
+	op += literals;
+
+	return (std::size_t)(op - dst);
+}
+
+bool Lz4Decompress(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstSize)
+{
+	const std::uint8_t* ip = src;
+	const std::uint8_t* const ipEnd = src + srcSize;
+	std::uint8_t* op = dst;
+	std::uint8_t* const opEnd = dst + dstSize;
+
+	for(;;)
+	{
+		if(ip == ipEnd)
+			return false;
+
+		std::uint8_t token = *ip++;
+
+		std::size_t literals = token >> 4;
+		if(literals == 15 && !ReadLength(ip, ipEnd, literals))
+			return false;
+
+		if(literals > (std::size_t)(ipEnd - ip) || literals > (std::size_t)(opEnd - op))
+			return false;
+
+		// Short runs, the common case, copy a fixed 16 bytes when both buffers have room.
+		if(literals <= WildCopy && ipEnd - ip >= (std::ptrdiff_t)WildCopy && opEnd - op >= (std::ptrdiff_t)WildCopy)
+			std::memcpy(op, ip, WildCopy);
+		else if(literals != 0)
+			std::memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+
+		// The last sequence has no match.
+		if(ip == ipEnd)
+			return op == opEnd;
+
+		if(ipEnd - ip < 2)
+			return false;
+
+		std::size_t offset = (std::size_t)ip[0] | ((std::size_t)ip[1] << 8);
+		ip += 2;
+		if(offset == 0 || offset > (std::size_t)(op - dst))
+			return false;
+
+		std::size_t length = token & 15;
+		if(length == 15 && !ReadLength(ip, ipEnd, length))
+			return false;
+		length += MinMatch;
+
+		if(length > (std::size_t)(opEnd - op))
+			return false;
+
+		const std::uint8_t* match = op - offset;
+		if(offset >= WildCopy && (std::size_t)(opEnd - op) >= length + WildCopy)
+		{
+			// Fixed-size steps may run up to WildCopy - 1 bytes past the match, which the
+			// next sequence overwrites.
+			for(std::size_t i = 0; i < length; i += WildCopy)
+				std::memcpy(op + i, match + i, WildCopy);
+		}
+		else if(offset >= length)
+		{
+			std::memcpy(op, match, length);
+		}
+		else if(offset >= 8)
+		{
+			// Overlapping, but every 8-byte step reads bytes already written.
+			for(std::size_t i = 0; i < length; i += 8)
+				std::memcpy(op + i, match + i, (length - i < 8) ? length - i : 8);
+		}
+		else
+		{
+			for(std::size_t i = 0; i < length; ++i)
+				op[i] = match[i];
+		}
+
+		op += length;
+	}
+}
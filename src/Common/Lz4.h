@@ -0,0 +1,29 @@
+//***************************************************************************************
+// Lz4.h
+//
+// Self-contained codec for the LZ4 block format: byte-aligned literal runs and matches
+// with 16-bit offsets, no entropy coding.  Decoding is a loop of copies, fast enough to
+// run at several GB/s per core, which is what the texture archive needs to turn disk
+// bandwidth into more texels per second.
+//
+// The compressor is a greedy single-probe hash matcher.  It is meant for the offline
+// archive builder; its output is ordinary LZ4 and decodes with any LZ4 block decoder.
+// The decoder checks every length and offset against both buffers, so corrupt input
+// fails instead of reading or writing out of bounds.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Largest compressed size of srcSize bytes (incompressible input).
+std::size_t Lz4CompressBound(std::size_t srcSize);
+
+// Compresses src into dst.  Returns the compressed size, or 0 if it does not fit in
+// dstCapacity.
+std::size_t Lz4Compress(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstCapacity);
+
+// Decompresses exactly dstSize bytes.  Returns false if src is not a valid block that
+// decodes to dstSize bytes.
+bool Lz4Decompress(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstSize);
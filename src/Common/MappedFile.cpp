@@ -0,0 +1,243 @@
+//***************************************************************************************
+// MappedFile.cpp
+//***************************************************************************************
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& rhs)
+{
+	Swap(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs)
+{
+	if(this != &rhs)
+	{
+		Close();
+		Swap(rhs);
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* fileName)
+{
+	Close();
+
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		mLastError = (int)GetLastError();
+		return false;
+	}
+
+	bool ok = Map(file);
+	CloseHandle(file);
+	return ok;
+}
+
+bool MappedFile::Open(const wchar_t* fileName)
+{
+	Close();
+
+	HANDLE file = CreateFileW(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		mLastError = (int)GetLastError();
+		return false;
+	}
+
+	bool ok = Map(file);
+	CloseHandle(file);
+	return ok;
+}
+
+bool MappedFile::Map(void* file)
+{
+	LARGE_INTEGER fileSize = {};
+	if(!GetFileSizeEx(file, &fileSize))
+	{
+		mLastError = (int)GetLastError();
+		return false;
+	}
+
+	if(fileSize.QuadPart == 0 || (unsigned long long)fileSize.QuadPart > (std::size_t)-1)
+	{
+		mLastError = ERROR_FILE_INVALID;
+		return false;
+	}
+
+	// The view keeps the mapping object alive, so neither handle is needed afterwards.
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping == nullptr)
+	{
+		mLastError = (int)GetLastError();
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if(view == nullptr)
+	{
+		mLastError = (int)GetLastError();
+		return false;
+	}
+
+	mData = static_cast<const std::uint8_t*>(view);
+	mSize = (std::size_t)fileSize.QuadPart;
+	mLastError = 0;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(mData != nullptr)
+		UnmapViewOfFile(mData);
+
+	mData = nullptr;
+	mSize = 0;
+}
+
+void MappedFile::Prefetch(std::size_t offset, std::size_t size)const
+{
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+	if(mData == nullptr || offset >= mSize)
+		return;
+	if(size > mSize - offset)
+		size = mSize - offset;
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<std::uint8_t*>(mData + offset);
+	range.NumberOfBytes = size;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	(void)offset;
+	(void)size;
+#endif
+}
+
+#else
+
+bool MappedFile::Open(const char* fileName)
+{
+	Close();
+
+	int fd = open(fileName, O_RDONLY);
+	if(fd < 0)
+	{
+		mLastError = errno;
+		return false;
+	}
+
+	bool ok = Map(&fd);
+	close(fd);
+	return ok;
+}
+
+bool MappedFile::Map(void* file)
+{
+	int fd = *static_cast<int*>(file);
+
+	struct stat st;
+	if(fstat(fd, &st) != 0)
+	{
+		mLastError = errno;
+		return false;
+	}
+
+	if(st.st_size == 0)
+	{
+		mLastError = EINVAL;
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	void* view = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(view == MAP_FAILED)
+	{
+		mLastError = errno;
+		return false;
+	}
+
+	mData = static_cast<const std::uint8_t*>(view);
+	mSize = (std::size_t)st.st_size;
+	mLastError = 0;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(mData != nullptr)
+		munmap(const_cast<std::uint8_t*>(mData), mSize);
+
+	mData = nullptr;
+	mSize = 0;
+}
+
+void MappedFile::Prefetch(std::size_t offset, std::size_t size)const
+{
+	if(mData == nullptr || offset >= mSize)
+		return;
+	if(size > mSize - offset)
+		size = mSize - offset;
+
+	// madvise wants a page-aligned start.
+	std::size_t page = (std::size_t)sysconf(_SC_PAGESIZE);
+	std::size_t begin = offset & ~(page - 1);
+	madvise(const_cast<std::uint8_t*>(mData + begin), size + (offset - begin), MADV_WILLNEED);
+}
+
+#endif
+
+bool MappedFile::IsOpen()const
+{
+	return mData != nullptr;
+}
+
+const std::uint8_t* MappedFile::Data()const
+{
+	return mData;
+}
+
+std::size_t MappedFile::Size()const
+{
+	return mSize;
+}
+
+int MappedFile::LastError()const
+{
+	return mLastError;
+}
+
+void MappedFile::Swap(MappedFile& rhs)
+{
+	const std::uint8_t* data = mData;
+	std::size_t size = mSize;
+	int lastError = mLastError;
+
+	mData = rhs.mData;
+	mSize = rhs.mSize;
+	mLastError = rhs.mLastError;
+
+	rhs.mData = data;
+	rhs.mSize = size;
+	rhs.mLastError = lastError;
+}
@@ -0,0 +1,55 @@
+//***************************************************************************************
+// MappedFile.h
+//
+// Read-only memory mapping of a whole file: a file mapping view on Windows, mmap
+// elsewhere.  Data() points straight at the mapped pages, so parsers can work in
+// place and hand out pointers into the file instead of copying it to the heap first.
+// Pages are only read from disk when touched, so a reader that skips parts of the
+// file never pays for them.
+//
+// Pointers into the mapping are valid until Close or destruction.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile& rhs) = delete;
+	MappedFile& operator=(const MappedFile& rhs) = delete;
+	MappedFile(MappedFile&& rhs);
+	MappedFile& operator=(MappedFile&& rhs);
+	~MappedFile();
+
+	// Maps the file, closing any previously mapped one.  Fails for empty files, which
+	// cannot be mapped.  On failure LastError holds the OS error code.
+	bool Open(const char* fileName);
+#ifdef _WIN32
+	bool Open(const wchar_t* fileName);
+#endif
+
+	void Close();
+
+	bool IsOpen()const;
+	const std::uint8_t* Data()const;
+	std::size_t Size()const;
+
+	// GetLastError() on Windows, errno elsewhere; 0 if the last Open succeeded.
+	int LastError()const;
+
+	// Asks the OS to start reading [offset, offset + size) before it is touched.
+	void Prefetch(std::size_t offset, std::size_t size)const;
+
+private:
+	bool Map(void* file);
+	void Swap(MappedFile& rhs);
+
+private:
+	const std::uint8_t* mData = nullptr;
+	std::size_t mSize = 0;
+	int mLastError = 0;
+};
@@ -9,6 +9,7 @@
 #include <Windows.h>
 #include <DirectXMath.h>
 #include <cstdint>
+#include "FastMath.h"
 
 class MathHelper
 {
@@ -59,10 +60,14 @@ public:
 
 	static DirectX::XMVECTOR SphericalToCartesian(float radius, float theta, float phi)
 	{
+		float sinTheta, cosTheta, sinPhi, cosPhi;
+		FastMath::SinCos(theta, &sinTheta, &cosTheta);
+		FastMath::SinCos(phi, &sinPhi, &cosPhi);
+
 		return DirectX::XMVectorSet(
-			radius*sinf(phi)*cosf(theta),
-			radius*cosf(phi),
-			radius*sinf(phi)*sinf(theta),
+			radius*sinPhi*cosTheta,
+			radius*cosPhi,
+			radius*sinPhi*sinTheta,
 			1.0f);
 	}
 
@@ -0,0 +1,488 @@
+//***************************************************************************************
+// MipGenerator.cpp
+//***************************************************************************************
+
+#include "MipGenerator.h"
+#include "BCDecoder.h"
+#include "BCEncoder.h"
+#include "DDSFormat.h"
+#include "DDSWriter.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+using namespace DirectX;
+
+namespace
+{
+	// Kaiser-windowed sinc: radius in destination texels and window shape, the values
+	// common mip tools default to.
+	const float KaiserWidth = 3.0f;
+	const float KaiserAlpha = 4.0f;
+
+	// Rows handed to a job at a time, so large mips do not queue a job per row.
+	const std::uint32_t RowsPerJob = 8;
+
+	float Sinc(float x)
+	{
+		if(std::fabs(x) < 1e-4f)
+			return 1.0f;
+
+		x *= XM_PI;
+		return std::sin(x) / x;
+	}
+
+	// Modified Bessel function of the first kind, order 0.
+	float BesselI0(float x)
+	{
+		float sum = 1.0f;
+		float term = 1.0f;
+		float halfX = 0.5f * x;
+		for(int k = 1; k < 32 && term > 1e-7f * sum; ++k)
+		{
+			term *= (halfX / k) * (halfX / k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	float KaiserSinc(float t)
+	{
+		if(std::fabs(t) >= KaiserWidth)
+			return 0.0f;
+
+		float r = t / KaiserWidth;
+		return Sinc(t) * BesselI0(KaiserAlpha * std::sqrt(1.0f - r * r)) / BesselI0(KaiserAlpha);
+	}
+
+	// The source texels along one axis that make up each destination texel, with their
+	// normalized weights.  Unused taps have a weight of 0.
+	struct Taps
+	{
+		std::uint32_t PerTexel = 0;
+		std::vector<std::uint32_t> Index;
+		std::vector<float> Weight;
+	};
+
+	void ComputeTaps(std::uint32_t srcSize, std::uint32_t destSize, MipGenerator::Filter filter, bool wrap, Taps& taps)
+	{
+		const float scale = (float)srcSize / (float)destSize;
+		const float radius = (filter == MipGenerator::Filter::Box) ? 0.5f * scale : KaiserWidth * scale;
+
+		taps.PerTexel = (std::uint32_t)std::ceil(2.0f * radius) + 2;
+		taps.Index.assign((std::size_t)destSize * taps.PerTexel, 0);
+		taps.Weight.assign((std::size_t)destSize * taps.PerTexel, 0.0f);
+
+		for(std::uint32_t d = 0; d < destSize; ++d)
+		{
+			std::uint32_t* index = taps.Index.data() + (std::size_t)d * taps.PerTexel;
+			float* weight = taps.Weight.data() + (std::size_t)d * taps.PerTexel;
+
+			const float center = (d + 0.5f) * scale;
+			const int first = (int)std::floor(center - radius);
+			const int last = (int)std::ceil(center + radius);
+
+			float sum = 0.0f;
+			std::uint32_t count = 0;
+			for(int i = first; i < last && count < taps.PerTexel; ++i)
+			{
+				float w;
+				if(filter == MipGenerator::Filter::Box)
+				{
+					// The part of texel i the destination texel covers.
+					w = std::min(i + 1.0f, center + radius) - std::max((float)i, center - radius);
+				}
+				else
+				{
+					w = KaiserSinc((i + 0.5f - center) / scale);
+				}
+
+				if(w <= 0.0f && filter == MipGenerator::Filter::Box)
+					continue;
+
+				int size = (int)srcSize;
+				index[count] = (std::uint32_t)(wrap ? ((i % size) + size) % size : std::min(std::max(i, 0), size - 1));
+				weight[count] = w;
+				sum += w;
+				++count;
+			}
+
+			for(std::uint32_t t = 0; t < count; ++t)
+				weight[t] /= sum;
+		}
+	}
+
+	// Calls row(slice, y) for every row of every slice, RowsPerJob rows per job.
+	void ForEachRow(JobSystem* jobs, std::uint32_t sliceCount, std::uint32_t height,
+		const std::function<void(std::uint32_t, std::uint32_t)>& row)
+	{
+		const std::uint32_t chunksPerSlice = (height + RowsPerJob - 1) / RowsPerJob;
+		auto chunk = [&](std::uint32_t i)
+		{
+			std::uint32_t slice = i / chunksPerSlice;
+			std::uint32_t first = (i % chunksPerSlice) * RowsPerJob;
+			std::uint32_t last = std::min(first + RowsPerJob, height);
+			for(std::uint32_t y = first; y < last; ++y)
+				row(slice, y);
+		};
+
+		if(jobs != nullptr)
+		{
+			jobs->ParallelFor(sliceCount * chunksPerSlice, chunk);
+		}
+		else
+		{
+			for(std::uint32_t i = 0; i < sliceCount * chunksPerSlice; ++i)
+				chunk(i);
+		}
+	}
+
+	void ToLinearRow(const RgbaImage& image, std::uint32_t y, bool gammaCorrect, RgbaFloatImage& linear)
+	{
+		const XMVECTOR scale = XMVectorReplicate(1.0f / 255.0f);
+		const std::uint8_t* src = image.Pixel(0, y);
+		float* dest = linear.Pixel(0, y);
+		for(std::uint32_t x = 0; x < image.Width; ++x, src += 4, dest += 4)
+		{
+			XMVECTOR v = XMVectorMultiply(XMVectorSet(src[0], src[1], src[2], src[3]), scale);
+			if(gammaCorrect)
+				v = XMColorSRGBToRGB(v);
+			XMStoreFloat4((XMFLOAT4*)dest, v);
+		}
+	}
+
+	void FromLinearRow(const RgbaFloatImage& linear, std::uint32_t y, bool gammaCorrect, float alphaScale, RgbaImage& image)
+	{
+		const XMVECTOR scale = XMVectorSet(1.0f, 1.0f, 1.0f, alphaScale);
+		const XMVECTOR max = XMVectorReplicate(255.0f);
+		const float* src = linear.Pixel(0, y);
+		std::uint8_t* dest = image.Pixel(0, y);
+		for(std::uint32_t x = 0; x < linear.Width; ++x, src += 4, dest += 4)
+		{
+			XMVECTOR v = XMVectorSaturate(XMVectorMultiply(XMLoadFloat4((const XMFLOAT4*)src), scale));
+			if(gammaCorrect)
+				v = XMColorRGBToSRGB(v);
+			v = XMVectorRound(XMVectorMultiply(v, max));
+
+			XMFLOAT4 f;
+			XMStoreFloat4(&f, v);
+			dest[0] = (std::uint8_t)f.x;
+			dest[1] = (std::uint8_t)f.y;
+			dest[2] = (std::uint8_t)f.z;
+			dest[3] = (std::uint8_t)f.w;
+		}
+	}
+
+	// Fraction of texels whose alpha, times scale, passes an alpha test against
+	// reference.
+	float AlphaCoverage(const RgbaFloatImage& image, float reference, float scale)
+	{
+		std::size_t passed = 0;
+		for(std::size_t i = 3; i < image.Pixels.size(); i += 4)
+		{
+			if(image.Pixels[i] * scale > reference)
+				++passed;
+		}
+		return (float)passed / (float)(image.Pixels.size() / 4);
+	}
+
+	// The alpha scale that brings the coverage of image closest to coverage, by
+	// bisection; coverage only grows with the scale.
+	float CoverageScale(const RgbaFloatImage& image, float reference, float coverage)
+	{
+		float low = 0.0f;
+		float high = 4.0f;
+		for(int i = 0; i < 16; ++i)
+		{
+			float mid = 0.5f * (low + high);
+			if(AlphaCoverage(image, reference, mid) < coverage)
+				low = mid;
+			else
+				high = mid;
+		}
+		return 0.5f * (low + high);
+	}
+
+	bool IsSrgb(DXGI_FORMAT format)
+	{
+		switch(format)
+		{
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return true;
+		default:
+			return false;
+		}
+	}
+}
+
+std::uint32_t MipGenerator::FullMipCount(std::uint32_t width, std::uint32_t height)
+{
+	std::uint32_t count = 1;
+	for(std::uint32_t size = std::max(width, height); size > 1; size >>= 1)
+		++count;
+	return count;
+}
+
+void MipGenerator::Generate(const std::vector<RgbaImage>& slices, const Options& options,
+	std::vector<std::vector<RgbaImage>>& mips, JobSystem* jobs)
+{
+	mips.clear();
+	if(slices.empty())
+		return;
+
+	const std::uint32_t sliceCount = (std::uint32_t)slices.size();
+	std::uint32_t width = slices[0].Width;
+	std::uint32_t height = slices[0].Height;
+
+	std::uint32_t mipCount = FullMipCount(width, height);
+	if(options.MipCount != 0)
+		mipCount = std::min(mipCount, options.MipCount);
+
+	mips.resize(sliceCount);
+	for(std::uint32_t s = 0; s < sliceCount; ++s)
+	{
+		mips[s].reserve(mipCount);
+		mips[s].push_back(slices[s]);
+	}
+
+	// The current level of every slice in linear float, the rows filtered horizontally
+	// and the next level.
+	std::vector<RgbaFloatImage> current(sliceCount), filtered(sliceCount), next(sliceCount);
+	for(RgbaFloatImage& image : current)
+		image.Resize(width, height);
+
+	ForEachRow(jobs, sliceCount, height, [&](std::uint32_t s, std::uint32_t y)
+	{
+		ToLinearRow(slices[s], y, options.GammaCorrect, current[s]);
+	});
+
+	const bool preserveCoverage = options.AlphaReference > 0.0f;
+	std::vector<float> coverage(sliceCount, 0.0f);
+	std::vector<float> alphaScale(sliceCount, 1.0f);
+	if(preserveCoverage)
+	{
+		for(std::uint32_t s = 0; s < sliceCount; ++s)
+			coverage[s] = AlphaCoverage(current[s], options.AlphaReference, 1.0f);
+	}
+
+	Taps horizontal, vertical;
+	for(std::uint32_t mip = 1; mip < mipCount; ++mip)
+	{
+		const std::uint32_t destWidth = std::max(1u, width / 2);
+		const std::uint32_t destHeight = std::max(1u, height / 2);
+		ComputeTaps(width, destWidth, options.MipFilter, options.Wrap, horizontal);
+		ComputeTaps(height, destHeight, options.MipFilter, options.Wrap, vertical);
+
+		for(std::uint32_t s = 0; s < sliceCount; ++s)
+		{
+			filtered[s].Resize(destWidth, height);
+			next[s].Resize(destWidth, destHeight);
+		}
+
+		ForEachRow(jobs, sliceCount, height, [&](std::uint32_t s, std::uint32_t y)
+		{
+			const float* src = current[s].Pixel(0, y);
+			float* dest = filtered[s].Pixel(0, y);
+			for(std::uint32_t x = 0; x < destWidth; ++x)
+			{
+				const std::uint32_t* index = horizontal.Index.data() + (std::size_t)x * horizontal.PerTexel;
+				const float* weight = horizontal.Weight.data() + (std::size_t)x * horizontal.PerTexel;
+
+				XMVECTOR sum = XMVectorZero();
+				for(std::uint32_t t = 0; t < horizontal.PerTexel; ++t)
+				{
+					XMVECTOR texel = XMLoadFloat4((const XMFLOAT4*)(src + 4 * index[t]));
+					sum = XMVectorMultiplyAdd(texel, XMVectorReplicate(weight[t]), sum);
+				}
+				XMStoreFloat4((XMFLOAT4*)(dest + 4 * x), sum);
+			}
+		});
+
+		ForEachRow(jobs, sliceCount, destHeight, [&](std::uint32_t s, std::uint32_t y)
+		{
+			const std::uint32_t* index = vertical.Index.data() + (std::size_t)y * vertical.PerTexel;
+			const float* weight = vertical.Weight.data() + (std::size_t)y * vertical.PerTexel;
+			float* dest = next[s].Pixel(0, y);
+
+			for(std::uint32_t t = 0; t < vertical.PerTexel; ++t)
+			{
+				if(weight[t] == 0.0f)
+					continue;
+
+				const XMVECTOR w = XMVectorReplicate(weight[t]);
+				const float* src = filtered[s].Pixel(0, index[t]);
+				for(std::uint32_t x = 0; x < destWidth; ++x)
+				{
+					XMVECTOR sum = XMLoadFloat4((const XMFLOAT4*)(dest + 4 * x));
+					sum = XMVectorMultiplyAdd(XMLoadFloat4((const XMFLOAT4*)(src + 4 * x)), w, sum);
+					XMStoreFloat4((XMFLOAT4*)(dest + 4 * x), sum);
+				}
+			}
+		});
+
+		std::swap(current, next);
+		width = destWidth;
+		height = destHeight;
+
+		// The next level is filtered from the unscaled alpha; only the output is scaled.
+		if(preserveCoverage)
+		{
+			auto scaleSlice = [&](std::uint32_t s)
+			{
+				alphaScale[s] = CoverageScale(current[s], options.AlphaReference, coverage[s]);
+			};
+
+			if(jobs != nullptr)
+			{
+				jobs->ParallelFor(sliceCount, scaleSlice);
+			}
+			else
+			{
+				for(std::uint32_t s = 0; s < sliceCount; ++s)
+					scaleSlice(s);
+			}
+		}
+
+		for(std::uint32_t s = 0; s < sliceCount; ++s)
+		{
+			mips[s].emplace_back();
+			mips[s].back().Resize(width, height);
+		}
+
+		ForEachRow(jobs, sliceCount, height, [&](std::uint32_t s, std::uint32_t y)
+		{
+			FromLinearRow(current[s], y, options.GammaCorrect, alphaScale[s], mips[s][mip]);
+		});
+	}
+}
+
+bool MipGenerator::GenerateDDS(const std::string& fileName, const std::string& outFileName,
+	const Options& options, JobSystem* jobs, std::string& error)
+{
+	MappedFile file;
+	if(!file.Open(fileName.c_str()))
+	{
+		error = "cannot open " + fileName + " (error " + std::to_string(file.LastError()) + ")";
+		return false;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	std::size_t headerSize = 0;
+	DDSTextureDesc desc;
+	DDSLayout layout;
+	if(!ValidateDDSHeader(file.Data(), file.Size(), &header, &headerSize) ||
+		GetDDSTextureDesc(header, desc) != DDSStatus::Ok ||
+		!GetDDSLayout(desc, 0, layout) ||
+		layout.TotalBytes > file.Size() - headerSize)
+	{
+		error = fileName + " is not a valid DDS file";
+		return false;
+	}
+
+	if(desc.Dimension != DDS_DIMENSION_TEXTURE2D)
+	{
+		error = fileName + " is not a 2D texture, texture array or cube map";
+		return false;
+	}
+
+	// The format written back.  BC6H and the SNORM formats hold values that 8-bit
+	// RGBA cannot, so they are refused rather than clamped.
+	const bool srgb = IsSrgb(desc.Format);
+	bool encode = true;
+	BCEncoder::Format blockFormat = BCEncoder::Format::BC1;
+	DXGI_FORMAT outFormat;
+	switch(desc.Format)
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		blockFormat = BCEncoder::Format::BC1;
+		break;
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+		blockFormat = BCEncoder::Format::BC3;
+		break;
+	case DXGI_FORMAT_BC5_UNORM:
+		blockFormat = BCEncoder::Format::BC5;
+		break;
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		encode = false;
+		break;
+	default:
+		error = fileName + " has a format the mip generator does not support (DXGI_FORMAT " +
+			std::to_string((int)desc.Format) + ")";
+		return false;
+	}
+
+	outFormat = encode ? BCEncoder::GetDXGIFormat(blockFormat, srgb) :
+		(srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM);
+
+	// The top mip of every slice; the file's other mips are replaced.
+	const std::uint8_t* bits = file.Data() + headerSize;
+	std::vector<RgbaImage> slices(desc.ArraySize);
+	for(std::uint32_t s = 0; s < desc.ArraySize; ++s)
+	{
+		const DDSSubresource& top = layout.Subresources[(std::size_t)s * layout.MipCount];
+		if(BCDecoder::BlockSize(desc.Format) != 0)
+			BCDecoder::Decode(desc.Format, bits + top.Offset, top.RowPitch, top.Width, top.Height, slices[s], jobs);
+		else
+			CopyRgba8Surface(desc.Format, bits + top.Offset, top.RowPitch, top.Width, top.Height, slices[s]);
+	}
+
+	std::vector<std::vector<RgbaImage>> mips;
+	Generate(slices, options, mips, jobs);
+
+	DDSTextureDesc outDesc = desc;
+	outDesc.Format = outFormat;
+	outDesc.MipCount = (std::uint32_t)mips[0].size();
+
+	DDSLayout outLayout;
+	if(!GetDDSLayout(outDesc, 0, outLayout))
+	{
+		error = outFileName + ": the generated mips do not form a valid texture";
+		return false;
+	}
+
+	std::vector<std::uint8_t> outBits(outLayout.TotalBytes);
+	for(std::uint32_t s = 0; s < outDesc.ArraySize; ++s)
+	{
+		for(std::uint32_t mip = 0; mip < outDesc.MipCount; ++mip)
+		{
+			const DDSSubresource& sub = outLayout.Subresources[(std::size_t)s * outDesc.MipCount + mip];
+			const RgbaImage& image = mips[s][mip];
+			std::uint8_t* dest = outBits.data() + sub.Offset;
+
+			if(encode)
+			{
+				std::vector<std::uint8_t> encoded = BCEncoder::Encode(image, blockFormat, jobs);
+				std::memcpy(dest, encoded.data(), std::min<std::size_t>(encoded.size(), sub.Size));
+			}
+			else
+			{
+				for(std::uint32_t y = 0; y < image.Height; ++y)
+					std::memcpy(dest + y * sub.RowPitch, image.Pixel(0, y), 4 * (std::size_t)image.Width);
+			}
+		}
+	}
+
+	return WriteDDSFile(outFileName, outDesc, outBits.data(), outBits.size(), error);
+}
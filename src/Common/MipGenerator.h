@@ -0,0 +1,75 @@
+//***************************************************************************************
+// MipGenerator.h
+//
+// Offline mip chain generation.  The DDS loaders upload the mips a file has and no
+// more, so a file without a full chain aliases at a distance and misses the texture
+// cache.  GenerateDDS rebuilds the whole chain of every array slice or cube face of a
+// file and writes it back out.
+//
+// Each mip is filtered from the one above it in linear light: 8-bit color is decoded
+// from sRGB first and encoded again afterwards, unless the options say the data is
+// linear (normal maps, masks).  Alpha is always linear.  The filters are separable:
+// a box filter with exact area weights, or a Kaiser-windowed sinc that keeps mips
+// sharper.  Texels past an edge repeat the edge texel, or wrap for tiling textures;
+// cube faces are filtered as independent slices.
+//
+// Alpha-tested foliage thins out as its mips average alpha towards the test value.
+// With an alpha reference set, each mip's alpha is scaled so the fraction of texels
+// passing the test matches the top mip.
+//
+// Texels are processed as DirectXMath vectors, one RGBA texel per vector.  Every pass
+// runs the rows of all slices through one ParallelFor.
+//***************************************************************************************
+
+#pragma once
+
+#include "RgbaImage.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+class MipGenerator
+{
+public:
+	enum class Filter
+	{
+		Box,
+		Kaiser
+	};
+
+	struct Options
+	{
+		Filter MipFilter = Filter::Kaiser;
+
+		// Color is sRGB-encoded and is filtered in linear light.  Clear for linear data.
+		bool GammaCorrect = true;
+
+		// Texels past the edges wrap around instead of repeating the edge texel.
+		bool Wrap = false;
+
+		// Alpha test value whose coverage is preserved, in (0, 1); 0 disables.
+		float AlphaReference = 0.0f;
+
+		// Mips to generate, the top one included; 0 for the full chain down to 1x1.
+		std::uint32_t MipCount = 0;
+	};
+
+	// Number of mips in the full chain of a width x height surface.
+	static std::uint32_t FullMipCount(std::uint32_t width, std::uint32_t height);
+
+	// Builds the chain of each slice of slices, which must all be the same size.
+	// mips[slice][0] is a copy of slices[slice]; each next mip is half the size of the
+	// one above, rounded down, and at least 1.
+	static void Generate(const std::vector<RgbaImage>& slices, const Options& options,
+		std::vector<std::vector<RgbaImage>>& mips, JobSystem* jobs = nullptr);
+
+	// Reads a 2D texture or texture array (cube maps included), rebuilds the chain of
+	// each slice from its top mip and writes the result to outFileName.  BC1, BC3 and
+	// BC5 keep their format; BC2 is written as BC3, which also has 8-bit alpha; BC4, BC7
+	// and 8-bit RGBA or BGRA become R8G8B8A8.  sRGB formats stay sRGB.  SNORM formats and
+	// BC6H are refused.
+	static bool GenerateDDS(const std::string& fileName, const std::string& outFileName,
+		const Options& options, JobSystem* jobs, std::string& error);
+};
@@ -0,0 +1,48 @@
+//***************************************************************************************
+// NullCommandSink.h
+//
+// ICommandSink that discards everything and only counts the calls it received.  Used
+// to drive recording code, e.g. ParallelRecorder, without a device or the storage
+// cost of RecordingCommandSink.
+//***************************************************************************************
+
+#pragma once
+
+#include "CommandSink.h"
+
+class NullCommandSink : public ICommandSink
+{
+public:
+	virtual void SetPipelineState(StateHandle pso) override { ++mBindCount; }
+	virtual void SetRootSignature(StateHandle rootSignature) override { ++mBindCount; }
+	virtual void SetDescriptorHeap(StateHandle heap) override { ++mBindCount; }
+	virtual void SetVertexBuffer(std::uint32_t slot, const VertexBufferBinding& binding) override { ++mBindCount; }
+	virtual void SetIndexBuffer(const IndexBufferBinding& binding) override { ++mBindCount; }
+	virtual void SetPrimitiveTopology(std::uint32_t topology) override { ++mBindCount; }
+	virtual void SetRootConstantBuffer(std::uint32_t rootIndex, std::uint64_t gpuAddress) override { ++mBindCount; }
+	virtual void SetRootShaderResource(std::uint32_t rootIndex, std::uint64_t gpuAddress) override { ++mBindCount; }
+	virtual void SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle) override { ++mBindCount; }
+
+	virtual void DrawIndexed(std::uint32_t indexCount, std::uint32_t instanceCount,
+		std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) override
+	{
+		++mDrawCount;
+		mInstanceCount += instanceCount;
+	}
+
+	void Clear()
+	{
+		mBindCount = 0;
+		mDrawCount = 0;
+		mInstanceCount = 0;
+	}
+
+	std::uint64_t BindCount()const { return mBindCount; }
+	std::uint64_t DrawCount()const { return mDrawCount; }
+	std::uint64_t InstanceCount()const { return mInstanceCount; }
+
+private:
+	std::uint64_t mBindCount = 0;
+	std::uint64_t mDrawCount = 0;
+	std::uint64_t mInstanceCount = 0;
+};
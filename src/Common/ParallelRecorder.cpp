@@ -0,0 +1,86 @@
+//***************************************************************************************
+// ParallelRecorder.cpp
+//***************************************************************************************
+
+#include "ParallelRecorder.h"
+#include "JobSystem.h"
+#include <cassert>
+
+std::vector<DrawSlice> PartitionDraws(std::uint32_t drawCount, std::uint32_t maxSlices,
+	std::uint32_t minDrawsPerSlice)
+{
+	std::vector<DrawSlice> slices;
+	if(drawCount == 0 || maxSlices == 0)
+		return slices;
+
+	if(minDrawsPerSlice == 0)
+		minDrawsPerSlice = 1;
+
+	std::uint32_t count = drawCount / minDrawsPerSlice;
+	if(count < 1)
+		count = 1;
+	if(count > maxSlices)
+		count = maxSlices;
+
+	slices.resize(count);
+	for(std::uint32_t i = 0; i < count; ++i)
+	{
+		slices[i].Begin = (std::uint32_t)((std::uint64_t)drawCount * i / count);
+		slices[i].End = (std::uint32_t)((std::uint64_t)drawCount * (i + 1) / count);
+	}
+
+	return slices;
+}
+
+ParallelRecorder::ParallelRecorder(JobSystem& jobs, std::uint32_t maxSlices, std::uint32_t minDrawsPerSlice)
+	: mJobs(jobs), mMaxSlices(maxSlices), mMinDrawsPerSlice(minDrawsPerSlice), mContexts(maxSlices)
+{
+	assert(maxSlices > 0);
+}
+
+std::uint32_t ParallelRecorder::Record(const DrawQueue& queue, ISinkProvider& provider, const RecordFunction& record)
+{
+	mSlices = PartitionDraws((std::uint32_t)queue.Size(), mMaxSlices, mMinDrawsPerSlice);
+
+	mJobs.ParallelFor((std::uint32_t)mSlices.size(), [&](std::uint32_t slot)
+	{
+		CommandContext& context = mContexts[slot];
+
+		// Every slice starts on a fresh command list with no state bound.
+		context.SetSink(provider.BeginSlice(slot));
+
+		const DrawSlice& slice = mSlices[slot];
+		for(std::uint32_t i = slice.Begin; i < slice.End; ++i)
+			record(context, i);
+
+		provider.EndSlice(slot);
+	});
+
+	return (std::uint32_t)mSlices.size();
+}
+
+std::uint32_t ParallelRecorder::MaxSlices()const
+{
+	return mMaxSlices;
+}
+
+const std::vector<DrawSlice>& ParallelRecorder::Slices()const
+{
+	return mSlices;
+}
+
+CommandContext::Stats ParallelRecorder::GetStats()const
+{
+	CommandContext::Stats total;
+	for(const CommandContext& context : mContexts)
+	{
+		const CommandContext::Stats& s = context.GetStats();
+		for(int i = 0; i < CommandContext::BindTypeCount; ++i)
+		{
+			total.Issued[i] += s.Issued[i];
+			total.Saved[i] += s.Saved[i];
+		}
+		total.Draws += s.Draws;
+	}
+	return total;
+}
@@ -0,0 +1,73 @@
+//***************************************************************************************
+// ParallelRecorder.h
+//
+// Records a sorted DrawQueue on several threads at once.  The queue is cut into
+// contiguous slices; each slice is recorded by one job into the command sink of its
+// slot, through a CommandContext owned by that slot.  Slots are numbered in draw order,
+// so submitting the slots' command lists in slot order reproduces the sorted order.
+//
+// The recorder only knows about ICommandSink.  Where the sinks come from, and what
+// happens to them before and after a slice, is up to the ISinkProvider; for D3D12
+// that is a command list and allocator per slot (D3D12CommandListPool), and for tests
+// a NullCommandSink or RecordingCommandSink per slot.
+//***************************************************************************************
+
+#pragma once
+
+#include "CommandContext.h"
+#include "DrawQueue.h"
+#include <functional>
+#include <vector>
+
+class JobSystem;
+
+struct DrawSlice
+{
+	std::uint32_t Begin;
+	std::uint32_t End; // One past the last draw.
+};
+
+// Splits drawCount draws into at most maxSlices contiguous slices of nearly equal size,
+// using fewer slices when a slice would get less than minDrawsPerSlice draws.  Returns
+// no slices when drawCount is 0.
+std::vector<DrawSlice> PartitionDraws(std::uint32_t drawCount, std::uint32_t maxSlices,
+	std::uint32_t minDrawsPerSlice);
+
+class ParallelRecorder
+{
+public:
+	class ISinkProvider
+	{
+	public:
+		virtual ~ISinkProvider() = default;
+
+		// Called on the recording thread before and after slot's slice.  Different
+		// slots are recorded concurrently; one slot is only used by one thread.
+		virtual ICommandSink* BeginSlice(std::uint32_t slot) = 0;
+		virtual void EndSlice(std::uint32_t slot) = 0;
+	};
+
+	// Records the draw at drawIndex (a position in the sorted queue) into context.
+	using RecordFunction = std::function<void(CommandContext& context, std::uint32_t drawIndex)>;
+
+	ParallelRecorder(JobSystem& jobs, std::uint32_t maxSlices, std::uint32_t minDrawsPerSlice = 64);
+
+	// Records queue, which must be sorted, and returns the number of slots used.  The
+	// caller then submits slots [0, count) in order.  record is called concurrently
+	// from different slots and must not touch shared state without synchronization.
+	std::uint32_t Record(const DrawQueue& queue, ISinkProvider& provider, const RecordFunction& record);
+
+	std::uint32_t MaxSlices()const;
+	const std::vector<DrawSlice>& Slices()const;
+
+	// Bind counters summed over all slots.
+	CommandContext::Stats GetStats()const;
+
+private:
+	JobSystem& mJobs;
+	std::uint32_t mMaxSlices;
+	std::uint32_t mMinDrawsPerSlice;
+
+	std::vector<DrawSlice> mSlices;
+	std::vector<CommandContext> mContexts;
+};
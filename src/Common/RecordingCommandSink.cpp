@@ -0,0 +1,110 @@
+//***************************************************************************************
+// RecordingCommandSink.cpp
+//***************************************************************************************
+
+#include "RecordingCommandSink.h"
+
+void RecordingCommandSink::SetPipelineState(StateHandle pso)
+{
+	Record(CommandType::SetPipelineState, pso);
+}
+
+void RecordingCommandSink::SetRootSignature(StateHandle rootSignature)
+{
+	Record(CommandType::SetRootSignature, rootSignature);
+}
+
+void RecordingCommandSink::SetDescriptorHeap(StateHandle heap)
+{
+	Record(CommandType::SetDescriptorHeap, heap);
+}
+
+void RecordingCommandSink::SetVertexBuffer(std::uint32_t slot, const VertexBufferBinding& binding)
+{
+	Record(CommandType::SetVertexBuffer, slot, binding.Address, binding.SizeInBytes, binding.StrideInBytes);
+}
+
+void RecordingCommandSink::SetIndexBuffer(const IndexBufferBinding& binding)
+{
+	Record(CommandType::SetIndexBuffer, binding.Address, binding.SizeInBytes, binding.Format);
+}
+
+void RecordingCommandSink::SetPrimitiveTopology(std::uint32_t topology)
+{
+	Record(CommandType::SetPrimitiveTopology, topology);
+}
+
+void RecordingCommandSink::SetRootConstantBuffer(std::uint32_t rootIndex, std::uint64_t gpuAddress)
+{
+	Record(CommandType::SetRootConstantBuffer, rootIndex, gpuAddress);
+}
+
+void RecordingCommandSink::SetRootShaderResource(std::uint32_t rootIndex, std::uint64_t gpuAddress)
+{
+	Record(CommandType::SetRootShaderResource, rootIndex, gpuAddress);
+}
+
+void RecordingCommandSink::SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle)
+{
+	Record(CommandType::SetRootDescriptorTable, rootIndex, gpuHandle);
+}
+
+void RecordingCommandSink::DrawIndexed(std::uint32_t indexCount, std::uint32_t instanceCount,
+	std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance)
+{
+	Record(CommandType::DrawIndexed, indexCount, instanceCount, startIndex, (std::uint64_t)(std::int64_t)baseVertex, startInstance);
+}
+
+void RecordingCommandSink::Clear()
+{
+	mCommands.clear();
+	for(std::size_t& c : mCounts)
+		c = 0;
+}
+
+const std::vector<RecordingCommandSink::Command>& RecordingCommandSink::Commands()const
+{
+	return mCommands;
+}
+
+std::size_t RecordingCommandSink::Count(CommandType type)const
+{
+	return mCounts[(int)type];
+}
+
+std::size_t RecordingCommandSink::BindCount()const
+{
+	return mCommands.size() - mCounts[(int)CommandType::DrawIndexed];
+}
+
+const char* RecordingCommandSink::CommandName(CommandType type)
+{
+	switch(type)
+	{
+	case CommandType::SetPipelineState:       return "SetPipelineState";
+	case CommandType::SetRootSignature:       return "SetRootSignature";
+	case CommandType::SetDescriptorHeap:      return "SetDescriptorHeap";
+	case CommandType::SetVertexBuffer:        return "SetVertexBuffer";
+	case CommandType::SetIndexBuffer:         return "SetIndexBuffer";
+	case CommandType::SetPrimitiveTopology:   return "SetPrimitiveTopology";
+	case CommandType::SetRootConstantBuffer:  return "SetRootConstantBuffer";
+	case CommandType::SetRootShaderResource:  return "SetRootShaderResource";
+	case CommandType::SetRootDescriptorTable: return "SetRootDescriptorTable";
+	case CommandType::DrawIndexed:            return "DrawIndexed";
+	default:                                  return "Unknown";
+	}
+}
+
+void RecordingCommandSink::Record(CommandType type, std::uint64_t a0, std::uint64_t a1, std::uint64_t a2,
+	std::uint64_t a3, std::uint64_t a4)
+{
+	Command c;
+	c.Type = type;
+	c.Args[0] = a0;
+	c.Args[1] = a1;
+	c.Args[2] = a2;
+	c.Args[3] = a3;
+	c.Args[4] = a4;
+	mCommands.push_back(c);
+	++mCounts[(int)type];
+}
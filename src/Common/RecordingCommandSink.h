@@ -0,0 +1,67 @@
+//***************************************************************************************
+// RecordingCommandSink.h
+//
+// ICommandSink that appends every call to a list instead of executing it.  Used to
+// check and time command generation without a device.
+//***************************************************************************************
+
+#pragma once
+
+#include "CommandSink.h"
+#include <vector>
+
+class RecordingCommandSink : public ICommandSink
+{
+public:
+	enum class CommandType
+	{
+		SetPipelineState,
+		SetRootSignature,
+		SetDescriptorHeap,
+		SetVertexBuffer,
+		SetIndexBuffer,
+		SetPrimitiveTopology,
+		SetRootConstantBuffer,
+		SetRootShaderResource,
+		SetRootDescriptorTable,
+		DrawIndexed,
+		Count
+	};
+
+	// Arguments are stored in call order; unused ones are 0.
+	struct Command
+	{
+		CommandType Type;
+		std::uint64_t Args[5];
+	};
+
+	virtual void SetPipelineState(StateHandle pso) override;
+	virtual void SetRootSignature(StateHandle rootSignature) override;
+	virtual void SetDescriptorHeap(StateHandle heap) override;
+	virtual void SetVertexBuffer(std::uint32_t slot, const VertexBufferBinding& binding) override;
+	virtual void SetIndexBuffer(const IndexBufferBinding& binding) override;
+	virtual void SetPrimitiveTopology(std::uint32_t topology) override;
+	virtual void SetRootConstantBuffer(std::uint32_t rootIndex, std::uint64_t gpuAddress) override;
+	virtual void SetRootShaderResource(std::uint32_t rootIndex, std::uint64_t gpuAddress) override;
+	virtual void SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle) override;
+	virtual void DrawIndexed(std::uint32_t indexCount, std::uint32_t instanceCount,
+		std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) override;
+
+	void Clear();
+
+	const std::vector<Command>& Commands()const;
+	std::size_t Count(CommandType type)const;
+
+	// Calls other than DrawIndexed.
+	std::size_t BindCount()const;
+
+	static const char* CommandName(CommandType type);
+
+private:
+	void Record(CommandType type, std::uint64_t a0 = 0, std::uint64_t a1 = 0, std::uint64_t a2 = 0,
+		std::uint64_t a3 = 0, std::uint64_t a4 = 0);
+
+private:
+	std::vector<Command> mCommands;
+	std::size_t mCounts[(int)CommandType::Count] = {};
+};
@@ -0,0 +1,299 @@
+//***************************************************************************************
+// RgbaImage.cpp
+//***************************************************************************************
+
+#include "RgbaImage.h"
+#include "DDSFormat.h"
+#include "MappedFile.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace DirectX;
+
+namespace
+{
+	std::uint32_t Read16(const std::uint8_t* p)
+	{
+		return (std::uint32_t)p[0] | ((std::uint32_t)p[1] << 8);
+	}
+
+	std::uint32_t Read32(const std::uint8_t* p)
+	{
+		return (std::uint32_t)p[0] | ((std::uint32_t)p[1] << 8) | ((std::uint32_t)p[2] << 16) | ((std::uint32_t)p[3] << 24);
+	}
+
+	// Shift and width of a contiguous channel mask, for BI_BITFIELDS.
+	void MaskShift(std::uint32_t mask, std::uint32_t* shift, std::uint32_t* bits)
+	{
+		*shift = 0;
+		*bits = 0;
+		if(mask == 0)
+			return;
+
+		while(!(mask & 1))
+		{
+			mask >>= 1;
+			++*shift;
+		}
+		while(mask & 1)
+		{
+			mask >>= 1;
+			++*bits;
+		}
+	}
+
+	std::uint8_t Extract(std::uint32_t value, std::uint32_t shift, std::uint32_t bits)
+	{
+		if(bits == 0)
+			return 0;
+
+		std::uint32_t max = (bits >= 32) ? 0xffffffff : (1u << bits) - 1;
+		std::uint32_t v = (value >> shift) & max;
+		return (std::uint8_t)((v * 255 + max / 2) / max);
+	}
+
+	const std::uint32_t BmpFileHeaderSize = 14;
+	const std::uint32_t BmpRgb = 0;
+	const std::uint32_t BmpBitfields = 3;
+}
+
+void RgbaImage::Resize(std::uint32_t width, std::uint32_t height)
+{
+	Width = width;
+	Height = height;
+	Pixels.assign((std::size_t)width * height * 4, 0);
+}
+
+std::uint8_t* RgbaImage::Pixel(std::uint32_t x, std::uint32_t y)
+{
+	assert(x < Width && y < Height);
+	return Pixels.data() + ((std::size_t)y * Width + x) * 4;
+}
+
+const std::uint8_t* RgbaImage::Pixel(std::uint32_t x, std::uint32_t y)const
+{
+	assert(x < Width && y < Height);
+	return Pixels.data() + ((std::size_t)y * Width + x) * 4;
+}
+
+void RgbaFloatImage::Resize(std::uint32_t width, std::uint32_t height)
+{
+	Width = width;
+	Height = height;
+	Pixels.assign((std::size_t)width * height * 4, 0.0f);
+}
+
+float* RgbaFloatImage::Pixel(std::uint32_t x, std::uint32_t y)
+{
+	assert(x < Width && y < Height);
+	return Pixels.data() + ((std::size_t)y * Width + x) * 4;
+}
+
+const float* RgbaFloatImage::Pixel(std::uint32_t x, std::uint32_t y)const
+{
+	assert(x < Width && y < Height);
+	return Pixels.data() + ((std::size_t)y * Width + x) * 4;
+}
+
+bool LoadBmp(const std::string& fileName, RgbaImage& image, std::string& error)
+{
+	MappedFile file;
+	if(!file.Open(fileName.c_str()))
+	{
+		error = "cannot open " + fileName + " (error " + std::to_string(file.LastError()) + ")";
+		return false;
+	}
+
+	const std::uint8_t* data = file.Data();
+	std::size_t size = file.Size();
+	if(size < BmpFileHeaderSize + 40 || data[0] != 'B' || data[1] != 'M')
+	{
+		error = fileName + " is not a BMP file";
+		return false;
+	}
+
+	std::uint32_t bitsOffset = Read32(data + 10);
+	const std::uint8_t* info = data + BmpFileHeaderSize;
+	std::uint32_t infoSize = Read32(info);
+	std::int32_t width = (std::int32_t)Read32(info + 4);
+	std::int32_t height = (std::int32_t)Read32(info + 8);
+	std::uint32_t bitCount = Read16(info + 14);
+	std::uint32_t compression = Read32(info + 16);
+
+	if(infoSize < 40 || width <= 0 || height == 0 || height == INT32_MIN)
+	{
+		error = fileName + " has an invalid BMP header";
+		return false;
+	}
+
+	bool topDown = height < 0;
+	std::uint32_t w = (std::uint32_t)width;
+	std::uint32_t h = (std::uint32_t)(topDown ? -height : height);
+
+	std::uint32_t masks[4] = { 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 };
+	if(compression == BmpBitfields && bitCount == 32)
+	{
+		// The masks follow a 40-byte header, or are part of a larger one.
+		if(BmpFileHeaderSize + 40 + 12 > size)
+		{
+			error = fileName + " has an invalid BMP header";
+			return false;
+		}
+
+		for(int i = 0; i < 3; ++i)
+			masks[i] = Read32(info + 40 + 4 * i);
+		masks[3] = (infoSize >= 56 && BmpFileHeaderSize + 56 <= size) ? Read32(info + 52) : 0;
+	}
+	else if(!(compression == BmpRgb && (bitCount == 24 || bitCount == 32)))
+	{
+		error = fileName + " is not a 24 or 32 bits per pixel uncompressed BMP file";
+		return false;
+	}
+
+	std::size_t rowPitch = (((std::size_t)w * bitCount + 31) / 32) * 4;
+	if(bitsOffset > size || rowPitch * h > size - bitsOffset)
+	{
+		error = fileName + " is truncated";
+		return false;
+	}
+
+	std::uint32_t shift[4], bits[4];
+	for(int i = 0; i < 4; ++i)
+		MaskShift(masks[i], &shift[i], &bits[i]);
+
+	image.Resize(w, h);
+
+	bool anyAlpha = false;
+	for(std::uint32_t y = 0; y < h; ++y)
+	{
+		const std::uint8_t* src = data + bitsOffset + rowPitch * (topDown ? y : h - 1 - y);
+		std::uint8_t* dest = image.Pixel(0, y);
+
+		for(std::uint32_t x = 0; x < w; ++x, dest += 4)
+		{
+			if(bitCount == 24)
+			{
+				dest[0] = src[3 * x + 2];
+				dest[1] = src[3 * x + 1];
+				dest[2] = src[3 * x + 0];
+				dest[3] = 255;
+			}
+			else
+			{
+				std::uint32_t value = Read32(src + 4 * x);
+				dest[0] = Extract(value, shift[0], bits[0]);
+				dest[1] = Extract(value, shift[1], bits[1]);
+				dest[2] = Extract(value, shift[2], bits[2]);
+				dest[3] = (bits[3] != 0) ? Extract(value, shift[3], bits[3]) : 255;
+				anyAlpha |= dest[3] != 0;
+			}
+		}
+	}
+
+	if(bitCount == 32 && compression == BmpRgb && !anyAlpha)
+	{
+		for(std::size_t i = 3; i < image.Pixels.size(); i += 4)
+			image.Pixels[i] = 255;
+	}
+
+	return true;
+}
+
+bool LoadDDSImage(const std::string& fileName, RgbaImage& image, std::string& error)
+{
+	MappedFile file;
+	if(!file.Open(fileName.c_str()))
+	{
+		error = "cannot open " + fileName + " (error " + std::to_string(file.LastError()) + ")";
+		return false;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	std::size_t headerSize = 0;
+	DDSTextureDesc desc;
+	DDSLayout layout;
+	if(!ValidateDDSHeader(file.Data(), file.Size(), &header, &headerSize) ||
+		GetDDSTextureDesc(header, desc) != DDSStatus::Ok ||
+		!GetDDSLayout(desc, 0, layout) ||
+		layout.TotalBytes > file.Size() - headerSize)
+	{
+		error = fileName + " is not a valid DDS file";
+		return false;
+	}
+
+	const DDSSubresource& top = layout.Subresources[0];
+	if(!CopyRgba8Surface(desc.Format, file.Data() + headerSize + top.Offset, top.RowPitch, top.Width, top.Height, image))
+	{
+		error = fileName + " is not an 8-bit RGBA or BGRA DDS file";
+		return false;
+	}
+
+	return true;
+}
+
+bool CopyRgba8Surface(DXGI_FORMAT format, const std::uint8_t* bits, std::size_t rowPitch,
+	std::uint32_t width, std::uint32_t height, RgbaImage& image)
+{
+	bool bgra;
+	switch(format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		bgra = false;
+		break;
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		bgra = true;
+		break;
+	default:
+		return false;
+	}
+
+	bool opaque = format == DXGI_FORMAT_B8G8R8X8_UNORM || format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+	image.Resize(width, height);
+	for(std::uint32_t y = 0; y < height; ++y)
+	{
+		const std::uint8_t* src = bits + rowPitch * y;
+		std::uint8_t* dest = image.Pixel(0, y);
+		for(std::uint32_t x = 0; x < width; ++x, src += 4, dest += 4)
+		{
+			dest[0] = bgra ? src[2] : src[0];
+			dest[1] = src[1];
+			dest[2] = bgra ? src[0] : src[2];
+			dest[3] = opaque ? 255 : src[3];
+		}
+	}
+
+	return true;
+}
+
+double ComputePSNR(const RgbaImage& a, const RgbaImage& b, std::uint32_t channels)
+{
+	assert(a.Width == b.Width && a.Height == b.Height);
+
+	std::uint64_t sum = 0;
+	std::uint64_t count = 0;
+	for(std::size_t i = 0; i < a.Pixels.size(); i += 4)
+	{
+		for(std::uint32_t c = 0; c < 4; ++c)
+		{
+			if(channels & (1u << c))
+			{
+				int d = (int)a.Pixels[i + c] - (int)b.Pixels[i + c];
+				sum += (std::uint64_t)(d * d);
+				++count;
+			}
+		}
+	}
+
+	if(sum == 0 || count == 0)
+		return std::numeric_limits<double>::infinity();
+
+	double mse = (double)sum / (double)count;
+	return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
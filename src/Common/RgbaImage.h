@@ -0,0 +1,67 @@
+//***************************************************************************************
+// RgbaImage.h
+//
+// 8-bit RGBA image in memory, rows top to bottom, for the offline texture tools (block
+// compression, mip generation).  Loads uncompressed BMP files and the top mip of
+// uncompressed 8-bit DDS files, and measures PSNR between two images.  RgbaFloatImage
+// holds the same layout in 32-bit floats, for HDR and signed data.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <dxgiformat.h>
+
+struct RgbaImage
+{
+	std::uint32_t Width = 0;
+	std::uint32_t Height = 0;
+	std::vector<std::uint8_t> Pixels; // Width * Height * 4 bytes.
+
+	void Resize(std::uint32_t width, std::uint32_t height);
+
+	std::uint8_t* Pixel(std::uint32_t x, std::uint32_t y);
+	const std::uint8_t* Pixel(std::uint32_t x, std::uint32_t y)const;
+};
+
+struct RgbaFloatImage
+{
+	std::uint32_t Width = 0;
+	std::uint32_t Height = 0;
+	std::vector<float> Pixels; // Width * Height * 4 floats.
+
+	void Resize(std::uint32_t width, std::uint32_t height);
+
+	float* Pixel(std::uint32_t x, std::uint32_t y);
+	const float* Pixel(std::uint32_t x, std::uint32_t y)const;
+};
+
+// Reads 24 and 32 bits per pixel BI_RGB and BI_BITFIELDS bitmaps, bottom-up or
+// top-down.  24-bit images get an alpha of 255.  A 32-bit BI_RGB image whose fourth
+// bytes are all 0 is taken as opaque too, since most writers leave them unused.
+bool LoadBmp(const std::string& fileName, RgbaImage& image, std::string& error);
+
+// Reads the top mip of the first slice of an R8G8B8A8, B8G8R8A8 or B8G8R8X8 DDS file.
+bool LoadDDSImage(const std::string& fileName, RgbaImage& image, std::string& error);
+
+// Copies a width x height surface of one of those formats, rows rowPitch bytes apart,
+// into image.  Returns false for any other format.
+bool CopyRgba8Surface(DXGI_FORMAT format, const std::uint8_t* bits, std::size_t rowPitch,
+	std::uint32_t width, std::uint32_t height, RgbaImage& image);
+
+// Channels of an RGBA pixel, for ComputePSNR.
+enum RgbaChannel
+{
+	ChannelR = 1,
+	ChannelG = 2,
+	ChannelB = 4,
+	ChannelA = 8,
+	ChannelRGB = ChannelR | ChannelG | ChannelB,
+	ChannelRGBA = ChannelRGB | ChannelA
+};
+
+// Peak signal-to-noise ratio in dB over the given channels of two images of the same
+// size.  Identical images return infinity.
+double ComputePSNR(const RgbaImage& a, const RgbaImage& b, std::uint32_t channels = ChannelRGB);
@@ -0,0 +1,111 @@
+//***************************************************************************************
+// RingAllocator.cpp
+//***************************************************************************************
+
+#include "RingAllocator.h"
+#include <cassert>
+
+RingAllocator::RingAllocator(std::size_t capacity)
+	: mCapacity(capacity)
+{
+}
+
+std::size_t RingAllocator::Allocate(std::size_t size, std::size_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+	if(size == 0 || size > mCapacity || mUsed == mCapacity)
+		return InvalidOffset;
+
+	// Nothing is live, so start over at the beginning to keep the range contiguous.
+	if(mUsed == 0)
+		mHead = mTail = 0;
+
+	std::size_t aligned = (mHead + alignment - 1) & ~(alignment - 1);
+	std::size_t offset = InvalidOffset;
+	bool wrapped = false;
+
+	if(mHead >= mTail)
+	{
+		// Free space is [mHead, capacity) followed by [0, mTail).
+		if(aligned <= mCapacity && size <= mCapacity - aligned)
+		{
+			offset = aligned;
+		}
+		else if(size <= mTail)
+		{
+			offset = 0;
+			wrapped = true;
+		}
+	}
+	else
+	{
+		// Free space is [mHead, mTail).
+		if(aligned <= mTail && size <= mTail - aligned)
+			offset = aligned;
+	}
+
+	if(offset == InvalidOffset)
+		return InvalidOffset;
+
+	// Bytes consumed, including alignment padding or the skipped tail.
+	std::size_t newHead = offset + size;
+	std::size_t consumed = wrapped ? (mCapacity - mHead) + newHead : newHead - mHead;
+
+	mUsed += consumed;
+	mOpenBytes += consumed;
+	mHead = newHead;
+
+	return offset;
+}
+
+void RingAllocator::Submit(std::uint64_t fenceValue)
+{
+	if(mOpenBytes == 0)
+		return;
+
+	assert(mBatches.empty() || mBatches.back().Fence <= fenceValue);
+
+	Batch b;
+	b.Fence = fenceValue;
+	b.End = mHead;
+	b.Bytes = mOpenBytes;
+	mBatches.push_back(b);
+
+	mOpenBytes = 0;
+}
+
+void RingAllocator::Retire(std::uint64_t completedValue)
+{
+	while(!mBatches.empty() && mBatches.front().Fence <= completedValue)
+	{
+		mTail = mBatches.front().End;
+		mUsed -= mBatches.front().Bytes;
+		mBatches.pop_front();
+	}
+}
+
+std::uint64_t RingAllocator::OldestPendingFence()const
+{
+	return mBatches.empty() ? 0 : mBatches.front().Fence;
+}
+
+std::size_t RingAllocator::Capacity()const
+{
+	return mCapacity;
+}
+
+std::size_t RingAllocator::Used()const
+{
+	return mUsed;
+}
+
+std::size_t RingAllocator::OpenBatchBytes()const
+{
+	return mOpenBytes;
+}
+
+std::size_t RingAllocator::PendingBatchCount()const
+{
+	return mBatches.size();
+}
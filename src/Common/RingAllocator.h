@@ -0,0 +1,62 @@
+//***************************************************************************************
+// RingAllocator.h
+//
+// Circular allocator over a fixed range of offsets whose space is reclaimed by fence
+// value.  Allocations are made into an open batch; Submit closes the batch and tags
+// it with the fence value that will be signaled once the GPU has consumed it.
+// Retire(completedValue) then frees every batch whose fence has completed, oldest
+// first.  Like LinearAllocator it manages offsets only, so it can be exercised
+// without a device.
+//
+// A block never straddles the end of the range.  When it does not fit in the space
+// left before the end, that tail is skipped and the block starts at offset 0; the
+// skipped bytes are charged to the current batch and come back when it retires.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+class RingAllocator
+{
+public:
+	static const std::size_t InvalidOffset = ~std::size_t(0);
+
+	explicit RingAllocator(std::size_t capacity = 0);
+
+	// Returns the offset of a block of 'size' bytes, or InvalidOffset if there is not
+	// enough free space until more batches retire.  alignment must be a power of two.
+	std::size_t Allocate(std::size_t size, std::size_t alignment);
+
+	// Closes the open batch.  Its space is freed once fenceValue completes.  Fence
+	// values must not decrease between calls.
+	void Submit(std::uint64_t fenceValue);
+
+	// Frees the space of all submitted batches with a fence value <= completedValue.
+	void Retire(std::uint64_t completedValue);
+
+	// Fence value of the oldest submitted batch still holding space, or 0 if none.
+	std::uint64_t OldestPendingFence()const;
+
+	std::size_t Capacity()const;
+	std::size_t Used()const;        // Includes padding and skipped tails.
+	std::size_t OpenBatchBytes()const;
+	std::size_t PendingBatchCount()const;
+
+private:
+	struct Batch
+	{
+		std::uint64_t Fence;
+		std::size_t End;   // mHead when the batch was submitted.
+		std::size_t Bytes; // Space charged to the batch.
+	};
+
+	std::size_t mCapacity;
+	std::size_t mHead = 0; // Next free offset.
+	std::size_t mTail = 0; // Start of the oldest live block.
+	std::size_t mUsed = 0;
+	std::size_t mOpenBytes = 0;
+	std::deque<Batch> mBatches;
+};
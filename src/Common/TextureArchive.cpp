@@ -0,0 +1,716 @@
+//***************************************************************************************
+// TextureArchive.cpp
+//***************************************************************************************
+
+#include "TextureArchive.h"
+#include "DDSInfo.h"
+#include "JobSystem.h"
+#include "Lz4.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+using namespace DirectX;
+
+namespace
+{
+	std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	// Describes the DDS file starting at data the way the loaders would, or returns
+	// false.  headerBytes of data are readable; fileSize is the size of the whole file.
+	bool DescribeDDS(const std::string& name, const std::uint8_t* data, std::size_t headerBytes,
+		std::uint64_t fileSize, std::uint32_t maxsize, DDSTextureDesc& desc, DDSLayout& layout,
+		std::size_t* headerSize, std::string& error)
+	{
+		const DDS_HEADER* header = nullptr;
+		if(!ValidateDDSHeader(data, headerBytes, &header, headerSize))
+		{
+			error = name + " is not a DDS file";
+			return false;
+		}
+
+		switch(GetDDSTextureDesc(header, desc))
+		{
+		case DDSStatus::Ok:
+			break;
+		case DDSStatus::InvalidData:
+			error = name + " has an invalid DDS header";
+			return false;
+		default:
+			error = name + " has an unsupported format or size";
+			return false;
+		}
+
+		if(!GetDDSLayout(desc, maxsize, layout))
+		{
+			error = name + " has no mip within maxsize";
+			return false;
+		}
+
+		if(layout.TotalBytes > fileSize - *headerSize)
+		{
+			error = name + " is truncated";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool DecodeChunk(const std::uint8_t* src, std::uint32_t srcSize, std::uint8_t* dest, std::size_t size)
+	{
+		if(srcSize == size)
+		{
+			std::memcpy(dest, src, size);
+			return true;
+		}
+
+		return Lz4Decompress(src, srcSize, dest, size);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// TextureArchive
+//---------------------------------------------------------------------------------------
+
+const std::uint8_t* TextureArchive::TextureView::Data(std::size_t subresource)const
+{
+	return Bits + Layout.Subresources[subresource].Offset;
+}
+
+bool TextureArchive::Open(const std::string& fileName, std::string& error)
+{
+	Close();
+
+	if(!mFile.Open(fileName.c_str()))
+	{
+		error = "cannot open " + fileName + " (error " + std::to_string(mFile.LastError()) + ")";
+		return false;
+	}
+
+	const std::uint8_t* data = mFile.Data();
+	std::uint64_t size = mFile.Size();
+
+	auto header = reinterpret_cast<const TextureArchiveHeader*>(data);
+	if(size < sizeof(TextureArchiveHeader) || header->Magic != Magic)
+	{
+		error = fileName + " is not a texture archive";
+		Close();
+		return false;
+	}
+
+	if(header->Version != Version)
+	{
+		error = fileName + " has archive version " + std::to_string(header->Version) +
+			", expected " + std::to_string(Version);
+		Close();
+		return false;
+	}
+
+	std::uint64_t indexSize = (std::uint64_t)header->EntryCount * sizeof(TextureArchiveIndexEntry);
+	if(header->FileSize != size ||
+		header->IndexOffset > size || indexSize > size - header->IndexOffset ||
+		header->NamesOffset > size || header->NamesSize > size - header->NamesOffset)
+	{
+		error = fileName + " is truncated or has a corrupt header";
+		Close();
+		return false;
+	}
+
+	auto index = reinterpret_cast<const TextureArchiveIndexEntry*>(data + header->IndexOffset);
+	for(std::uint32_t i = 0; i < header->EntryCount; ++i)
+	{
+		const TextureArchiveIndexEntry& entry = index[i];
+
+		bool valid =
+			(i == 0 || index[i - 1].NameHash <= entry.NameHash) &&
+			(std::uint64_t)entry.NameOffset + entry.NameLength <= header->NamesSize &&
+			entry.Offset <= size &&
+			sizeof(TextureArchiveEntryHeader) + entry.DataSize <= size - entry.Offset;
+
+		if(!valid)
+		{
+			error = fileName + " has a corrupt index";
+			Close();
+			return false;
+		}
+	}
+
+	mHeader = header;
+	mIndex = index;
+	mNames = reinterpret_cast<const char*>(data + header->NamesOffset);
+	return true;
+}
+
+void TextureArchive::Close()
+{
+	mFile.Close();
+	mHeader = nullptr;
+	mIndex = nullptr;
+	mNames = nullptr;
+}
+
+bool TextureArchive::IsOpen()const
+{
+	return mHeader != nullptr;
+}
+
+std::uint32_t TextureArchive::EntryCount()const
+{
+	return mHeader != nullptr ? mHeader->EntryCount : 0;
+}
+
+std::uint32_t TextureArchive::Find(const std::string& name)const
+{
+	if(mHeader == nullptr)
+		return NotFound;
+
+	std::string normalized = NormalizeName(name);
+	std::uint64_t hash = HashName(normalized);
+
+	const TextureArchiveIndexEntry* end = mIndex + mHeader->EntryCount;
+	const TextureArchiveIndexEntry* it = std::lower_bound(mIndex, end, hash,
+		[](const TextureArchiveIndexEntry& entry, std::uint64_t value) { return entry.NameHash < value; });
+
+	for(; it != end && it->NameHash == hash; ++it)
+	{
+		if(it->NameLength == normalized.size() &&
+			std::memcmp(mNames + it->NameOffset, normalized.data(), normalized.size()) == 0)
+		{
+			return (std::uint32_t)(it - mIndex);
+		}
+	}
+
+	return NotFound;
+}
+
+std::string TextureArchive::Name(std::uint32_t entry)const
+{
+	const TextureArchiveIndexEntry& index = IndexEntry(entry);
+	return std::string(mNames + index.NameOffset, index.NameLength);
+}
+
+const std::uint8_t* TextureArchive::EntryData(std::uint32_t entry, std::size_t* size)const
+{
+	const TextureArchiveEntryHeader* header = EntryHeader(entry);
+	if(header == nullptr)
+	{
+		*size = 0;
+		return nullptr;
+	}
+
+	*size = (std::size_t)header->DataSize;
+	return reinterpret_cast<const std::uint8_t*>(header + 1);
+}
+
+bool TextureArchive::IsCompressed(std::uint32_t entry)const
+{
+	const TextureArchiveEntryHeader* header = EntryHeader(entry);
+	return header != nullptr && header->Codec == CodecLz4;
+}
+
+bool TextureArchive::GetTexture(std::uint32_t entry, std::uint32_t maxsize, TextureView& view, std::string& error)const
+{
+	const TextureArchiveEntryHeader* header = EntryHeader(entry);
+	if(header == nullptr)
+	{
+		error = Name(entry) + " has a corrupt entry header";
+		return false;
+	}
+
+	auto data = reinterpret_cast<const std::uint8_t*>(header + 1);
+
+	std::size_t headerSize = 0;
+	if(!DescribeDDS(Name(entry), data, header->BitsOffset, header->RawSize, maxsize,
+		view.Desc, view.Layout, &headerSize, error))
+	{
+		return false;
+	}
+
+	// ReadTexture and the chunk table both start at BitsOffset, so a header of another
+	// size would put the bit data somewhere other than where the layout expects it.
+	if(headerSize != header->BitsOffset)
+	{
+		error = Name(entry) + " has a DDS header size that does not match its entry";
+		return false;
+	}
+
+	// Layout offsets count from the start of the bit data, which is where Bits points.
+	view.Bits = (header->Codec == CodecNone) ? data + headerSize : nullptr;
+	return true;
+}
+
+bool TextureArchive::ReadTexture(std::uint32_t entry, const TextureView& view, std::uint8_t* dest,
+	JobSystem* jobs, std::string& error)const
+{
+	if(view.Bits != nullptr)
+	{
+		std::uint64_t offset = 0;
+		for(const DDSSubresource& sub : view.Layout.Subresources)
+		{
+			std::memcpy(dest + offset, view.Bits + sub.Offset, (std::size_t)sub.Size);
+			offset += sub.Size;
+		}
+		return true;
+	}
+
+	const TextureArchiveChunkTable* table = nullptr;
+	const TextureArchiveChunk* chunks = nullptr;
+	const std::uint8_t* chunkData = nullptr;
+	if(!GetChunks(entry, &table, &chunks, &chunkData))
+	{
+		error = Name(entry) + " has a corrupt chunk table";
+		return false;
+	}
+
+	const TextureArchiveEntryHeader* header = EntryHeader(entry);
+	const std::uint64_t bitsSize = header->RawSize - header->BitsOffset;
+	const std::uint64_t chunkDataSize = header->DataSize - (std::uint64_t)(chunkData - reinterpret_cast<const std::uint8_t*>(header + 1));
+	const std::uint64_t chunkSize = table->ChunkSize;
+
+	// The kept bit data ranges and where each goes in dest.  Mips of one array slice
+	// are adjacent in the file, so this is usually one range per slice.
+	struct Range
+	{
+		std::uint64_t Begin;
+		std::uint64_t End;
+		std::uint64_t Dest;
+	};
+
+	std::vector<Range> ranges;
+	std::uint64_t destOffset = 0;
+	for(const DDSSubresource& sub : view.Layout.Subresources)
+	{
+		if(!ranges.empty() && ranges.back().End == sub.Offset)
+			ranges.back().End += sub.Size;
+		else
+			ranges.push_back({ sub.Offset, sub.Offset + sub.Size, destOffset });
+
+		destOffset += sub.Size;
+	}
+
+	// Only chunks that hold kept bytes are decoded.
+	std::vector<std::uint32_t> needed;
+	for(const Range& range : ranges)
+	{
+		if(range.End == range.Begin)
+			continue;
+
+		std::uint32_t first = (std::uint32_t)(range.Begin / chunkSize);
+		std::uint32_t last = (std::uint32_t)((range.End - 1) / chunkSize);
+		for(std::uint32_t c = first; c <= last; ++c)
+		{
+			if(needed.empty() || needed.back() < c)
+				needed.push_back(c);
+		}
+	}
+
+	std::atomic<bool> ok(true);
+	auto decode = [&](std::uint32_t n)
+	{
+		std::uint32_t c = needed[n];
+		const TextureArchiveChunk& chunk = chunks[c];
+		std::uint64_t begin = c * chunkSize;
+		std::size_t size = (std::size_t)std::min(chunkSize, bitsSize - begin);
+
+		if((std::uint64_t)chunk.Offset + chunk.Size > chunkDataSize)
+		{
+			ok = false;
+			return;
+		}
+
+		const std::uint8_t* src = chunkData + chunk.Offset;
+
+		// A chunk inside one range decodes straight into place.
+		for(const Range& range : ranges)
+		{
+			if(range.Begin <= begin && begin + size <= range.End)
+			{
+				if(!DecodeChunk(src, chunk.Size, dest + range.Dest + (begin - range.Begin), size))
+					ok = false;
+				return;
+			}
+		}
+
+		// One that straddles a skipped mip goes through a scratch copy.
+		std::vector<std::uint8_t> scratch(size);
+		if(!DecodeChunk(src, chunk.Size, scratch.data(), size))
+		{
+			ok = false;
+			return;
+		}
+
+		for(const Range& range : ranges)
+		{
+			std::uint64_t from = std::max(range.Begin, begin);
+			std::uint64_t to = std::min(range.End, begin + size);
+			if(from < to)
+				std::memcpy(dest + range.Dest + (from - range.Begin), scratch.data() + (from - begin), (std::size_t)(to - from));
+		}
+	};
+
+	if(jobs != nullptr)
+	{
+		jobs->ParallelFor((std::uint32_t)needed.size(), decode);
+	}
+	else
+	{
+		for(std::uint32_t n = 0; n < (std::uint32_t)needed.size(); ++n)
+			decode(n);
+	}
+
+	if(!ok)
+	{
+		error = Name(entry) + " has a corrupt compressed chunk";
+		return false;
+	}
+
+	return true;
+}
+
+void TextureArchive::Prefetch(std::uint32_t entry, const TextureView& view)const
+{
+	if(view.Bits != nullptr)
+	{
+		std::size_t base = (std::size_t)(view.Bits - mFile.Data());
+		for(const DDSSubresource& sub : view.Layout.Subresources)
+			mFile.Prefetch(base + (std::size_t)sub.Offset, (std::size_t)sub.Size);
+		return;
+	}
+
+	const TextureArchiveChunkTable* table = nullptr;
+	const TextureArchiveChunk* chunks = nullptr;
+	const std::uint8_t* chunkData = nullptr;
+	if(!GetChunks(entry, &table, &chunks, &chunkData))
+		return;
+
+	// Chunks are stored in order, so the chunks of a subresource are contiguous.
+	std::size_t base = (std::size_t)(chunkData - mFile.Data());
+	for(const DDSSubresource& sub : view.Layout.Subresources)
+	{
+		if(sub.Size == 0)
+			continue;
+
+		const TextureArchiveChunk& first = chunks[sub.Offset / table->ChunkSize];
+		const TextureArchiveChunk& last = chunks[(sub.Offset + sub.Size - 1) / table->ChunkSize];
+		mFile.Prefetch(base + first.Offset, (std::size_t)last.Offset + last.Size - first.Offset);
+	}
+}
+
+std::string TextureArchive::NormalizeName(const std::string& name)
+{
+	std::string normalized = name;
+	for(char& c : normalized)
+		c = (c == '\\') ? '/' : (char)std::tolower((unsigned char)c);
+
+	return normalized;
+}
+
+std::uint64_t TextureArchive::HashName(const std::string& name)
+{
+	std::uint64_t hash = 14695981039346656037ull;
+	for(char c : NormalizeName(name))
+	{
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+const TextureArchiveIndexEntry& TextureArchive::IndexEntry(std::uint32_t entry)const
+{
+	assert(mHeader != nullptr && entry < mHeader->EntryCount);
+	return mIndex[entry];
+}
+
+const TextureArchiveEntryHeader* TextureArchive::EntryHeader(std::uint32_t entry)const
+{
+	const TextureArchiveIndexEntry& index = IndexEntry(entry);
+
+	// Open only checked the index; the entry header is on the entry's own page.
+	auto header = reinterpret_cast<const TextureArchiveEntryHeader*>(mFile.Data() + index.Offset);
+	bool valid =
+		header->Magic == EntryMagic &&
+		header->HeaderSize == sizeof(TextureArchiveEntryHeader) &&
+		header->NameHash == index.NameHash &&
+		header->DataSize == index.DataSize &&
+		header->BitsOffset <= header->DataSize &&
+		header->BitsOffset <= header->RawSize &&
+		(header->Codec == CodecLz4 || (header->Codec == CodecNone && header->RawSize == header->DataSize));
+
+	return valid ? header : nullptr;
+}
+
+bool TextureArchive::GetChunks(std::uint32_t entry, const TextureArchiveChunkTable** table,
+	const TextureArchiveChunk** chunks, const std::uint8_t** chunkData)const
+{
+	const TextureArchiveEntryHeader* header = EntryHeader(entry);
+	if(header == nullptr || header->Codec != CodecLz4)
+		return false;
+
+	auto data = reinterpret_cast<const std::uint8_t*>(header + 1);
+	std::uint64_t remaining = header->DataSize - header->BitsOffset;
+	if(remaining < sizeof(TextureArchiveChunkTable))
+		return false;
+
+	auto chunkTable = reinterpret_cast<const TextureArchiveChunkTable*>(data + header->BitsOffset);
+	remaining -= sizeof(TextureArchiveChunkTable);
+
+	std::uint64_t bitsSize = header->RawSize - header->BitsOffset;
+	if(chunkTable->ChunkSize == 0 ||
+		chunkTable->ChunkCount != (bitsSize + chunkTable->ChunkSize - 1) / chunkTable->ChunkSize ||
+		(std::uint64_t)chunkTable->ChunkCount * sizeof(TextureArchiveChunk) > remaining)
+	{
+		return false;
+	}
+
+	*table = chunkTable;
+	*chunks = reinterpret_cast<const TextureArchiveChunk*>(chunkTable + 1);
+	*chunkData = reinterpret_cast<const std::uint8_t*>(*chunks + chunkTable->ChunkCount);
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// TextureArchiveBuilder
+//---------------------------------------------------------------------------------------
+
+bool TextureArchiveBuilder::AddFile(const std::string& name, const std::string& fileName, std::string& error)
+{
+	DDSFileInfo info;
+	if(!ReadDDSFileInfo(fileName, info))
+	{
+		error = info.Error;
+		return false;
+	}
+
+	Entry entry;
+	entry.Name = name;
+	entry.SourceFile = fileName;
+	entry.DataSize = info.FileSize;
+	entry.BitsOffset = (std::uint32_t)info.HeaderSize;
+	return AddEntry(entry, error);
+}
+
+bool TextureArchiveBuilder::AddMemory(const std::string& name, const std::uint8_t* data, std::size_t size,
+	std::string& error)
+{
+	DDSTextureDesc desc;
+	DDSLayout layout;
+	std::size_t headerSize = 0;
+	if(!DescribeDDS(name, data, size, size, 0, desc, layout, &headerSize, error))
+		return false;
+
+	Entry entry;
+	entry.Name = name;
+	entry.Data.assign(data, data + size);
+	entry.DataSize = size;
+	entry.BitsOffset = (std::uint32_t)headerSize;
+	return AddEntry(entry, error);
+}
+
+std::size_t TextureArchiveBuilder::EntryCount()const
+{
+	return mEntries.size();
+}
+
+void TextureArchiveBuilder::SetCompression(bool enabled, std::uint32_t chunkSize)
+{
+	assert(chunkSize > 0);
+	mCompress = enabled;
+	mChunkSize = chunkSize;
+}
+
+bool TextureArchiveBuilder::AddEntry(Entry& entry, std::string& error)
+{
+	entry.Name = TextureArchive::NormalizeName(entry.Name);
+	entry.NameHash = TextureArchive::HashName(entry.Name);
+
+	for(const Entry& existing : mEntries)
+	{
+		if(existing.NameHash == entry.NameHash && existing.Name == entry.Name)
+		{
+			error = "the archive already has an entry named " + entry.Name;
+			return false;
+		}
+	}
+
+	mEntries.push_back(std::move(entry));
+	return true;
+}
+
+bool TextureArchiveBuilder::Compress(const Entry& entry, const std::uint8_t* data, std::vector<std::uint8_t>& stored,
+	JobSystem* jobs)const
+{
+	const std::uint8_t* bits = data + entry.BitsOffset;
+	std::uint64_t bitsSize = entry.DataSize - entry.BitsOffset;
+	std::uint32_t chunkCount = (std::uint32_t)((bitsSize + mChunkSize - 1) / mChunkSize);
+	if(chunkCount == 0)
+		return false;
+
+	std::vector<std::vector<std::uint8_t>> blocks(chunkCount);
+	auto compress = [&](std::uint32_t c)
+	{
+		const std::uint8_t* src = bits + (std::uint64_t)c * mChunkSize;
+		std::size_t size = (std::size_t)std::min<std::uint64_t>(mChunkSize, bitsSize - (std::uint64_t)c * mChunkSize);
+
+		std::vector<std::uint8_t>& block = blocks[c];
+		block.resize(Lz4CompressBound(size));
+		std::size_t compressed = Lz4Compress(src, size, block.data(), block.size());
+
+		// A chunk that does not shrink is stored raw; equal sizes tell the reader.
+		if(compressed == 0 || compressed >= size)
+			block.assign(src, src + size);
+		else
+			block.resize(compressed);
+	};
+
+	if(jobs != nullptr)
+	{
+		jobs->ParallelFor(chunkCount, compress);
+	}
+	else
+	{
+		for(std::uint32_t c = 0; c < chunkCount; ++c)
+			compress(c);
+	}
+
+	std::uint64_t storedSize = entry.BitsOffset + sizeof(TextureArchiveChunkTable) +
+		(std::uint64_t)chunkCount * sizeof(TextureArchiveChunk);
+	for(const std::vector<std::uint8_t>& block : blocks)
+		storedSize += block.size();
+
+	if(storedSize > entry.DataSize - entry.DataSize / 16)
+		return false;
+
+	stored.assign(data, data + entry.BitsOffset);
+
+	TextureArchiveChunkTable table = { mChunkSize, chunkCount };
+	const std::uint8_t* tableBytes = reinterpret_cast<const std::uint8_t*>(&table);
+	stored.insert(stored.end(), tableBytes, tableBytes + sizeof(table));
+
+	std::uint32_t offset = 0;
+	for(const std::vector<std::uint8_t>& block : blocks)
+	{
+		TextureArchiveChunk chunk = { offset, (std::uint32_t)block.size() };
+		const std::uint8_t* chunkBytes = reinterpret_cast<const std::uint8_t*>(&chunk);
+		stored.insert(stored.end(), chunkBytes, chunkBytes + sizeof(chunk));
+		offset += chunk.Size;
+	}
+
+	for(const std::vector<std::uint8_t>& block : blocks)
+		stored.insert(stored.end(), block.begin(), block.end());
+
+	return true;
+}
+
+bool TextureArchiveBuilder::Write(const std::string& fileName, std::string& error, JobSystem* jobs)const
+{
+	std::vector<const Entry*> sorted;
+	for(const Entry& entry : mEntries)
+		sorted.push_back(&entry);
+
+	std::stable_sort(sorted.begin(), sorted.end(),
+		[](const Entry* a, const Entry* b) { return a->NameHash < b->NameHash; });
+
+	TextureArchiveHeader header = {};
+	header.Magic = TextureArchive::Magic;
+	header.Version = TextureArchive::Version;
+	header.EntryCount = (std::uint32_t)sorted.size();
+	header.Alignment = TextureArchive::Alignment;
+	header.IndexOffset = sizeof(TextureArchiveHeader);
+	header.NamesOffset = header.IndexOffset + sorted.size() * sizeof(TextureArchiveIndexEntry);
+
+	std::string names;
+	std::vector<TextureArchiveIndexEntry> index(sorted.size());
+	for(std::size_t i = 0; i < sorted.size(); ++i)
+	{
+		index[i].NameHash = sorted[i]->NameHash;
+		index[i].NameOffset = (std::uint32_t)names.size();
+		index[i].NameLength = (std::uint32_t)sorted[i]->Name.size();
+		names += sorted[i]->Name;
+	}
+	header.NamesSize = names.size();
+
+	std::ofstream fout(fileName, std::ios::binary | std::ios::trunc);
+	if(!fout)
+	{
+		error = "cannot create " + fileName;
+		return false;
+	}
+
+	// Stored sizes are only known once entries are compressed, so the header and index
+	// are written again at the end.
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(TextureArchiveIndexEntry));
+	fout.write(names.data(), names.size());
+
+	static const char padding[TextureArchive::Alignment] = {};
+	std::uint64_t written = header.NamesOffset + header.NamesSize;
+
+	std::vector<std::uint8_t> stored;
+	for(std::size_t i = 0; i < sorted.size(); ++i)
+	{
+		const Entry& entry = *sorted[i];
+
+		MappedFile source;
+		const std::uint8_t* data = entry.Data.data();
+		if(!entry.SourceFile.empty())
+		{
+			if(!source.Open(entry.SourceFile.c_str()) || source.Size() != entry.DataSize)
+			{
+				error = entry.SourceFile + " is missing or changed since it was added";
+				return false;
+			}
+			data = source.Data();
+		}
+
+		TextureArchiveEntryHeader entryHeader = {};
+		entryHeader.Magic = TextureArchive::EntryMagic;
+		entryHeader.HeaderSize = sizeof(TextureArchiveEntryHeader);
+		entryHeader.NameHash = entry.NameHash;
+		entryHeader.RawSize = entry.DataSize;
+		entryHeader.BitsOffset = entry.BitsOffset;
+
+		const std::uint8_t* payload = data;
+		if(mCompress && Compress(entry, data, stored, jobs))
+		{
+			payload = stored.data();
+			entryHeader.DataSize = stored.size();
+			entryHeader.Codec = TextureArchive::CodecLz4;
+		}
+		else
+		{
+			entryHeader.DataSize = entry.DataSize;
+			entryHeader.Codec = TextureArchive::CodecNone;
+		}
+
+		index[i].Offset = AlignUp(written, TextureArchive::Alignment);
+		index[i].DataSize = entryHeader.DataSize;
+
+		fout.write(padding, (std::streamsize)(index[i].Offset - written));
+		fout.write(reinterpret_cast<const char*>(&entryHeader), sizeof(entryHeader));
+		fout.write(reinterpret_cast<const char*>(payload), (std::streamsize)entryHeader.DataSize);
+
+		written = index[i].Offset + sizeof(TextureArchiveEntryHeader) + entryHeader.DataSize;
+	}
+
+	header.FileSize = written;
+	fout.seekp(0);
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(TextureArchiveIndexEntry));
+
+	fout.flush();
+	if(!fout)
+	{
+		error = "cannot write " + fileName;
+		return false;
+	}
+
+	return true;
+}
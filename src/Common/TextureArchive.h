@@ -0,0 +1,214 @@
+//***************************************************************************************
+// TextureArchive.h
+//
+// Packs DDS files into one archive so that loading many textures costs one open and one
+// mapping instead of an open, stat and read per file.
+//
+// Layout (little endian):
+//   TextureArchiveHeader
+//   TextureArchiveIndexEntry[EntryCount], sorted by NameHash
+//   names, back to back and not terminated
+//   entries, each starting on an Alignment (4KB) boundary: a TextureArchiveEntryHeader
+//   followed by the DDS file as it was on disk.
+//
+// A compressed entry (Codec == CodecLz4) keeps the DDS headers as they are and replaces
+// the bit data by a TextureArchiveChunkTable, a TextureArchiveChunk per ChunkSize bytes
+// of bit data, and the chunks, each an Lz4 block or, if that did not save anything, the
+// raw bytes.  Chunks decode independently, so ReadTexture spreads them over a JobSystem
+// and decodes only those holding kept subresources, straight into the caller's buffer.
+//
+// Names are normalized (lower case, '/' separators) and hashed with 64-bit FNV-1a, so
+// Find is a binary search of the index, with a name compare to rule out collisions.
+// Keeping the index at the front means a lookup touches the first pages only, and 4KB
+// entry alignment keeps each texture on pages of its own.
+//
+// TextureArchive maps the file once.  GetTexture parses an entry's DDS headers in place
+// and, for uncompressed entries, returns views into the mapping: nothing is copied, and
+// pages are read from disk only when a subresource is touched.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSFormat.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+#pragma pack(push,1)
+
+struct TextureArchiveHeader
+{
+	std::uint32_t Magic;       // TextureArchive::Magic
+	std::uint32_t Version;
+	std::uint32_t EntryCount;
+	std::uint32_t Alignment;
+	std::uint64_t IndexOffset;
+	std::uint64_t NamesOffset;
+	std::uint64_t NamesSize;
+	std::uint64_t FileSize;
+};
+
+struct TextureArchiveIndexEntry
+{
+	std::uint64_t NameHash;
+	std::uint64_t Offset;      // Of the entry header.
+	std::uint64_t DataSize;    // Of the DDS file that follows it.
+	std::uint32_t NameOffset;  // From NamesOffset.
+	std::uint32_t NameLength;
+};
+
+struct TextureArchiveEntryHeader
+{
+	std::uint32_t Magic;       // TextureArchive::EntryMagic
+	std::uint32_t HeaderSize;  // sizeof(TextureArchiveEntryHeader)
+	std::uint64_t NameHash;
+	std::uint64_t DataSize;    // Stored size.
+	std::uint64_t RawSize;     // Size of the DDS file; DataSize unless compressed.
+	std::uint32_t BitsOffset;  // Of the DDS bit data, from the start of the DDS file.
+	std::uint32_t Codec;
+};
+
+struct TextureArchiveChunkTable
+{
+	std::uint32_t ChunkSize;   // Bit data bytes per chunk; the last one may be shorter.
+	std::uint32_t ChunkCount;
+};
+
+struct TextureArchiveChunk
+{
+	std::uint32_t Offset;      // From the end of the chunk table.
+	std::uint32_t Size;        // Equal to the chunk's bit data size if stored raw.
+};
+
+#pragma pack(pop)
+
+class TextureArchive
+{
+public:
+	static const std::uint32_t Magic = 0x52415854;      // "TXAR"
+	static const std::uint32_t EntryMagic = 0x4e455854; // "TXEN"
+	static const std::uint32_t Version = 2;
+	static const std::uint32_t CodecNone = 0;
+	static const std::uint32_t CodecLz4 = 1;
+	static const std::uint32_t Alignment = 4096;
+	static const std::uint32_t NotFound = 0xffffffff;
+
+	// A texture in the archive.  Bits points into the mapping and Layout's offsets are
+	// relative to it; both stay valid until the archive is closed.  Bits is null for
+	// compressed entries, which must be read with ReadTexture.
+	struct TextureView
+	{
+		DirectX::DDSTextureDesc Desc;
+		DirectX::DDSLayout Layout;
+		const std::uint8_t* Bits = nullptr;
+
+		const std::uint8_t* Data(std::size_t subresource)const;
+	};
+
+	TextureArchive() = default;
+	TextureArchive(const TextureArchive& rhs) = delete;
+	TextureArchive& operator=(const TextureArchive& rhs) = delete;
+
+	// Maps fileName and checks its header and index.  Returns false with a description
+	// in error on failure.
+	bool Open(const std::string& fileName, std::string& error);
+	void Close();
+	bool IsOpen()const;
+
+	std::uint32_t EntryCount()const;
+
+	// Index of the entry named name, or NotFound.
+	std::uint32_t Find(const std::string& name)const;
+
+	// Normalized name of an entry.
+	std::string Name(std::uint32_t entry)const;
+
+	// The entry's DDS file as stored, headers included.  The DDS headers are never
+	// compressed.
+	const std::uint8_t* EntryData(std::uint32_t entry, std::size_t* size)const;
+
+	bool IsCompressed(std::uint32_t entry)const;
+
+	// Describes the subresources of the entry no larger than maxsize, as the DDS loaders
+	// would keep them.
+	bool GetTexture(std::uint32_t entry, std::uint32_t maxsize, TextureView& view, std::string& error)const;
+
+	// Writes the subresources of view, which GetTexture returned for entry, to dest
+	// back to back in Layout order: view.Layout.KeptBytes in all.  Compressed chunks are
+	// decoded on jobs if given.
+	bool ReadTexture(std::uint32_t entry, const TextureView& view, std::uint8_t* dest,
+		JobSystem* jobs, std::string& error)const;
+
+	// Starts reading the stored bytes of view's subresources from disk before they are
+	// touched.
+	void Prefetch(std::uint32_t entry, const TextureView& view)const;
+
+	// Lower case with '/' separators, so "Textures\\Bricks.dds" and "textures/bricks.dds"
+	// name the same entry.
+	static std::string NormalizeName(const std::string& name);
+
+	// 64-bit FNV-1a of the normalized name.
+	static std::uint64_t HashName(const std::string& name);
+
+private:
+	const TextureArchiveIndexEntry& IndexEntry(std::uint32_t entry)const;
+	const TextureArchiveEntryHeader* EntryHeader(std::uint32_t entry)const;
+
+	// The chunk table of a compressed entry, checked against the stored size.
+	bool GetChunks(std::uint32_t entry, const TextureArchiveChunkTable** table,
+		const TextureArchiveChunk** chunks, const std::uint8_t** chunkData)const;
+
+private:
+	MappedFile mFile;
+	const TextureArchiveHeader* mHeader = nullptr;
+	const TextureArchiveIndexEntry* mIndex = nullptr;
+	const char* mNames = nullptr;
+};
+
+// Collects DDS files and writes them out as a TextureArchive.
+class TextureArchiveBuilder
+{
+public:
+	// Adds the DDS file fileName under name.  Only its headers are read now; the file
+	// is copied by Write.  Returns false with a description in error if the file is
+	// not a DDS file the loaders accept or name is already taken.
+	bool AddFile(const std::string& name, const std::string& fileName, std::string& error);
+
+	// Adds a DDS file held in memory.  data is copied.
+	bool AddMemory(const std::string& name, const std::uint8_t* data, std::size_t size, std::string& error);
+
+	std::size_t EntryCount()const;
+
+	// Makes Write store bit data as Lz4 chunks of chunkSize bytes.  Entries that do not
+	// shrink by at least 1/16 are still stored uncompressed.
+	void SetCompression(bool enabled, std::uint32_t chunkSize = 64 * 1024);
+
+	// Compresses on jobs if given.
+	bool Write(const std::string& fileName, std::string& error, JobSystem* jobs = nullptr)const;
+
+private:
+	struct Entry
+	{
+		std::string Name;
+		std::uint64_t NameHash = 0;
+		std::string SourceFile;         // Empty for AddMemory entries.
+		std::vector<std::uint8_t> Data; // AddMemory entries only.
+		std::uint64_t DataSize = 0;
+		std::uint32_t BitsOffset = 0;
+	};
+
+	bool AddEntry(Entry& entry, std::string& error);
+
+	// Builds the stored form of a compressed entry, or returns false if compression
+	// does not pay.
+	bool Compress(const Entry& entry, const std::uint8_t* data, std::vector<std::uint8_t>& stored,
+		JobSystem* jobs)const;
+
+private:
+	std::vector<Entry> mEntries;
+	bool mCompress = false;
+	std::uint32_t mChunkSize = 64 * 1024;
+};
@@ -0,0 +1,294 @@
+//***************************************************************************************
+// TextureCache.cpp
+//***************************************************************************************
+
+#include "TextureCache.h"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+using namespace DirectX;
+
+TextureCache::TextureCache(IBackend& backend, std::uint64_t budgetBytes, std::uint32_t minMipSize)
+	: mBackend(backend), mBudget(budgetBytes), mMinMipSize(std::max<std::uint32_t>(minMipSize, 1))
+{
+}
+
+TextureCache::~TextureCache()
+{
+	for(Entry& entry : mEntries)
+	{
+		if(entry.Live)
+			mBackend.Release(entry.Texture);
+	}
+}
+
+void TextureCache::SetBudget(std::uint64_t budgetBytes)
+{
+	mBudget = budgetBytes;
+}
+
+std::uint64_t TextureCache::Budget()const
+{
+	return mBudget;
+}
+
+TextureCache::Handle TextureCache::Acquire(const std::string& fileName, std::uint32_t maxsize)
+{
+	std::string key = MakeKey(fileName, maxsize);
+
+	auto found = mKeys.find(key);
+	if(found != mKeys.end())
+	{
+		++mStats.Hits;
+
+		Entry& entry = Get(found->second);
+		++entry.Refs;
+		Touch(entry, found->second);
+		return found->second;
+	}
+
+	++mStats.Misses;
+
+	Handle handle;
+	if(!mFreeHandles.empty())
+	{
+		handle = mFreeHandles.back();
+		mFreeHandles.pop_back();
+	}
+	else
+	{
+		mEntries.emplace_back();
+		handle = (Handle)mEntries.size();
+	}
+
+	Entry& entry = mEntries[handle - 1];
+	entry.Key = key;
+	entry.RequestedMaxSize = maxsize;
+	entry.MaxSize = maxsize;
+	entry.Texture = mBackend.Load(fileName, maxsize);
+	entry.Refs = 1;
+	entry.Live = true;
+
+	mLru.push_front(handle);
+	entry.Lru = mLru.begin();
+	mKeys.emplace(std::move(key), handle);
+	++mStats.Entries;
+
+	return handle;
+}
+
+void TextureCache::Release(Handle handle)
+{
+	Entry& entry = Get(handle);
+	assert(entry.Refs > 0 && "TextureCache::Release without a matching Acquire");
+	--entry.Refs;
+}
+
+std::uint32_t TextureCache::Use(Handle handle)
+{
+	Entry& entry = Get(handle);
+	Touch(entry, handle);
+	return entry.Texture;
+}
+
+void TextureCache::Update()
+{
+	for(Entry& entry : mEntries)
+	{
+		if(entry.Live && !entry.SizeKnown && mBackend.GetDesc(entry.Texture, entry.Desc))
+		{
+			entry.SizeKnown = true;
+			Charge(entry, entry.MaxSize);
+		}
+	}
+
+	EnforceBudget();
+}
+
+std::uint64_t TextureCache::Bytes(Handle handle)const
+{
+	return Get(handle).Bytes;
+}
+
+std::uint32_t TextureCache::CurrentMaxSize(Handle handle)const
+{
+	return Get(handle).MaxSize;
+}
+
+const TextureCache::Stats& TextureCache::GetStats()const
+{
+	return mStats;
+}
+
+void TextureCache::ResetStats()
+{
+	mStats.Hits = 0;
+	mStats.Misses = 0;
+	mStats.Evictions = 0;
+	mStats.MipDrops = 0;
+	mStats.MipRestores = 0;
+	mStats.OverBudgetFrames = 0;
+	mStats.PeakBytes = mStats.UsedBytes;
+}
+
+std::uint64_t TextureCache::Footprint(const DDSTextureDesc& desc, std::uint32_t maxsize)
+{
+	DDSLayout layout;
+	return GetDDSLayout(desc, maxsize, layout) ? layout.KeptBytes : 0;
+}
+
+TextureCache::Entry& TextureCache::Get(Handle handle)
+{
+	assert(handle != InvalidHandle && handle <= mEntries.size() && mEntries[handle - 1].Live);
+	return mEntries[handle - 1];
+}
+
+const TextureCache::Entry& TextureCache::Get(Handle handle)const
+{
+	assert(handle != InvalidHandle && handle <= mEntries.size() && mEntries[handle - 1].Live);
+	return mEntries[handle - 1];
+}
+
+void TextureCache::Touch(Entry& entry, Handle handle)
+{
+	assert(*entry.Lru == handle);
+	mLru.splice(mLru.begin(), mLru, entry.Lru);
+}
+
+void TextureCache::Evict(Handle handle)
+{
+	Entry& entry = Get(handle);
+	mBackend.Release(entry.Texture);
+
+	mStats.UsedBytes -= entry.Bytes;
+	mKeys.erase(entry.Key);
+	mLru.erase(entry.Lru);
+
+	entry = Entry();
+	mFreeHandles.push_back(handle);
+
+	++mStats.Evictions;
+	--mStats.Entries;
+}
+
+void TextureCache::Charge(Entry& entry, std::uint32_t maxSize)
+{
+	std::uint64_t bytes = Footprint(entry.Desc, maxSize);
+
+	mStats.UsedBytes = mStats.UsedBytes - entry.Bytes + bytes;
+	mStats.PeakBytes = std::max(mStats.PeakBytes, mStats.UsedBytes);
+
+	entry.Bytes = bytes;
+	entry.MaxSize = maxSize;
+}
+
+bool TextureCache::Shrink(Entry& entry)
+{
+	if(!entry.SizeKnown)
+		return false;
+
+	DDSLayout layout;
+	if(!GetDDSLayout(entry.Desc, entry.MaxSize, layout) || layout.MipCount <= 1)
+		return false;
+
+	// A maxsize of half the current top mip keeps exactly the mips below it.
+	const DDSSubresource& top = layout.Subresources[0];
+	std::uint32_t maxSize = std::max({ top.Width, top.Height, top.Depth }) / 2;
+	if(maxSize < mMinMipSize)
+		return false;
+
+	Charge(entry, maxSize);
+	mBackend.Resize(entry.Texture, maxSize);
+	++mStats.MipDrops;
+	return true;
+}
+
+bool TextureCache::GrowOne()
+{
+	// Only the most recently used shrunk texture is considered, so a large texture that
+	// does not fit cannot be passed over in favor of less important ones.
+	for(Handle handle : mLru)
+	{
+		Entry& entry = Get(handle);
+		if(!entry.SizeKnown || entry.MaxSize == entry.RequestedMaxSize)
+			continue;
+
+		DDSLayout layout;
+		if(!GetDDSLayout(entry.Desc, entry.MaxSize, layout))
+			continue;
+
+		// The next mip up is the last one dropped; the maxsize that keeps it is its
+		// largest dimension, taken from the mip chain since twice the current top mip
+		// falls one short of an odd dimension.
+		std::uint32_t maxSize = entry.RequestedMaxSize;
+		if(layout.SkipMip > 1)
+		{
+			std::uint32_t mip = layout.SkipMip - 1;
+			std::uint32_t size = std::max({ std::max(entry.Desc.Width >> mip, 1u),
+				std::max(entry.Desc.Height >> mip, 1u), std::max(entry.Desc.Depth >> mip, 1u) });
+			if(entry.RequestedMaxSize == 0 || size < entry.RequestedMaxSize)
+				maxSize = size;
+		}
+
+		// The requested maxsize may keep no more mips than the current one; the entry is
+		// then not really shrunk and the backend has nothing to reload.
+		DDSLayout grown;
+		if(!GetDDSLayout(entry.Desc, maxSize, grown))
+			continue;
+		if(grown.MipCount == layout.MipCount)
+		{
+			entry.MaxSize = maxSize;
+			continue;
+		}
+
+		if(mStats.UsedBytes - entry.Bytes + grown.KeptBytes > mBudget)
+			return false;
+
+		Charge(entry, maxSize);
+		mBackend.Resize(entry.Texture, maxSize);
+		++mStats.MipRestores;
+		return true;
+	}
+
+	return false;
+}
+
+void TextureCache::EnforceBudget()
+{
+	if(mStats.UsedBytes <= mBudget)
+	{
+		GrowOne();
+		return;
+	}
+
+	// Unreferenced entries go first, least recently used first.
+	for(auto it = mLru.end(); it != mLru.begin() && mStats.UsedBytes > mBudget; )
+	{
+		auto current = std::prev(it);
+		if(Get(*current).Refs == 0)
+			Evict(*current); // Leaves it valid.
+		else
+			it = current;
+	}
+
+	// Then referenced textures give up their top mip, one per texture per sweep.
+	bool shrunk = true;
+	while(mStats.UsedBytes > mBudget && shrunk)
+	{
+		shrunk = false;
+		for(auto it = mLru.rbegin(); it != mLru.rend() && mStats.UsedBytes > mBudget; ++it)
+		{
+			if(Shrink(Get(*it)))
+				shrunk = true;
+		}
+	}
+
+	if(mStats.UsedBytes > mBudget)
+		++mStats.OverBudgetFrames;
+}
+
+std::string TextureCache::MakeKey(const std::string& fileName, std::uint32_t maxsize)
+{
+	return fileName + '|' + std::to_string(maxsize);
+}
@@ -0,0 +1,139 @@
+//***************************************************************************************
+// TextureCache.h
+//
+// Deduplicating front end for texture loads with a memory budget.  Textures are keyed by
+// file name and maxsize; acquiring a key that is already cached returns the same entry
+// (a hit) instead of loading the file again.  Each entry is charged the bytes of the
+// mips it keeps, computed from its DDS header with GetSurfaceInfo.
+//
+// Update, once per frame, brings the total back under the budget.  Unreferenced
+// entries are evicted first, least recently used first.  If that is not enough,
+// referenced textures lose their top mip, again least recently used first, one mip per
+// texture per sweep and never below minMipSize.  While there is room the most recently
+// used shrunk texture gets one mip back per frame.
+//
+// The cache only decides.  Loading, shrinking and freeing are done by an IBackend, so
+// the policy has no Direct3D dependency (see D3D12TextureCacheBackend).
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSFormat.h"
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TextureCache
+{
+public:
+	using Handle = std::uint32_t;
+	static const Handle InvalidHandle = 0;
+
+	class IBackend
+	{
+	public:
+		virtual ~IBackend() = default;
+
+		// Starts loading fileName keeping the mips no larger than maxsize, and returns an
+		// id for the texture.
+		virtual std::uint32_t Load(const std::string& fileName, std::uint32_t maxsize) = 0;
+
+		// Replaces the texture's mips by those no larger than maxsize.  The id stays valid.
+		virtual void Resize(std::uint32_t texture, std::uint32_t maxsize) = 0;
+
+		// Frees the texture.  The id is not used again.
+		virtual void Release(std::uint32_t texture) = 0;
+
+		// The texture's file description once its header has been read.
+		virtual bool GetDesc(std::uint32_t texture, DirectX::DDSTextureDesc& desc) = 0;
+	};
+
+	struct Stats
+	{
+		std::uint64_t Hits = 0;
+		std::uint64_t Misses = 0;
+		std::uint64_t Evictions = 0;
+		std::uint64_t MipDrops = 0;
+		std::uint64_t MipRestores = 0;
+		std::uint64_t OverBudgetFrames = 0; // Updates that could not get under budget.
+		std::uint64_t UsedBytes = 0;
+		std::uint64_t PeakBytes = 0;
+		std::uint32_t Entries = 0;
+	};
+
+	TextureCache(IBackend& backend, std::uint64_t budgetBytes, std::uint32_t minMipSize = 64);
+	TextureCache(const TextureCache& rhs) = delete;
+	TextureCache& operator=(const TextureCache& rhs) = delete;
+	~TextureCache();
+
+	void SetBudget(std::uint64_t budgetBytes);
+	std::uint64_t Budget()const;
+
+	// Returns the entry for (fileName, maxsize), loading it on a miss.  Every Acquire
+	// needs a matching Release.
+	Handle Acquire(const std::string& fileName, std::uint32_t maxsize = 0);
+
+	// Drops a reference.  The entry stays cached until the budget needs its memory.
+	void Release(Handle handle);
+
+	// Marks the entry most recently used and returns its backend texture id.
+	std::uint32_t Use(Handle handle);
+
+	// Charges newly parsed textures, then evicts or shrinks until under budget.
+	void Update();
+
+	// Bytes charged to the entry; 0 until its header has been read.
+	std::uint64_t Bytes(Handle handle)const;
+
+	// maxsize currently applied to the entry, which is below the requested one while
+	// the entry is shrunk.  0 means all mips.
+	std::uint32_t CurrentMaxSize(Handle handle)const;
+
+	const Stats& GetStats()const;
+
+	// Clears the hit, miss, eviction and mip counters.
+	void ResetStats();
+
+	// Bytes of the mips of desc no larger than maxsize, as the loaders would keep them.
+	static std::uint64_t Footprint(const DirectX::DDSTextureDesc& desc, std::uint32_t maxsize);
+
+private:
+	struct Entry
+	{
+		std::string Key;
+		std::uint32_t RequestedMaxSize = 0;
+		std::uint32_t MaxSize = 0;
+		std::uint32_t Texture = 0;
+		std::uint32_t Refs = 0;
+		std::uint64_t Bytes = 0;
+		bool SizeKnown = false;
+		bool Live = false;
+		DirectX::DDSTextureDesc Desc;
+		std::list<Handle>::iterator Lru;
+	};
+
+	Entry& Get(Handle handle);
+	const Entry& Get(Handle handle)const;
+	void Touch(Entry& entry, Handle handle);
+	void Evict(Handle handle);
+	void Charge(Entry& entry, std::uint32_t maxSize);
+	bool Shrink(Entry& entry);
+	bool GrowOne();
+	void EnforceBudget();
+
+	static std::string MakeKey(const std::string& fileName, std::uint32_t maxsize);
+
+private:
+	IBackend& mBackend;
+	std::uint64_t mBudget;
+	std::uint32_t mMinMipSize;
+
+	std::vector<Entry> mEntries; // Indexed by handle - 1.
+	std::vector<Handle> mFreeHandles;
+	std::unordered_map<std::string, Handle> mKeys;
+	std::list<Handle> mLru; // Most recently used first.
+
+	Stats mStats;
+};
@@ -0,0 +1,378 @@
+//***************************************************************************************
+// TextureStreamer.cpp
+//***************************************************************************************
+
+#include "TextureStreamer.h"
+#include "GameTimer.h"
+#include "MappedFile.h"
+#include <cassert>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+	// Handles hold slot index + 1 in the low bits, so none is 0, and the slot's
+	// generation in the rest.
+	const std::uint32_t SlotBits = 20;
+
+	TextureStreamer::Handle MakeHandle(std::uint32_t slot, std::uint32_t generation)
+	{
+		return (generation << SlotBits) | (slot + 1);
+	}
+}
+
+TextureStreamer::TextureStreamer(unsigned workerCount, const TextureArchive* archive)
+	: mArchive(archive), mWorkers(std::make_unique<JobSystem>(workerCount == 0 ? 1 : workerCount))
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mShuttingDown = true;
+	}
+
+	// Joins the workers.  Jobs still queued see mShuttingDown and return at once.
+	mWorkers.reset();
+}
+
+TextureStreamer::Handle TextureStreamer::Request(const std::string& fileName, std::uint32_t maxsize)
+{
+	Handle handle;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		std::uint32_t slot;
+		if(!mFreeSlots.empty())
+		{
+			slot = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		}
+		else
+		{
+			if(mEntries.size() >= MaxSlots)
+				return InvalidHandle;
+
+			slot = (std::uint32_t)mEntries.size();
+			mEntries.emplace_back();
+		}
+
+		Entry& entry = mEntries[slot];
+		entry.FileName = fileName;
+		entry.MaxSize = maxsize;
+		handle = MakeHandle(slot, entry.Generation);
+
+		++mStats.Requests;
+	}
+
+	mWorkers->Schedule([this, handle]() { Load(handle); }, &mPending);
+	return handle;
+}
+
+void TextureStreamer::Release(Handle handle)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	Entry* entry = Find(handle);
+	if(entry == nullptr)
+		return;
+
+	entry->Released = true;
+	switch(entry->Status)
+	{
+	case State::Queued:
+	case State::Loading:
+		// Load frees the slot when its job runs or finishes.
+		break;
+	case State::Uploading:
+		// MarkResident or MarkFailed frees the slot.
+		break;
+	case State::Loaded:
+		for(auto it = mLoaded.begin(); it != mLoaded.end(); ++it)
+		{
+			if(it->Id == handle)
+			{
+				mLoaded.erase(it);
+				break;
+			}
+		}
+		FreeSlot(handle);
+		break;
+	default:
+		FreeSlot(handle);
+		break;
+	}
+}
+
+std::uint32_t TextureStreamer::SlotIndex(Handle handle)
+{
+	return (handle & MaxSlots) - 1;
+}
+
+TextureStreamer::State TextureStreamer::GetState(Handle handle)const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	const Entry* entry = Find(handle);
+	return (entry != nullptr) ? entry->Status : State::Invalid;
+}
+
+std::string TextureStreamer::GetError(Handle handle)const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	const Entry* entry = Find(handle);
+	return (entry != nullptr) ? entry->Error : std::string();
+}
+
+bool TextureStreamer::GetDesc(Handle handle, DDSTextureDesc& desc)const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	const Entry* entry = Find(handle);
+	if(entry == nullptr)
+		return false;
+
+	switch(entry->Status)
+	{
+	case State::Loaded:
+	case State::Uploading:
+	case State::Resident:
+		desc = entry->Desc;
+		return true;
+	default:
+		return false;
+	}
+}
+
+std::size_t TextureStreamer::TakeLoaded(std::vector<LoadedTexture>& loaded, std::uint64_t maxBytes)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::size_t count = 0;
+	std::uint64_t bytes = 0;
+	while(!mLoaded.empty())
+	{
+		std::uint64_t size = mLoaded.front().Bits.size();
+		if(count > 0 && bytes + size > maxBytes)
+			break;
+
+		mEntries[SlotIndex(mLoaded.front().Id)].Status = State::Uploading;
+		loaded.push_back(std::move(mLoaded.front()));
+		mLoaded.pop_front();
+
+		bytes += size;
+		++count;
+	}
+
+	return count;
+}
+
+void TextureStreamer::MarkResident(Handle handle)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	Entry* entry = Find(handle, true);
+	assert(entry != nullptr && entry->Status == State::Uploading);
+
+	entry->Status = State::Resident;
+	++mStats.Resident;
+	if(entry->Released)
+		FreeSlot(handle);
+}
+
+void TextureStreamer::MarkFailed(Handle handle, const std::string& error)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	Entry* entry = Find(handle, true);
+	assert(entry != nullptr && entry->Status == State::Uploading);
+
+	entry->Status = State::Failed;
+	entry->Error = error;
+	++mStats.Failed;
+	if(entry->Released)
+		FreeSlot(handle);
+}
+
+void TextureStreamer::WaitIdle()
+{
+	mWorkers->Wait(mPending);
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats()const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+void TextureStreamer::Load(Handle handle)
+{
+	std::string fileName;
+	std::uint32_t maxsize;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(mShuttingDown)
+			return;
+
+		// The slot stays reserved for this job until it runs, so the handle is live.
+		Entry& entry = mEntries[SlotIndex(handle)];
+		if(entry.Released)
+		{
+			FreeSlot(handle);
+			return;
+		}
+
+		entry.Status = State::Loading;
+		fileName = entry.FileName;
+		maxsize = entry.MaxSize;
+	}
+
+	std::int64_t start = GameTimer::Now();
+
+	LoadedTexture texture;
+	texture.Id = handle;
+	std::string error;
+	std::uint32_t archived = (mArchive != nullptr) ? mArchive->Find(fileName) : TextureArchive::NotFound;
+	bool ok = (archived != TextureArchive::NotFound)
+		? LoadTexture(*mArchive, archived, maxsize, texture, error, mWorkers.get())
+		: LoadTexture(fileName, maxsize, texture, error);
+
+	std::int64_t elapsed = GameTimer::Now() - start;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	Entry& entry = mEntries[SlotIndex(handle)];
+	mStats.LoadNs += elapsed;
+	if(entry.Released)
+	{
+		FreeSlot(handle);
+		return;
+	}
+
+	if(ok)
+	{
+		entry.Status = State::Loaded;
+		entry.Desc = texture.Desc;
+		mStats.BytesLoaded += texture.Bits.size();
+		++mStats.Loaded;
+		mLoaded.push_back(std::move(texture));
+	}
+	else
+	{
+		entry.Status = State::Failed;
+		entry.Error = std::move(error);
+		++mStats.Failed;
+	}
+}
+
+TextureStreamer::Entry* TextureStreamer::Find(Handle handle, bool includeReleased)
+{
+	std::uint32_t slot = SlotIndex(handle);
+	if(handle == InvalidHandle || slot >= mEntries.size())
+		return nullptr;
+
+	Entry& entry = mEntries[slot];
+	if((entry.Released && !includeReleased) || MakeHandle(slot, entry.Generation) != handle)
+		return nullptr;
+
+	return &entry;
+}
+
+const TextureStreamer::Entry* TextureStreamer::Find(Handle handle)const
+{
+	return const_cast<TextureStreamer*>(this)->Find(handle);
+}
+
+void TextureStreamer::FreeSlot(Handle handle)
+{
+	std::uint32_t slot = SlotIndex(handle);
+
+	// Drops the strings too, so a long session does not keep every name it loaded.
+	Entry& entry = mEntries[slot];
+	std::uint32_t generation = (entry.Generation + 1) & ((1u << (32 - SlotBits)) - 1);
+	entry = Entry();
+	entry.Generation = generation;
+	mFreeSlots.push_back(slot);
+}
+
+bool TextureStreamer::LoadTexture(const std::string& fileName, std::uint32_t maxsize,
+	LoadedTexture& texture, std::string& error)
+{
+	MappedFile file;
+	if(!file.Open(fileName.c_str()))
+	{
+		error = "cannot open " + fileName + " (error " + std::to_string(file.LastError()) + ")";
+		return false;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	std::size_t headerSize = 0;
+	if(!ValidateDDSHeader(file.Data(), file.Size(), &header, &headerSize))
+	{
+		error = fileName + " is not a DDS file";
+		return false;
+	}
+
+	switch(GetDDSTextureDesc(header, texture.Desc))
+	{
+	case DDSStatus::Ok:
+		break;
+	case DDSStatus::InvalidData:
+		error = fileName + " has an invalid DDS header";
+		return false;
+	default:
+		error = fileName + " has an unsupported format or size";
+		return false;
+	}
+
+	if(!GetDDSLayout(texture.Desc, maxsize, texture.Layout))
+	{
+		error = fileName + " has no mip within maxsize";
+		return false;
+	}
+
+	if(texture.Layout.TotalBytes > file.Size() - headerSize)
+	{
+		error = fileName + " is truncated";
+		return false;
+	}
+
+	// Only the kept subresources are read; pages holding skipped mips are never touched.
+	// Start the reads for all of them before copying the first.
+	for(const DDSSubresource& sub : texture.Layout.Subresources)
+		file.Prefetch(headerSize + (std::size_t)sub.Offset, (std::size_t)sub.Size);
+
+	texture.Bits.resize((std::size_t)texture.Layout.KeptBytes);
+
+	std::uint64_t offset = 0;
+	for(DDSSubresource& sub : texture.Layout.Subresources)
+	{
+		std::memcpy(texture.Bits.data() + offset, file.Data() + headerSize + sub.Offset, (std::size_t)sub.Size);
+		sub.Offset = offset;
+		offset += sub.Size;
+	}
+
+	return true;
+}
+
+bool TextureStreamer::LoadTexture(const TextureArchive& archive, std::uint32_t entry, std::uint32_t maxsize,
+	LoadedTexture& texture, std::string& error, JobSystem* jobs)
+{
+	TextureArchive::TextureView view;
+	if(!archive.GetTexture(entry, maxsize, view, error))
+		return false;
+
+	archive.Prefetch(entry, view);
+
+	texture.Desc = view.Desc;
+	texture.Layout = view.Layout;
+	texture.Bits.resize((std::size_t)texture.Layout.KeptBytes);
+
+	if(!archive.ReadTexture(entry, view, texture.Bits.data(), jobs, error))
+		return false;
+
+	std::uint64_t offset = 0;
+	for(DDSSubresource& sub : texture.Layout.Subresources)
+	{
+		sub.Offset = offset;
+		offset += sub.Size;
+	}
+
+	return true;
+}
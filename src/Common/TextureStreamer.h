@@ -0,0 +1,164 @@
+//***************************************************************************************
+// TextureStreamer.h
+//
+// Loads DDS textures off the render thread.  Request queues a file and returns a handle
+// straight away; worker threads map the file, parse its headers and copy the
+// subresources that survive maxsize into a CPU buffer.  The render thread collects the
+// finished loads with TakeLoaded, uploads them (see D3D12TextureStreamer) and reports
+// each one with MarkResident once the GPU copy has completed.
+//
+// Given a TextureArchive, requests for names the archive holds are served from its
+// mapping instead of opening the loose file.  The chunks of compressed entries are
+// decoded in parallel on the workers, straight into the buffer that is uploaded.
+//
+// Nothing here touches Direct3D, so the I/O and parse stages run on any platform.  The
+// workers are a JobSystem of their own: they block on disk reads, which must not hold
+// up the frame's recording jobs.
+//
+// A handle is a slot index and a generation.  Release puts the slot back on a free
+// list once no stage is using it, and the next Request to take the slot bumps its
+// generation, so a released handle reads as Invalid instead of aliasing the new one.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSFormat.h"
+#include "JobSystem.h"
+#include "TextureArchive.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class TextureStreamer
+{
+public:
+	using Handle = std::uint32_t;
+	static const Handle InvalidHandle = 0;
+
+	// Live handles at most; Request returns InvalidHandle beyond that.
+	static const std::uint32_t MaxSlots = (1u << 20) - 1;
+
+	enum class State
+	{
+		Invalid,   // Not a handle this streamer returned.
+		Queued,
+		Loading,
+		Loaded,    // Parsed, waiting for TakeLoaded.
+		Uploading, // Taken by the upload stage.
+		Resident,
+		Failed
+	};
+
+	// A parsed texture ready for upload.  Desc describes the file; Layout lists the
+	// subresources that were kept, with offsets rebased onto Bits, which holds them
+	// back to back.
+	struct LoadedTexture
+	{
+		Handle Id = InvalidHandle;
+		DirectX::DDSTextureDesc Desc;
+		DirectX::DDSLayout Layout;
+		std::vector<std::uint8_t> Bits;
+	};
+
+	struct Stats
+	{
+		std::uint64_t Requests = 0;
+		std::uint64_t Loaded = 0;
+		std::uint64_t Failed = 0;
+		std::uint64_t Resident = 0;
+		std::uint64_t BytesLoaded = 0;
+		std::int64_t LoadNs = 0; // Summed over all workers.
+	};
+
+	// archive, if given, must stay open while the streamer exists.
+	explicit TextureStreamer(unsigned workerCount = 2, const TextureArchive* archive = nullptr);
+	TextureStreamer(const TextureStreamer& rhs) = delete;
+	TextureStreamer& operator=(const TextureStreamer& rhs) = delete;
+	// Requests that have not started are dropped; loads in progress finish first.
+	~TextureStreamer();
+
+	// Queues a load of fileName.  maxsize has the meaning it has for the DDS loaders.
+	// May be called from any thread.
+	Handle Request(const std::string& fileName, std::uint32_t maxsize = 0);
+
+	// Gives the handle up; it reads as Invalid from now on.  A queued load is skipped,
+	// a load in progress or a loaded texture not yet taken is discarded, and a taken
+	// texture keeps its slot until the upload stage reports it with MarkResident or
+	// MarkFailed.  Released or stale handles are ignored.
+	void Release(Handle handle);
+
+	// The slot behind a handle, below the number of handles live at once.  Lets the
+	// upload stage keep per-handle data in a vector without growing it per Request.
+	static std::uint32_t SlotIndex(Handle handle);
+
+	State GetState(Handle handle)const;
+
+	// Why a load failed; empty unless the state is Failed.
+	std::string GetError(Handle handle)const;
+
+	// The description of the file, available from Loaded on.  Returns false before.
+	bool GetDesc(Handle handle, DirectX::DDSTextureDesc& desc)const;
+
+	// Moves finished loads into loaded, oldest first, and marks them Uploading.  Stops
+	// once the bits taken reach maxBytes, but always takes one texture if any is ready
+	// so a texture larger than maxBytes still gets through.  Returns the number taken.
+	std::size_t TakeLoaded(std::vector<LoadedTexture>& loaded, std::uint64_t maxBytes = UINT64_MAX);
+
+	// Called by the upload stage once the GPU copy of a taken texture has completed.
+	void MarkResident(Handle handle);
+
+	// Called by the upload stage when a taken texture cannot be created.
+	void MarkFailed(Handle handle, const std::string& error);
+
+	// Blocks until no request is queued or loading, running loads on the calling thread
+	// in the meantime.
+	void WaitIdle();
+
+	Stats GetStats()const;
+
+	// The I/O and parse stages on their own: synchronously loads fileName into texture.
+	// Returns false with a description in error on failure.
+	static bool LoadTexture(const std::string& fileName, std::uint32_t maxsize,
+		LoadedTexture& texture, std::string& error);
+
+	// The same for an entry of an archive.  Compressed chunks are decoded on jobs if
+	// given.
+	static bool LoadTexture(const TextureArchive& archive, std::uint32_t entry, std::uint32_t maxsize,
+		LoadedTexture& texture, std::string& error, JobSystem* jobs = nullptr);
+
+private:
+	struct Entry
+	{
+		std::string FileName;
+		std::uint32_t MaxSize = 0;
+		State Status = State::Queued;
+		std::string Error;
+		DirectX::DDSTextureDesc Desc;
+		std::uint32_t Generation = 0;
+		bool Released = false;
+	};
+
+	void Load(Handle handle);
+
+	// The entry of a live handle, or null.  A released handle whose slot is still
+	// held by a stage counts as live if includeReleased is set.  mMutex must be held.
+	Entry* Find(Handle handle, bool includeReleased = false);
+	const Entry* Find(Handle handle)const;
+	void FreeSlot(Handle handle);
+
+private:
+	const TextureArchive* mArchive = nullptr;
+
+	mutable std::mutex mMutex;
+	std::deque<Entry> mEntries; // Indexed by SlotIndex(handle).
+	std::vector<std::uint32_t> mFreeSlots;
+	std::deque<LoadedTexture> mLoaded;
+	Stats mStats;
+	bool mShuttingDown = false;
+
+	JobCounter mPending;
+	std::unique_ptr<JobSystem> mWorkers;
+};
@@ -0,0 +1,238 @@
+//***************************************************************************************
+// UploadBatcher.cpp
+//***************************************************************************************
+
+#include "UploadBatcher.h"
+
+using Microsoft::WRL::ComPtr;
+
+UploadBatcher::UploadBatcher(ID3D12Device* device, IFence* fence, UINT64 capacity)
+	: md3dDevice(device), mFence(fence), mRing((std::size_t)capacity)
+{
+	ThrowIfFailed(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(capacity),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(mUploadHeap.GetAddressOf())));
+
+	// Stays mapped for the lifetime of the batcher.  The ring and the fence make sure
+	// we never write to a range the GPU may still be reading.
+	ThrowIfFailed(mUploadHeap->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
+}
+
+UploadBatcher::~UploadBatcher()
+{
+	if(mUploadHeap != nullptr)
+		mUploadHeap->Unmap(0, nullptr);
+	mMappedData = nullptr;
+}
+
+void UploadBatcher::SetHeapAllocator(GpuHeapAllocator* heapAllocator)
+{
+	mHeapAllocator = heapAllocator;
+}
+
+void UploadBatcher::Begin(ID3D12GraphicsCommandList* cmdList)
+{
+	assert(mCommandList == nullptr && "UploadBatcher::Begin called twice without End");
+
+	mCommandList = cmdList;
+	Retire();
+}
+
+UINT64 UploadBatcher::End()
+{
+	assert(mCommandList != nullptr && "UploadBatcher::End called without Begin");
+
+	UINT64 fenceValue = mFence->Signal();
+
+	mRing.Submit(fenceValue);
+	for(auto& d : mDedicated)
+	{
+		if(d.Fence == 0)
+			d.Fence = fenceValue;
+	}
+
+	mCommandList = nullptr;
+	return fenceValue;
+}
+
+void UploadBatcher::Retire()
+{
+	UINT64 completed = mFence->CompletedValue();
+
+	mRing.Retire(completed);
+
+	mDedicated.erase(std::remove_if(mDedicated.begin(), mDedicated.end(),
+		[completed](const DedicatedBuffer& d) { return d.Fence != 0 && d.Fence <= completed; }),
+		mDedicated.end());
+}
+
+UploadBatcher::Staging UploadBatcher::Stage(UINT64 byteSize, UINT64 alignment)
+{
+	Staging s;
+
+	std::size_t offset = mRing.Allocate((std::size_t)byteSize, (std::size_t)alignment);
+
+	// Out of ring space: wait for submitted batches to retire, oldest first.
+	while(offset == RingAllocator::InvalidOffset && mRing.PendingBatchCount() > 0)
+	{
+		++mStats.Stalls;
+		mFence->WaitFor(mRing.OldestPendingFence());
+		Retire();
+		offset = mRing.Allocate((std::size_t)byteSize, (std::size_t)alignment);
+	}
+
+	if(offset != RingAllocator::InvalidOffset)
+	{
+		s.Resource = mUploadHeap.Get();
+		s.Offset = offset;
+		s.CpuAddress = mMappedData + offset;
+		return s;
+	}
+
+	// Too large for the ring, or the open batch has used all of it.
+	DedicatedBuffer d;
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(d.Resource.GetAddressOf())));
+
+	// Released by fence like ring space; releasing the resource also unmaps it.
+	ThrowIfFailed(d.Resource->Map(0, nullptr, reinterpret_cast<void**>(&s.CpuAddress)));
+	s.Resource = d.Resource.Get();
+	s.Offset = 0;
+
+	mDedicated.push_back(d);
+	++mStats.DedicatedBuffers;
+	return s;
+}
+
+GpuAllocation UploadBatcher::CreateDefaultBuffer(
+	const void* data,
+	UINT64 byteSize,
+	D3D12_RESOURCE_STATES finalState)
+{
+	GpuAllocation defaultBuffer;
+
+	if(mHeapAllocator != nullptr)
+	{
+		defaultBuffer = mHeapAllocator->CreateBuffer(byteSize, D3D12_RESOURCE_STATE_COMMON);
+	}
+	else
+	{
+		ComPtr<ID3D12Resource> buffer;
+		ThrowIfFailed(md3dDevice->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(buffer.GetAddressOf())));
+		defaultBuffer = GpuAllocation(std::move(buffer));
+	}
+
+	if(defaultBuffer.IsShared())
+	{
+		// Other ranges of the shared buffer may be in use, so it gets no barriers: the
+		// copy promotes it to COPY_DEST and it decays back to COMMON after the batch.
+		UploadBuffer(defaultBuffer.Resource(), defaultBuffer.Offset(), data, byteSize,
+			D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_DEST);
+	}
+	else
+	{
+		UploadBuffer(defaultBuffer.Resource(), 0, data, byteSize, D3D12_RESOURCE_STATE_COMMON, finalState);
+	}
+
+	return defaultBuffer;
+}
+
+void UploadBatcher::UploadBuffer(
+	ID3D12Resource* dest,
+	UINT64 destOffset,
+	const void* data,
+	UINT64 byteSize,
+	D3D12_RESOURCE_STATES stateBefore,
+	D3D12_RESOURCE_STATES stateAfter)
+{
+	assert(mCommandList != nullptr && "UploadBatcher::UploadBuffer called outside Begin/End");
+
+	// Buffer copies have no placement requirement beyond 4 bytes; 16 keeps the CPU
+	// side memcpy aligned.
+	Staging s = Stage(byteSize, 16);
+	memcpy(s.CpuAddress, data, (size_t)byteSize);
+
+	if(stateBefore != D3D12_RESOURCE_STATE_COPY_DEST)
+		mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(dest,
+			stateBefore, D3D12_RESOURCE_STATE_COPY_DEST));
+
+	mCommandList->CopyBufferRegion(dest, destOffset, s.Resource, s.Offset, byteSize);
+
+	if(stateAfter != D3D12_RESOURCE_STATE_COPY_DEST)
+		mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(dest,
+			D3D12_RESOURCE_STATE_COPY_DEST, stateAfter));
+
+	mStats.BytesStaged += byteSize;
+	++mStats.BufferUploads;
+}
+
+void UploadBatcher::UploadTexture(
+	ID3D12Resource* dest,
+	UINT firstSubresource,
+	UINT numSubresources,
+	const D3D12_SUBRESOURCE_DATA* srcData,
+	D3D12_RESOURCE_STATES stateBefore,
+	D3D12_RESOURCE_STATES stateAfter)
+{
+	assert(mCommandList != nullptr && "UploadBatcher::UploadTexture called outside Begin/End");
+
+	D3D12_RESOURCE_DESC desc = dest->GetDesc();
+
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubresources);
+	std::vector<UINT> numRows(numSubresources);
+	std::vector<UINT64> rowSizes(numSubresources);
+	UINT64 totalBytes = 0;
+	md3dDevice->GetCopyableFootprints(&desc, firstSubresource, numSubresources, 0,
+		layouts.data(), numRows.data(), rowSizes.data(), &totalBytes);
+
+	Staging s = Stage(totalBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+	if(stateBefore != D3D12_RESOURCE_STATE_COPY_DEST)
+		mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(dest,
+			stateBefore, D3D12_RESOURCE_STATE_COPY_DEST));
+
+	for(UINT i = 0; i < numSubresources; ++i)
+	{
+		// The footprints were computed relative to offset 0; rebase them onto the
+		// staging slice.
+		D3D12_MEMCPY_DEST destData = {
+			s.CpuAddress + layouts[i].Offset,
+			layouts[i].Footprint.RowPitch,
+			SIZE_T(layouts[i].Footprint.RowPitch) * numRows[i] };
+		MemcpySubresource(&destData, &srcData[i], (SIZE_T)rowSizes[i], numRows[i], layouts[i].Footprint.Depth);
+
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = layouts[i];
+		footprint.Offset += s.Offset;
+
+		CD3DX12_TEXTURE_COPY_LOCATION dst(dest, firstSubresource + i);
+		CD3DX12_TEXTURE_COPY_LOCATION src(s.Resource, footprint);
+		mCommandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
+
+	if(stateAfter != D3D12_RESOURCE_STATE_COPY_DEST)
+		mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(dest,
+			D3D12_RESOURCE_STATE_COPY_DEST, stateAfter));
+
+	mStats.BytesStaged += totalBytes;
+	++mStats.TextureUploads;
+}
+
+const UploadBatcher::Stats& UploadBatcher::GetStats()const
+{
+	return mStats;
+}
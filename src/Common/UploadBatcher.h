@@ -0,0 +1,123 @@
+//***************************************************************************************
+// UploadBatcher.h
+//
+// Stages buffer and texture uploads through one persistently mapped upload heap
+// instead of a committed upload buffer per resource.  Staging space is handed out by a
+// RingAllocator; all copies between Begin and End are recorded into the caller's
+// command list, and End tags the batch with a fence value so its staging space is
+// reused once the GPU has executed the copies.
+//
+// When the ring is full the batcher first waits for the oldest submitted batch.  An
+// upload that still does not fit (larger than the heap, or the open batch has filled
+// it) gets a dedicated upload buffer that is released by the same fence rule.
+//
+// Typical use:
+//
+//   batcher.Begin(cmdList);
+//   vb = batcher.CreateDefaultBuffer(vertices, vbByteSize);
+//   ...
+//   cmdList->Close();
+//   queue->ExecuteCommandLists(...);
+//   batcher.End();
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "Fence.h"
+#include "GpuHeapAllocator.h"
+#include "RingAllocator.h"
+
+class UploadBatcher
+{
+public:
+	struct Stats
+	{
+		UINT64 BytesStaged = 0;
+		UINT32 BufferUploads = 0;
+		UINT32 TextureUploads = 0;
+		UINT32 Stalls = 0;          // Waits for an older batch to free ring space.
+		UINT32 DedicatedBuffers = 0; // Uploads that did not fit in the ring.
+	};
+
+	// fence must be signaled on the queue that executes the recorded command lists.
+	UploadBatcher(ID3D12Device* device, IFence* fence, UINT64 capacity = 32 * 1024 * 1024);
+	UploadBatcher(const UploadBatcher& rhs) = delete;
+	UploadBatcher& operator=(const UploadBatcher& rhs) = delete;
+	~UploadBatcher();
+
+	// When set, CreateDefaultBuffer places its buffers in the allocator's heaps
+	// instead of creating committed resources.
+	void SetHeapAllocator(GpuHeapAllocator* heapAllocator);
+
+	// Starts a batch recorded into cmdList, which must be open.  Frees the staging
+	// space of earlier batches the GPU has finished with.
+	void Begin(ID3D12GraphicsCommandList* cmdList);
+
+	// Creates a default heap buffer initialized with byteSize bytes of data.  The
+	// buffer is in finalState once the batch has executed, unless it is a shared buffer
+	// range: those are left in COMMON and promoted to finalState on first use.  With a
+	// heap allocator set the allocation holds a block of its heaps, so keep it until
+	// the GPU is done with the buffer.  Address the data at Resource() plus Offset().
+	GpuAllocation CreateDefaultBuffer(
+		const void* data,
+		UINT64 byteSize,
+		D3D12_RESOURCE_STATES finalState = D3D12_RESOURCE_STATE_GENERIC_READ);
+
+	// Copies data into dest at destOffset.  dest is transitioned from stateBefore to
+	// COPY_DEST and back to stateAfter around the copy.
+	void UploadBuffer(
+		ID3D12Resource* dest,
+		UINT64 destOffset,
+		const void* data,
+		UINT64 byteSize,
+		D3D12_RESOURCE_STATES stateBefore,
+		D3D12_RESOURCE_STATES stateAfter);
+
+	// Copies subresources [firstSubresource, firstSubresource + numSubresources) of a
+	// texture, with the same state handling as UploadBuffer.
+	void UploadTexture(
+		ID3D12Resource* dest,
+		UINT firstSubresource,
+		UINT numSubresources,
+		const D3D12_SUBRESOURCE_DATA* srcData,
+		D3D12_RESOURCE_STATES stateBefore,
+		D3D12_RESOURCE_STATES stateAfter);
+
+	// Call once the command list passed to Begin has been submitted to the queue.
+	// Signals the fence and returns the value that retires this batch's staging space.
+	UINT64 End();
+
+	const Stats& GetStats()const;
+
+private:
+	struct Staging
+	{
+		ID3D12Resource* Resource = nullptr;
+		UINT64 Offset = 0;
+		BYTE* CpuAddress = nullptr;
+	};
+
+	struct DedicatedBuffer
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		UINT64 Fence = 0; // 0 while the batch that uses it is still open.
+	};
+
+	Staging Stage(UINT64 byteSize, UINT64 alignment);
+	void Retire();
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Device> md3dDevice;
+	IFence* mFence = nullptr;
+	GpuHeapAllocator* mHeapAllocator = nullptr;
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> mUploadHeap;
+	BYTE* mMappedData = nullptr;
+	RingAllocator mRing;
+
+	std::vector<DedicatedBuffer> mDedicated;
+
+	ID3D12GraphicsCommandList* mCommandList = nullptr;
+	Stats mStats;
+};
@@ -3,6 +3,7 @@
 //***************************************************************************************
 
 #include "d3dApp.h"
+#include "D3D12Fence.h"
 #include <WindowsX.h>
 
 using Microsoft::WRL::ComPtr;
@@ -33,7 +34,7 @@ D3DApp::D3DApp(HINSTANCE hInstance)
 
 D3DApp::~D3DApp()
 {
-	if(md3dDevice != nullptr)
+	if(mFence != nullptr)
 		FlushCommandQueue();
 }
 
@@ -90,9 +91,25 @@ int D3DApp::Run()
 
 			if( !mAppPaused )
 			{
-				CalculateFrameStats();
-				Update(mTimer);	
+				mFrameStats.BeginFrame();
+
+				mFrameStats.BeginPhase(FrameStats::PhaseUpdate);
+				Update(mTimer);
+
+				if( mFixedTimestep )
+				{
+					int steps = mScheduler.Advance(mTimer.DeltaTimeNanoseconds());
+					float dt = (float)mScheduler.StepSeconds();
+					for(int i = 0; i < steps; ++i)
+						FixedUpdate(mTimer, dt);
+				}
+				mFrameStats.EndPhase(FrameStats::PhaseUpdate);
+
                 Draw(mTimer);
+
+				mFrameStats.AddFenceWait(mFence->TakeFrameWaitTime());
+				mFrameStats.EndFrame();
+				CalculateFrameStats();
 			}
 			else
 			{
@@ -101,9 +118,31 @@ int D3DApp::Run()
         }
     }
 
+	DumpFrameStats();
+
 	return (int)msg.wParam;
 }
 
+int D3DApp::RunHeadless(std::uint64_t tickCount)
+{
+	mTimer.Reset();
+	mScheduler.Reset();
+
+	float dt = (float)mScheduler.StepSeconds();
+	for(std::uint64_t i = 0; i < tickCount; ++i)
+	{
+		mTimer.Tick();
+		FixedUpdate(mTimer, dt);
+	}
+
+	return 0;
+}
+
+float D3DApp::InterpolationAlpha()const
+{
+	return mFixedTimestep ? mScheduler.Alpha() : 1.0f;
+}
+
 bool D3DApp::Initialize()
 {
 	if(!InitMainWindow())
@@ -443,9 +482,6 @@ bool D3DApp::InitDirect3D()
 			IID_PPV_ARGS(&md3dDevice)));
 	}
 
-	ThrowIfFailed(md3dDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE,
-		IID_PPV_ARGS(&mFence)));
-
 	mRtvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 	mDsvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 	mCbvSrvUavDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -472,6 +508,7 @@ bool D3DApp::InitDirect3D()
 #endif
 
 	CreateCommandObjects();
+	mFence = std::make_unique<D3D12Fence>(md3dDevice.Get(), mCommandQueue.Get());
     CreateSwapChain();
     CreateRtvAndDsvDescriptorHeaps();
 
@@ -533,26 +570,10 @@ void D3DApp::CreateSwapChain()
 
 void D3DApp::FlushCommandQueue()
 {
-	// Advance the fence value to mark commands up to this fence point.
-    mCurrentFence++;
-
     // Add an instruction to the command queue to set a new fence point.  Because we 
 	// are on the GPU timeline, the new fence point won't be set until the GPU finishes
-	// processing all the commands prior to this Signal().
-    ThrowIfFailed(mCommandQueue->Signal(mFence.Get(), mCurrentFence));
-
-	// Wait until the GPU has completed commands up to this fence point.
-    if(mFence->GetCompletedValue() < mCurrentFence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-
-        // Fire event when GPU hits current fence.  
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrentFence, eventHandle));
-
-        // Wait until the GPU hits current fence event is fired.
-		WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-	}
+	// processing all the commands prior to this Signal().  Then wait for it.
+	mFence->Flush();
 }
 
 ID3D12Resource* D3DApp::CurrentBackBuffer()const
@@ -575,33 +596,42 @@ D3D12_CPU_DESCRIPTOR_HANDLE D3DApp::DepthStencilView()const
 
 void D3DApp::CalculateFrameStats()
 {
-	// Code computes the average frames per second, and also the 
-	// average time it takes to render one frame.  These stats 
-	// are appended to the window caption bar.
-    
-	static int frameCnt = 0;
-	static float timeElapsed = 0.0f;
+	// Moves the frame samples recorded by Run into the history and, once per second,
+	// appends the frame time percentiles of that second to the window caption.  An
+	// average alone hides the occasional long frame, so p95/p99/max are shown too.
 
-	frameCnt++;
+	mFrameStatsPending += mFrameStats.Drain();
 
-	// Compute averages over one second period.
-	if( (mTimer.TotalTime() - timeElapsed) >= 1.0f )
+	double now = mTimer.TotalTimeSeconds();
+	if( (now - mFrameStatsLastReport) >= 1.0 && mFrameStatsPending > 0 )
 	{
-		float fps = (float)frameCnt; // fps = frameCnt / 1
-		float mspf = 1000.0f / fps;
+		FrameStats::Summary s = mFrameStats.Summarize(mFrameStatsPending);
+		double fps = s.Count / (now - mFrameStatsLastReport);
 
-        wstring fpsStr = to_wstring(fps);
-        wstring mspfStr = to_wstring(mspf);
+		wchar_t buffer[256];
+		swprintf_s(buffer, L"    fps: %.0f   p50: %.2f ms   p95: %.2f ms   p99: %.2f ms   max: %.2f ms",
+			fps, s.Interval.P50Ms, s.Interval.P95Ms, s.Interval.P99Ms, s.Interval.MaxMs);
 
-        wstring windowText = mMainWndCaption +
-            L"    fps: " + fpsStr +
-            L"   mspf: " + mspfStr;
+        wstring windowText = mMainWndCaption + buffer;
 
         SetWindowText(mhMainWnd, windowText.c_str());
 		
-		// Reset for next average.
-		frameCnt = 0;
-		timeElapsed += 1.0f;
+		// Reset for the next report.
+		mFrameStatsPending = 0;
+		mFrameStatsLastReport = now;
+	}
+}
+
+void D3DApp::DumpFrameStats()
+{
+	mFrameStats.Drain();
+	if(mFrameStatsFile.empty() || mFrameStats.HistorySize() == 0)
+		return;
+
+	if(!mFrameStats.DumpCsv(mFrameStatsFile + ".csv") ||
+	   !mFrameStats.DumpJson(mFrameStatsFile + ".json"))
+	{
+		OutputDebugStringA(("Failed to write frame statistics to " + mFrameStatsFile + ".csv/.json\n").c_str());
 	}
 }
 
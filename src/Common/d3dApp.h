@@ -11,6 +11,9 @@
 
 #include "d3dUtil.h"
 #include "GameTimer.h"
+#include "FixedStepScheduler.h"
+#include "FrameStats.h"
+#include "Fence.h"
 
 // Link necessary d3d12 libraries.
 #pragma comment(lib,"d3dcompiler.lib")
@@ -38,6 +41,11 @@ public:
     void Set4xMsaaState(bool value);
 
 	int Run();
+
+	// Runs tickCount fixed simulation steps back to back without a window, a device
+	// or any rendering.  Initialize() does not need to be called.  Used for soak and
+	// throughput tests of the simulation.
+	int RunHeadless(std::uint64_t tickCount);
  
     virtual bool Initialize();
     virtual LRESULT MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -48,6 +56,10 @@ protected:
 	virtual void Update(const GameTimer& gt)=0;
     virtual void Draw(const GameTimer& gt)=0;
 
+	// Called zero or more times per frame with a constant dt when mFixedTimestep is
+	// set.  Update is still called once per frame for per-frame work such as input.
+	virtual void FixedUpdate(const GameTimer& gt, float dt){ }
+
 	// Convenience overrides for handling mouse input.
 	virtual void OnMouseDown(WPARAM btnState, int x, int y){ }
 	virtual void OnMouseUp(WPARAM btnState, int x, int y)  { }
@@ -67,6 +79,10 @@ protected:
 	D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView()const;
 
 	void CalculateFrameStats();
+	void DumpFrameStats();
+
+	// Blend factor in [0, 1) between the previous and current fixed-step states.
+	float InterpolationAlpha()const;
 
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
@@ -90,13 +106,27 @@ protected:
 
 	// Used to keep track of the delta-time and game time (4.4).
 	GameTimer mTimer;
+
+	// Derived class should set mFixedTimestep in its constructor to drive simulation
+	// through FixedUpdate at mScheduler's rate.
+	bool      mFixedTimestep = false;
+	FixedStepScheduler mScheduler;
+
+	// Per-frame CPU timings.  Run times the update phase; derived classes time the
+	// record, submit and present-wait phases in Draw with FrameStats::ScopedPhase.
+	FrameStats mFrameStats;
+	std::size_t mFrameStatsPending = 0; // samples drained since the last caption update
+	double    mFrameStatsLastReport = 0.0;
+
+	// Base name of the .csv/.json dumps written when Run returns.  Empty disables them.
+	std::string mFrameStatsFile = "frame_stats";
 	
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mSwapChain;
     Microsoft::WRL::ComPtr<ID3D12Device> md3dDevice;
 
-    Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
-    UINT64 mCurrentFence = 0;
+	// Fence on mCommandQueue.  Created by InitDirect3D after the command queue.
+	std::unique_ptr<IFence> mFence;
 	
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> mCommandQueue;
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mDirectCmdListAlloc;
@@ -1,5 +1,6 @@
 
 #include "d3dUtil.h"
+#include "UploadBatcher.h"
 #include <comdef.h>
 #include <fstream>
 
@@ -87,6 +88,14 @@ Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
     return defaultBuffer;
 }
 
+GpuAllocation d3dUtil::CreateDefaultBuffer(
+    UploadBatcher& batcher,
+    const void* initData,
+    UINT64 byteSize)
+{
+    return batcher.CreateDefaultBuffer(initData, byteSize);
+}
+
 ComPtr<ID3DBlob> d3dUtil::CompileShader(
 	const std::wstring& filename,
 	const D3D_SHADER_MACRO* defines,
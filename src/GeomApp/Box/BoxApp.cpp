@@ -3,6 +3,17 @@
 #include "../../Common/d3dApp.h"
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
+#include "../../Common/FrameRing.h"
+#include "../../Common/UploadBatcher.h"
+#include "../../Common/GpuHeapAllocator.h"
+#include "../../Common/DescriptorHeapManager.h"
+#include "../../Common/D3D12CommandSink.h"
+#include "../../Common/CommandContext.h"
+#include "../../Common/DrawQueue.h"
+#include "../../Common/JobSystem.h"
+#include "../../Common/ParallelRecorder.h"
+#include "../../Common/D3D12CommandListPool.h"
+#include "FrameResource.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -16,6 +27,15 @@ using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 using namespace DirectX::PackedVector;
 
+const int gNumFrameResources = 3;
+
+// Per-frame capacity of each frame resource's constant upload buffer, in draws.
+const UINT gMaxObjectsPerFrame = 1024;
+const UINT gMaxInstancesPerFrame = 16384;
+// Small triangles GameplayState draws around the player's with one instanced draw.
+const UINT gRingCount = 6;
+// Upper bound on the command lists the sorted draws are split across each frame.
+const UINT gMaxRecordingSlices = 4;
 
 class Logger {
 public:
@@ -48,13 +68,28 @@ public:
 
 class IRenderAdapter {
 public:
+    // Values of the pipeline field of DrawPacket sort keys and of DrawPacket::Geometry.
+    enum Pipeline { PipelineColor = 0, PipelineColorInstanced = 1 };
+    enum Geometry { GeometryTriangle = 0 };
+
     virtual ~IRenderAdapter() = default;
     virtual bool Initialize(HWND hwnd, int width, int height) = 0;
     virtual void Resize(int width, int height) = 0;
-    virtual void BeginFrame() = 0;
+    // frameIndex selects the frame resource whose buffers this frame's draws use.
+    virtual void BeginFrame(int frameIndex) = 0;
+    // Draws are queued between BeginFrame and EndFrame.  EndFrame sorts them by key
+    // and records them, so submission order does not matter.
+    virtual void Submit(const DrawPacket& packet) = 0;
+    // Queues every packet of a queue built elsewhere, e.g. on a worker thread.
+    virtual void Submit(const DrawQueue& queue) = 0;
     virtual void DrawTriangle(const XMFLOAT4X4& worldViewProj, const XMFLOAT4& color) = 0;
+    // Draws the triangle once per entry of instances with a single instanced draw.
+    virtual void DrawTrianglesInstanced(const InstanceData* instances, UINT count) = 0;
     virtual void EndFrame() = 0;
     virtual void Cleanup() = 0;
+    // Whether the draws read descriptor tables, so their command lists need the
+    // descriptor heap bound.  Valid after Initialize.
+    virtual bool UsesDescriptorHeap() const = 0;
 };
 
 
@@ -63,14 +98,16 @@ struct Vertex {
     XMFLOAT4 Color;
 };
 
-struct ObjectConstants {
-    XMFLOAT4X4 WorldViewProj = MathHelper::Identity4x4();
-};
-
 class DX12RenderAdapter : public IRenderAdapter {
 public:
-    DX12RenderAdapter(ID3D12Device* device, ID3D12CommandQueue* cmdQueue, ID3D12GraphicsCommandList* cmdList)
-        : md3dDevice(device), mCommandQueue(cmdQueue), mCommandList(cmdList) {
+    // prepareCommandList binds the render targets and other per-frame state on each
+    // of the command lists the draws are recorded into.
+    DX12RenderAdapter(ID3D12Device* device, ID3D12CommandQueue* cmdQueue, ID3D12GraphicsCommandList* cmdList,
+        const std::vector<std::unique_ptr<FrameResource>>& frameResources, UploadBatcher* uploadBatcher,
+        JobSystem* jobs, D3D12CommandListPool::PrepareFunction prepareCommandList)
+        : md3dDevice(device), mCommandQueue(cmdQueue), mCommandList(cmdList), mFrameResources(frameResources),
+        mUploadBatcher(uploadBatcher), mListPool(device, gMaxRecordingSlices, std::move(prepareCommandList)),
+        mRecorder(*jobs, gMaxRecordingSlices) {
         Logger::Log(Logger::Info, "DX12RenderAdapter created");
     }
 
@@ -80,28 +117,6 @@ public:
         mClientWidth = width;
         mClientHeight = height;
 
-        D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc = {};
-        cbvHeapDesc.NumDescriptors = 1;
-        cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-        cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-        cbvHeapDesc.NodeMask = 0;
-        HRESULT hr = md3dDevice->CreateDescriptorHeap(&cbvHeapDesc, IID_PPV_ARGS(&mCbvHeap));
-        if (FAILED(hr)) {
-            Logger::Log(Logger::Error, "Failed to create CBV descriptor heap");
-            return false;
-        }
-
-        mObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(md3dDevice.Get(), 1, true);
-
-        UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-        D3D12_GPU_VIRTUAL_ADDRESS cbAddress = mObjectCB->Resource()->GetGPUVirtualAddress();
-        cbAddress += 0 * objCBByteSize;
-
-        D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-        cbvDesc.BufferLocation = cbAddress;
-        cbvDesc.SizeInBytes = objCBByteSize;
-        md3dDevice->CreateConstantBufferView(&cbvDesc, mCbvHeap->GetCPUDescriptorHandleForHeapStart());
-
         BuildRootSignature();
         BuildShadersAndInputLayout();
         BuildTriangleGeometry();
@@ -116,52 +131,162 @@ public:
         mClientHeight = height;
     }
 
-    virtual void BeginFrame() override {
+    virtual bool UsesDescriptorHeap() const override {
+        return mUsesDescriptorTables;
+    }
+
+    virtual void BeginFrame(int frameIndex) override {
+        mCurrFrameIndex = frameIndex;
 
+        mListPool.BeginFrame(mFrameResources[frameIndex]->WorkerCmdListAllocs);
+        mDrawQueue.Clear();
     }
 
-    virtual void DrawTriangle(const XMFLOAT4X4& worldViewProj, const XMFLOAT4& color) override {
-        mCommandList->SetPipelineState(mPSO.Get());
+    virtual void Submit(const DrawPacket& packet) override {
+        mDrawQueue.Push(packet);
+    }
 
+    virtual void Submit(const DrawQueue& queue) override {
+        mDrawQueue.Append(queue);
+    }
 
-        ObjectConstants objConstants;
-        XMStoreFloat4x4(&objConstants.WorldViewProj, XMMatrixTranspose(XMLoadFloat4x4(&worldViewProj)));
-        mObjectCB->CopyData(0, objConstants);
+    virtual void DrawTriangle(const XMFLOAT4X4& worldViewProj, const XMFLOAT4& color) override {
+        DrawPacket packet;
+        packet.Key = SortKey::Make(SortKey::PassOpaque, PipelineColor, 0, 0);
+        packet.Geometry = GeometryTriangle;
+        packet.WorldViewProj = worldViewProj;
+        packet.Color = color;
+        Submit(packet);
+    }
+
+    virtual void DrawTrianglesInstanced(const InstanceData* instances, UINT count) override {
+        if (count == 0) return;
+
+        // The instances are copied now; the packet only carries their address.
+        UINT64 byteSize = (UINT64)sizeof(InstanceData) * count;
+        LinearUploadBuffer::Allocation a = mFrameResources[mCurrFrameIndex]->InstanceUpload->Allocate(byteSize);
+        if (a.CpuAddress == nullptr) {
+            if (!mLoggedInstancesExhausted) {
+                Logger::Log(Logger::Warning, "Per-frame instance buffer exhausted; instanced draws skipped");
+                mLoggedInstancesExhausted = true;
+            }
+            return;
+        }
+        // HLSL reads the structured buffer's matrices column-major, as it does the
+        // constant buffer's, so they are transposed like the per-draw constants.
+        InstanceData* dest = reinterpret_cast<InstanceData*>(a.CpuAddress);
+        for (UINT i = 0; i < count; ++i) {
+            XMStoreFloat4x4(&dest[i].WorldViewProj, XMMatrixTranspose(XMLoadFloat4x4(&instances[i].WorldViewProj)));
+            dest[i].Color = instances[i].Color;
+        }
 
+        DrawPacket packet;
+        packet.Key = SortKey::Make(SortKey::PassOpaque, PipelineColorInstanced, 0, 0);
+        packet.Geometry = GeometryTriangle;
+        packet.InstanceCount = count;
+        packet.InstanceBuffer = a.GpuAddress;
+        Submit(packet);
+    }
 
-        ID3D12DescriptorHeap* heaps[] = { mCbvHeap.Get() };
-        mCommandList->SetDescriptorHeaps(1, heaps);
+    // Sorts the queued draws, records them on the job system into one command list
+    // per slice, and submits the lists in draw order.
+    virtual void EndFrame() override {
+        mDrawQueue.Sort();
+        WritePacketConstants();
 
-        mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
-        mCommandList->SetGraphicsRootDescriptorTable(0, mCbvHeap->GetGPUDescriptorHandleForHeapStart());
+        UINT listCount = mRecorder.Record(mDrawQueue, mListPool,
+            [this](CommandContext& context, std::uint32_t drawIndex) { RecordPacket(context, drawIndex); });
+        mListPool.Execute(mCommandQueue.Get(), listCount);
+    }
 
+    virtual void Cleanup() override {
+        Logger::Log(Logger::Info, "Cleaning up DX12RenderAdapter");
 
-        mCommandList->IASetVertexBuffers(0, 1, &mTriangleGeo->VertexBufferView());
-        mCommandList->IASetIndexBuffer(&mTriangleGeo->IndexBufferView());
-        mCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        // The GPU is idle, so the geometry's heap blocks can go back to the allocator.
+        mTriangleGeo.reset();
+        mTriangleVB.Reset();
+        mTriangleIB.Reset();
 
+        CommandContext::Stats stats = mRecorder.GetStats();
+        Logger::Log(Logger::Info, "State binds issued: " + std::to_string(stats.TotalIssued()) +
+            ", skipped as redundant: " + std::to_string(stats.TotalSaved()) +
+            ", draws: " + std::to_string(stats.Draws));
 
-        mCommandList->DrawIndexedInstanced(mTriangleGeo->DrawArgs["triangle"].IndexCount, 1, 0, 0, 0);
     }
 
-    virtual void EndFrame() override {
+private:
+    // Copies the constants of every non-instanced draw into the frame's upload buffer,
+    // in sorted order.  This runs on the calling thread so the recording jobs only
+    // read the resulting addresses and never touch the shared allocator.
+    void WritePacketConstants() {
+        mPacketConstants.assign(mDrawQueue.Size(), 0);
+
+        for (std::size_t i = 0; i < mDrawQueue.Size(); ++i) {
+            const DrawPacket& packet = mDrawQueue[i];
+            if (SortKey::GetPipeline(packet.Key) == PipelineColorInstanced) continue;
+
+            ObjectConstants objConstants;
+            XMStoreFloat4x4(&objConstants.WorldViewProj, XMMatrixTranspose(XMLoadFloat4x4(&packet.WorldViewProj)));
+
+            // Each draw gets its own slice of the frame's upload buffer, so later draws
+            // in the frame cannot overwrite constants the GPU has not read yet.
+            mPacketConstants[i] = mFrameResources[mCurrFrameIndex]->ConstantUpload->PushConstants(objConstants);
+            if (mPacketConstants[i] == 0 && !mLoggedConstantsExhausted) {
+                Logger::Log(Logger::Warning, "Per-frame constant buffer exhausted; draws skipped");
+                mLoggedConstantsExhausted = true;
+            }
+        }
+    }
+
+    // Called concurrently from the recording jobs; each context belongs to one job.
+    void RecordPacket(CommandContext& context, std::uint32_t drawIndex) {
+        const DrawPacket& packet = mDrawQueue[drawIndex];
+        assert(packet.Geometry == GeometryTriangle);
+
+        if (SortKey::GetPipeline(packet.Key) == PipelineColorInstanced) {
+            RecordInstancedPacket(context, packet);
+            return;
+        }
+
+        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = mPacketConstants[drawIndex];
+        if (objCBAddress == 0) return;
 
+        // Only the constants change between triangles; the context drops the rest.
+        context.SetPipelineState(D3D12CommandSink::ToHandle(mPSO.Get()));
+        context.SetRootSignature(D3D12CommandSink::ToHandle(mRootSignature.Get()));
+        context.SetRootConstantBuffer(0, objCBAddress);
+
+        context.SetVertexBuffer(0, D3D12CommandSink::ToBinding(mTriangleGeo->VertexBufferView()));
+        context.SetIndexBuffer(D3D12CommandSink::ToBinding(mTriangleGeo->IndexBufferView()));
+        context.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+
+        context.DrawIndexed(mTriangleIndexCount);
     }
 
-    virtual void Cleanup() override {
-        Logger::Log(Logger::Info, "Cleaning up DX12RenderAdapter");
+    void RecordInstancedPacket(CommandContext& context, const DrawPacket& packet) {
+        context.SetPipelineState(D3D12CommandSink::ToHandle(mInstancedPSO.Get()));
+        context.SetRootSignature(D3D12CommandSink::ToHandle(mRootSignature.Get()));
+        context.SetRootShaderResource(1, packet.InstanceBuffer);
 
+        context.SetVertexBuffer(0, D3D12CommandSink::ToBinding(mTriangleGeo->VertexBufferView()));
+        context.SetIndexBuffer(D3D12CommandSink::ToBinding(mTriangleGeo->IndexBufferView()));
+        context.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+        context.DrawIndexed(mTriangleIndexCount, packet.InstanceCount);
     }
 
-private:
     void BuildRootSignature() {
-        CD3DX12_ROOT_PARAMETER slotRootParameter[1];
-        CD3DX12_DESCRIPTOR_RANGE cbvTable;
-        cbvTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
-        slotRootParameter[0].InitAsDescriptorTable(1, &cbvTable);
-
-        CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(1, slotRootParameter, 0, nullptr,
+        // Root CBV: the per-draw constants are bound by GPU virtual address, so no
+        // descriptor heap is needed.  The root SRV holds the per-instance data of
+        // instanced draws.
+        CD3DX12_ROOT_PARAMETER slotRootParameter[2];
+        slotRootParameter[0].InitAsConstantBufferView(0);
+        slotRootParameter[1].InitAsShaderResourceView(0);
+
+        CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(2, slotRootParameter, 0, nullptr,
             D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+        mUsesDescriptorTables = DescriptorHeapManager::UsesDescriptorTables(rootSigDesc);
 
         ComPtr<ID3DBlob> serializedRootSig = nullptr;
         ComPtr<ID3DBlob> errorBlob = nullptr;
@@ -182,6 +307,7 @@ private:
 
     void BuildShadersAndInputLayout() {
         mvsByteCode = d3dUtil::CompileShader(L"Shaders\\color.hlsl", nullptr, "VS", "vs_5_0");
+        mvsInstancedByteCode = d3dUtil::CompileShader(L"Shaders\\color.hlsl", nullptr, "VSInstanced", "vs_5_0");
         mpsByteCode = d3dUtil::CompileShader(L"Shaders\\color.hlsl", nullptr, "PS", "ps_5_0");
 
         mInputLayout = {
@@ -215,11 +341,14 @@ private:
         ThrowIfFailed(D3DCreateBlob(ibByteSize, &mTriangleGeo->IndexBufferCPU));
         CopyMemory(mTriangleGeo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
-        mTriangleGeo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-            mCommandList.Get(), vertices.data(), vbByteSize, mTriangleGeo->VertexBufferUploader);
+        // Both are small enough to be ranges of the heap allocator's shared buffer.
+        mTriangleVB = d3dUtil::CreateDefaultBuffer(*mUploadBatcher, vertices.data(), vbByteSize);
+        mTriangleGeo->VertexBufferGPU = mTriangleVB.Resource();
+        mTriangleGeo->VertexBufferOffset = mTriangleVB.Offset();
 
-        mTriangleGeo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-            mCommandList.Get(), indices.data(), ibByteSize, mTriangleGeo->IndexBufferUploader);
+        mTriangleIB = d3dUtil::CreateDefaultBuffer(*mUploadBatcher, indices.data(), ibByteSize);
+        mTriangleGeo->IndexBufferGPU = mTriangleIB.Resource();
+        mTriangleGeo->IndexBufferOffset = mTriangleIB.Offset();
 
         mTriangleGeo->VertexByteStride = sizeof(Vertex);
         mTriangleGeo->VertexBufferByteSize = vbByteSize;
@@ -232,6 +361,8 @@ private:
         submesh.BaseVertexLocation = 0;
 
         mTriangleGeo->DrawArgs["triangle"] = submesh;
+        // Cached so the recording jobs do not look it up in the map concurrently.
+        mTriangleIndexCount = submesh.IndexCount;
     }
 
     void BuildPSO() {
@@ -261,6 +392,9 @@ private:
         psoDesc.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT; //   
 
         ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mPSO)));
+
+        psoDesc.VS = { reinterpret_cast<BYTE*>(mvsInstancedByteCode->GetBufferPointer()), mvsInstancedByteCode->GetBufferSize() };
+        ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mInstancedPSO)));
     }
 
 private:
@@ -268,17 +402,36 @@ private:
     ComPtr<ID3D12CommandQueue> mCommandQueue;
     ComPtr<ID3D12GraphicsCommandList> mCommandList;
 
+    const std::vector<std::unique_ptr<FrameResource>>& mFrameResources;
+    int mCurrFrameIndex = 0;
+    UploadBatcher* mUploadBatcher = nullptr;
+    bool mLoggedConstantsExhausted = false;
+    bool mLoggedInstancesExhausted = false;
+
+    // Draws are recorded on the job system, one command list per slice of the sorted
+    // queue.  Each slice goes through its own context so binds that repeat the
+    // current state are skipped.
+    D3D12CommandListPool mListPool;
+    ParallelRecorder mRecorder;
+
+    DrawQueue mDrawQueue;
+    std::vector<D3D12_GPU_VIRTUAL_ADDRESS> mPacketConstants;
+    UINT mTriangleIndexCount = 0;
+
     int mClientWidth = 0;
     int mClientHeight = 0;
 
     ComPtr<ID3D12RootSignature> mRootSignature;
-    ComPtr<ID3D12DescriptorHeap> mCbvHeap;
-    std::unique_ptr<UploadBuffer<ObjectConstants>> mObjectCB;
+    bool mUsesDescriptorTables = false;
     std::unique_ptr<MeshGeometry> mTriangleGeo;
+    GpuAllocation mTriangleVB;
+    GpuAllocation mTriangleIB;
     ComPtr<ID3DBlob> mvsByteCode;
+    ComPtr<ID3DBlob> mvsInstancedByteCode;
     ComPtr<ID3DBlob> mpsByteCode;
     std::vector<D3D12_INPUT_ELEMENT_DESC> mInputLayout;
     ComPtr<ID3D12PipelineState> mPSO;
+    ComPtr<ID3D12PipelineState> mInstancedPSO;
 };
 
 
@@ -340,7 +493,8 @@ public:
     virtual ~GameState() = default;
     virtual void Enter() = 0;
     virtual void Update(float deltaTime) = 0;
-    virtual void Draw(IRenderAdapter* adapter) = 0;
+    // alpha blends from the state before the last Update (0) to the current state (1).
+    virtual void Draw(IRenderAdapter* adapter, float alpha) = 0;
     virtual void Exit() = 0;
 };
 
@@ -356,11 +510,19 @@ public:
         mPosition = XMFLOAT2(0.0f, 0.0f);
         mScale = 1.0f;
         mAngle = 0.0f;
+
+        mPrevPosition = mPosition;
+        mPrevScale = mScale;
+        mPrevAngle = mAngle;
     }
 
     virtual void Update(float deltaTime) override {
         auto& input = InputManager::Get();
 
+        mPrevPosition = mPosition;
+        mPrevScale = mScale;
+        mPrevAngle = mAngle;
+
         float moveSpeed = 200.0f;
         if (input.IsKeyDown('W') || input.IsKeyDown(VK_UP)) mPosition.y -= moveSpeed * deltaTime;
         if (input.IsKeyDown('S') || input.IsKeyDown(VK_DOWN)) mPosition.y += moveSpeed * deltaTime;
@@ -376,18 +538,45 @@ public:
         }
     }
 
-    virtual void Draw(IRenderAdapter* adapter) override {
+    virtual void Draw(IRenderAdapter* adapter, float alpha) override {
 
-        XMMATRIX world = XMMatrixTranslation(mPosition.x, mPosition.y, 0.0f) *
-            XMMatrixRotationZ(mAngle) *
-            XMMatrixScaling(mScale, mScale, 1.0f);
+        XMFLOAT2 position(MathHelper::Lerp(mPrevPosition.x, mPosition.x, alpha),
+            MathHelper::Lerp(mPrevPosition.y, mPosition.y, alpha));
+        float scale = MathHelper::Lerp(mPrevScale, mScale, alpha);
+        float angle = MathHelper::Lerp(mPrevAngle, mAngle, alpha);
+
+        XMMATRIX world = XMMatrixTranslation(position.x, position.y, 0.0f) *
+            XMMatrixRotationZ(angle) *
+            XMMatrixScaling(scale, scale, 1.0f);
         XMMATRIX view = XMMatrixIdentity();
         XMMATRIX proj = XMMatrixOrthographicOffCenterLH(0.0f, 800.0f, 600.0f, 0.0f, 0.0f, 1.0f);
         XMMATRIX wvp = world * view * proj;
         XMFLOAT4X4 wvpMat;
         XMStoreFloat4x4(&wvpMat, wvp);
 
-        adapter->DrawTriangle(wvpMat, XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f));
+        DrawPacket packet;
+        packet.Key = SortKey::Make(SortKey::PassOpaque, IRenderAdapter::PipelineColor, 0, 0);
+        packet.Geometry = IRenderAdapter::GeometryTriangle;
+        packet.WorldViewProj = wvpMat;
+        packet.Color = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
+        adapter->Submit(packet);
+
+        // A ring of small copies circles the triangle, drawn with one instanced draw.
+        // The triangle's vertices are centered on the screen, so each copy is moved to
+        // the origin, shrunk and placed on the ring around the triangle's center.
+        std::array<InstanceData, gRingCount> ring;
+        XMMATRIX toOrigin = XMMatrixTranslation(-400.0f, -300.0f, 0.0f);
+        XMVECTOR center = XMVector3TransformCoord(XMVectorSet(400.0f, 300.0f, 0.0f, 1.0f), world);
+        for (UINT i = 0; i < gRingCount; ++i) {
+            float theta = angle + XM_2PI * i / gRingCount;
+            XMMATRIX place = toOrigin * XMMatrixScaling(0.15f * scale, 0.15f * scale, 1.0f) *
+                XMMatrixRotationZ(theta) *
+                XMMatrixTranslation(XMVectorGetX(center) + 150.0f * scale * cosf(theta),
+                    XMVectorGetY(center) + 150.0f * scale * sinf(theta), 0.0f);
+            XMStoreFloat4x4(&ring[i].WorldViewProj, place * view * proj);
+            ring[i].Color = XMFLOAT4(0.0f, (float)i / gRingCount, 1.0f, 1.0f);
+        }
+        adapter->DrawTrianglesInstanced(ring.data(), gRingCount);
     }
 
     virtual void Exit() override {
@@ -398,6 +587,10 @@ private:
     XMFLOAT2 mPosition;
     float mScale;
     float mAngle;
+
+    XMFLOAT2 mPrevPosition;
+    float mPrevScale;
+    float mPrevAngle;
 };
 
 
@@ -412,7 +605,7 @@ public:
 
         }
     }
-    virtual void Draw(IRenderAdapter* adapter) override {
+    virtual void Draw(IRenderAdapter* adapter, float alpha) override {
 
     }
     virtual void Exit() override {
@@ -430,11 +623,16 @@ public:
 
     virtual bool Initialize() override;
 
+    // Sets up the game state without a window or device, for RunHeadless.
+    void InitializeHeadless();
+
 private:
     virtual void OnResize() override;
     virtual void Update(const GameTimer& gt) override;
+    virtual void FixedUpdate(const GameTimer& gt, float dt) override;
     virtual void Draw(const GameTimer& gt) override;
 
+    void BuildFrameResources();
 
     virtual void OnMouseDown(WPARAM btnState, int x, int y) override {
 
@@ -443,6 +641,14 @@ private:
     virtual void OnMouseMove(WPARAM btnState, int x, int y) override {}
 
 private:
+    std::vector<std::unique_ptr<FrameResource>> mFrameResources;
+    FrameRing mFrameRing{ gNumFrameResources };
+    FrameResource* mCurrFrameResource = nullptr;
+
+    std::unique_ptr<GpuHeapAllocator> mHeapAllocator;
+    std::unique_ptr<UploadBatcher> mUploadBatcher;
+    std::unique_ptr<JobSystem> mJobs;
+    std::unique_ptr<DescriptorHeapManager> mDescriptorHeaps;
     std::unique_ptr<IRenderAdapter> mRenderAdapter;
     std::unique_ptr<GameState> mCurrentState;
     XMFLOAT4X4 mView;
@@ -457,6 +663,15 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance, PSTR cmdLine, in
 
     try {
         BoxApp theApp(hInstance);
+
+        // "-headless <ticks>" runs the simulation only, as fast as possible.
+        const char* headless = cmdLine ? strstr(cmdLine, "-headless") : nullptr;
+        if (headless) {
+            unsigned long long ticks = strtoull(headless + strlen("-headless"), nullptr, 10);
+            theApp.InitializeHeadless();
+            return theApp.RunHeadless(ticks);
+        }
+
         if (!theApp.Initialize())
             return 0;
 
@@ -469,11 +684,21 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance, PSTR cmdLine, in
 }
 
 BoxApp::BoxApp(HINSTANCE hInstance) : D3DApp(hInstance) {
+    mFixedTimestep = true;
     Logger::Log(Logger::Info, "BoxApp created");
 }
 
 BoxApp::~BoxApp() {
+    // The frame resources are released before the base class destructor runs, so
+    // wait for the GPU to finish with them here.
+    if (mFence != nullptr) FlushCommandQueue();
+
     if (mRenderAdapter) mRenderAdapter->Cleanup();
+    if (mDescriptorHeaps) {
+        DescriptorHeapManager::Stats stats = mDescriptorHeaps->GetStats();
+        Logger::Log(Logger::Info, "Descriptor heap binds: " + std::to_string(stats.HeapBinds) +
+            ", descriptors copied: " + std::to_string(stats.DescriptorsCopied));
+    }
     Logger::Log(Logger::Info, "BoxApp destroyed");
 }
 
@@ -484,8 +709,34 @@ bool BoxApp::Initialize() {
         return false;
     ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
 
-
-    mRenderAdapter = std::make_unique<DX12RenderAdapter>(md3dDevice.Get(), mCommandQueue.Get(), mCommandList.Get());
+    BuildFrameResources();
+
+    // Static geometry is staged through one shared upload heap and copied by the
+    // command list executed below.  The buffers themselves are placed resources in
+    // shared heaps rather than one committed resource each.
+    mHeapAllocator = std::make_unique<GpuHeapAllocator>(md3dDevice.Get());
+    mUploadBatcher = std::make_unique<UploadBatcher>(md3dDevice.Get(), mFence.get());
+    mUploadBatcher->SetHeapAllocator(mHeapAllocator.get());
+    mUploadBatcher->Begin(mCommandList.Get());
+
+    // One shader-visible CBV/SRV/UAV heap for the whole app, bound once per frame.
+    mDescriptorHeaps = std::make_unique<DescriptorHeapManager>(md3dDevice.Get());
+
+    // Draws are recorded on worker threads.  Their command lists start with no state,
+    // so each one binds the frame's targets first, and the descriptor heap if the
+    // root signature reads descriptor tables.
+    mJobs = std::make_unique<JobSystem>();
+    auto prepareCommandList = [this](ID3D12GraphicsCommandList* cmdList) {
+        cmdList->RSSetViewports(1, &mScreenViewport);
+        cmdList->RSSetScissorRects(1, &mScissorRect);
+        cmdList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
+
+        if (mRenderAdapter->UsesDescriptorHeap())
+            mDescriptorHeaps->Bind(cmdList);
+    };
+
+    mRenderAdapter = std::make_unique<DX12RenderAdapter>(md3dDevice.Get(), mCommandQueue.Get(), mCommandList.Get(),
+        mFrameResources, mUploadBatcher.get(), mJobs.get(), prepareCommandList);
     if (!mRenderAdapter->Initialize(mhMainWnd, mClientWidth, mClientHeight)) {
         Logger::Log(Logger::Error, "Failed to initialize render adapter");
         return false;
@@ -494,6 +745,7 @@ bool BoxApp::Initialize() {
     ThrowIfFailed(mCommandList->Close());
     ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
     mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+    mUploadBatcher->End();
 
     FlushCommandQueue();
 
@@ -510,6 +762,22 @@ bool BoxApp::Initialize() {
     return true;
 }
 
+void BoxApp::InitializeHeadless() {
+    Logger::Log(Logger::Info, "BoxApp initializing headless");
+
+    mCurrentState = std::make_unique<GameplayState>();
+    mCurrentState->Enter();
+}
+
+void BoxApp::BuildFrameResources() {
+    mFrameResources.clear();
+    for (int i = 0; i < gNumFrameResources; ++i) {
+        mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(), gMaxObjectsPerFrame,
+            gMaxInstancesPerFrame, gMaxRecordingSlices));
+    }
+    mFrameRing.Reset(gNumFrameResources);
+}
+
 void BoxApp::OnResize() {
     D3DApp::OnResize();
 
@@ -526,21 +794,39 @@ void BoxApp::OnResize() {
 void BoxApp::Update(const GameTimer& gt) {
 
     InputManager::Get().Update();
+}
 
+void BoxApp::FixedUpdate(const GameTimer& gt, float dt) {
 
     if (mCurrentState) {
-        mCurrentState->Update(gt.DeltaTime());
+        mCurrentState->Update(dt);
     }
 }
 
 void BoxApp::Draw(const GameTimer& gt) {
 
-    ThrowIfFailed(mDirectCmdListAlloc->Reset());
-    ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
+    // Cycle through the circular frame resource array.  The GPU may still be working
+    // on the frame that last used the next resource, so wait until it is done.
+    {
+        FrameStats::ScopedPhase phase(mFrameStats, FrameStats::PhasePresentWait);
+        mFence->WaitFor(mFrameRing.BeginFrame());
+    }
+    mCurrFrameResource = mFrameResources[mFrameRing.CurrentIndex()].get();
+
+    mFrameStats.BeginPhase(FrameStats::PhaseRecord);
 
+    // Reuse the memory associated with command recording and the constant and instance
+    // data of the frame that last used this resource; the wait above made this safe.
+    auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
+    ThrowIfFailed(cmdListAlloc->Reset());
+    mCurrFrameResource->ConstantUpload->Reset();
+    mCurrFrameResource->InstanceUpload->Reset();
+    ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), nullptr));
+
+    // Transient descriptors of frames the GPU has finished are reusable.  The heap is
+    // bound on the adapter's command lists, which record all the draws.
+    mDescriptorHeaps->BeginFrame(mFence->CompletedValue());
 
-    mCommandList->RSSetViewports(1, &mScreenViewport);
-    mCommandList->RSSetScissorRects(1, &mScissorRect);
 
     mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
         D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
@@ -548,25 +834,47 @@ void BoxApp::Draw(const GameTimer& gt) {
     mCommandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
     mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
 
-
-    mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
+    // The clear has to reach the queue ahead of the adapter's command lists, which
+    // it submits itself from EndFrame.
+    ThrowIfFailed(mCommandList->Close());
+    {
+        ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
+        mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+    }
 
 
+    mRenderAdapter->BeginFrame(mFrameRing.CurrentIndex());
     if (mCurrentState) {
-        mCurrentState->Draw(mRenderAdapter.get());
+        mCurrentState->Draw(mRenderAdapter.get(), InterpolationAlpha());
     }
+    mDescriptorHeaps->FlushCopies();
+    mRenderAdapter->EndFrame();
 
+    mFrameStats.EndPhase(FrameStats::PhaseRecord);
 
-    mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-        D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+    {
+        FrameStats::ScopedPhase phase(mFrameStats, FrameStats::PhaseSubmit);
 
+        // A submitted command list can be reset right away; the allocator keeps the
+        // commands recorded above alive until it is reset next time this frame
+        // resource comes around.
+        ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), nullptr));
+        mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
+            D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+        ThrowIfFailed(mCommandList->Close());
 
-    ThrowIfFailed(mCommandList->Close());
-    ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
-    mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+        ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
+        mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+    }
+
+    FrameStats::ScopedPhase phase(mFrameStats, FrameStats::PhasePresentWait);
 
     ThrowIfFailed(mSwapChain->Present(0, 0));
     mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
 
-    FlushCommandQueue();
+    // Mark the commands up to this point with a new fence value.  The frame resource
+    // is reused once the GPU reaches it, without waiting for the GPU here.
+    UINT64 fenceValue = mFence->Signal();
+    mFrameRing.EndFrame(fenceValue);
+    mDescriptorHeaps->EndFrame(fenceValue);
 }
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include "FrameResource.h"
+
+FrameResource::FrameResource(ID3D12Device* device, UINT objectCount, UINT instanceCount, UINT workerListCount) {
+    ThrowIfFailed(device->CreateCommandAllocator(
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
+
+    WorkerCmdListAllocs.resize(workerListCount);
+    for (auto& alloc : WorkerCmdListAllocs) {
+        ThrowIfFailed(device->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_DIRECT,
+            IID_PPV_ARGS(alloc.GetAddressOf())));
+    }
+
+    UINT64 objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
+    ConstantUpload = std::make_unique<LinearUploadBuffer>(device, objCBByteSize * objectCount);
+
+    InstanceUpload = std::make_unique<LinearUploadBuffer>(device, (UINT64)sizeof(InstanceData) * instanceCount);
+}
+
+FrameResource::~FrameResource() {
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../../Common/d3dUtil.h"
+#include "../../Common/MathHelper.h"
+#include "../../Common/LinearUploadBuffer.h"
+
+struct ObjectConstants {
+    DirectX::XMFLOAT4X4 WorldViewProj = MathHelper::Identity4x4();
+};
+
+// Per-instance data of instanced draws; matches InstanceData in color.hlsl.
+struct InstanceData {
+    DirectX::XMFLOAT4X4 WorldViewProj = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4 Color = { 1.0f, 1.0f, 1.0f, 1.0f };
+};
+
+// Stores the resources needed for the CPU to build the command lists for a frame.
+// The fence value marking when the GPU is done with them is kept by FrameRing.
+struct FrameResource {
+public:
+    // objectCount is the number of per-draw ObjectConstants the frame can hold,
+    // instanceCount the number of InstanceData entries over all instanced draws, and
+    // workerListCount the number of command lists the draws are recorded into.
+    FrameResource(ID3D12Device* device, UINT objectCount, UINT instanceCount, UINT workerListCount);
+    FrameResource(const FrameResource& rhs) = delete;
+    FrameResource& operator=(const FrameResource& rhs) = delete;
+    ~FrameResource();
+
+    // The allocator cannot be reset until the GPU is done processing the commands,
+    // so each frame needs its own allocator.
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
+
+    // One allocator per command list recorded in parallel by the job system.
+    std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> WorkerCmdListAllocs;
+
+    // A cbuffer cannot be updated until the GPU is done processing the commands
+    // that reference it, so each frame needs its own constant memory.  Every draw
+    // takes a fresh 256-byte aligned slice; the whole buffer is reset with the
+    // command allocator.
+    std::unique_ptr<LinearUploadBuffer> ConstantUpload = nullptr;
+
+    // Per-instance data of the frame's instanced draws.  Each draw copies its
+    // instances into one contiguous slice that the vertex shader reads as a
+    // structured buffer.
+    std::unique_ptr<LinearUploadBuffer> InstanceUpload = nullptr;
+};
@@ -9,6 +9,15 @@ cbuffer cbPerObject : register(b0)
 	float4x4 gWorldViewProj; 
 };
 
+struct InstanceData
+{
+	float4x4 WorldViewProj;
+	float4   Color;
+};
+
+// Per-instance data of VSInstanced, one entry per instance of the draw.
+StructuredBuffer<InstanceData> gInstanceData : register(t0);
+
 struct VertexIn
 {
 	float3 PosL  : POSITION;
@@ -34,6 +43,21 @@ VertexOut VS(VertexIn vin)
     return vout;
 }
 
+VertexOut VSInstanced(VertexIn vin, uint instanceID : SV_InstanceID)
+{
+	VertexOut vout;
+
+	InstanceData inst = gInstanceData[instanceID];
+
+	// Transform to homogeneous clip space.
+	vout.PosH = mul(float4(vin.PosL, 1.0f), inst.WorldViewProj);
+
+	// The instance color replaces the vertex color.
+	vout.Color = inst.Color;
+
+	return vout;
+}
+
 float4 PS(VertexOut pin) : SV_Target
 {
     return pin.Color;
@@ -0,0 +1,170 @@
+//***************************************************************************************
+// ArchiveBench.cpp
+//
+// Load time of the sample textures as loose files, from a plain TextureArchive and from
+// an Lz4-compressed one.  Every .dds file in the directory (src/Textures unless given on
+// the command line) is packed into both archives, written to the current directory,
+// then each source loads every texture with TextureStreamer::LoadTexture, the way the
+// streamer's workers do.  Reported per source, best of several passes:
+//
+//   stored     bytes read from disk for the bit data (what a cold load pays for)
+//   ms         time to load every texture into CPU memory
+//   MB/s       kept bytes loaded per second
+//
+// The files are in the OS cache after the first pass, so ms measures parse, copy and
+// decode cost.  A cold start also reads "stored" bytes from disk; at a given disk
+// bandwidth the compressed archive saves stored(plain) - stored(lz4) of that.
+//***************************************************************************************
+
+#include "DDSInfo.h"
+#include "TextureStreamer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+using namespace DirectX;
+
+namespace
+{
+	const int Passes = 5;
+
+	// Best time of Passes runs of load, which returns the bytes it loaded or 0 on failure.
+	bool Time(const std::function<std::uint64_t()>& load, double& bestMs, std::uint64_t& bytes)
+	{
+		bestMs = 1e30;
+		for(int pass = 0; pass < Passes; ++pass)
+		{
+			auto start = std::chrono::steady_clock::now();
+			bytes = load();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if(bytes == 0)
+				return false;
+			bestMs = std::min(bestMs, ms);
+		}
+		return true;
+	}
+
+	void Report(const char* source, std::uint64_t stored, double ms, std::uint64_t bytes)
+	{
+		std::printf("%-22s %10.1f %9.2f %9.0f\n", source, stored / (1024.0 * 1024.0), ms,
+			bytes / (1024.0 * 1024.0) / (ms / 1000.0));
+	}
+
+	std::uint64_t LoadLoose(const std::vector<std::string>& files)
+	{
+		std::uint64_t bytes = 0;
+		TextureStreamer::LoadedTexture texture;
+		std::string error;
+		for(const std::string& file : files)
+		{
+			if(!TextureStreamer::LoadTexture(file, 0, texture, error))
+			{
+				std::printf("%s\n", error.c_str());
+				return 0;
+			}
+			bytes += texture.Bits.size();
+		}
+		return bytes;
+	}
+
+	std::uint64_t LoadArchive(const TextureArchive& archive, JobSystem* jobs)
+	{
+		std::uint64_t bytes = 0;
+		TextureStreamer::LoadedTexture texture;
+		std::string error;
+		for(std::uint32_t entry = 0; entry < archive.EntryCount(); ++entry)
+		{
+			if(!TextureStreamer::LoadTexture(archive, entry, 0, texture, error, jobs))
+			{
+				std::printf("%s\n", error.c_str());
+				return 0;
+			}
+			bytes += texture.Bits.size();
+		}
+		return bytes;
+	}
+
+	// Bytes an archive stores past the DDS headers of its entries.
+	std::uint64_t StoredBits(const TextureArchive& archive)
+	{
+		std::uint64_t stored = 0;
+		for(std::uint32_t entry = 0; entry < archive.EntryCount(); ++entry)
+		{
+			std::size_t size = 0;
+			const std::uint8_t* data = archive.EntryData(entry, &size);
+			const DDS_HEADER* header = nullptr;
+			std::size_t headerSize = 0;
+			if(ValidateDDSHeader(data, size, &header, &headerSize))
+				stored += size - headerSize;
+		}
+		return stored;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::string directory = (argc > 1) ? argv[1] : TEXTURE_DIR;
+
+	JobSystem jobs;
+	std::vector<std::string> files;
+	std::uint64_t looseStored = 0;
+	for(const DDSFileInfo& info : ScanDDSDirectory(directory, jobs))
+	{
+		if(info.Valid)
+		{
+			files.push_back(info.FileName);
+			looseStored += info.TotalBytes;
+		}
+	}
+	if(files.empty())
+	{
+		std::printf("no DDS files in %s\n", directory.c_str());
+		return 1;
+	}
+
+	const std::string archiveNames[] = { "ArchiveBench.tarc", "ArchiveBenchLz4.tarc" };
+	TextureArchive archives[2];
+	for(int compress = 0; compress < 2; ++compress)
+	{
+		TextureArchiveBuilder builder;
+		std::string error;
+		for(const std::string& file : files)
+		{
+			std::string name = file.substr(file.find_last_of("/\\") + 1);
+			if(!builder.AddFile(name, file, error))
+			{
+				std::printf("%s\n", error.c_str());
+				return 1;
+			}
+		}
+
+		builder.SetCompression(compress != 0);
+		if(!builder.Write(archiveNames[compress], error, &jobs) || !archives[compress].Open(archiveNames[compress], error))
+		{
+			std::printf("%s\n", error.c_str());
+			return 1;
+		}
+	}
+
+	std::uint32_t compressed = 0;
+	for(std::uint32_t entry = 0; entry < archives[1].EntryCount(); ++entry)
+		compressed += archives[1].IsCompressed(entry) ? 1 : 0;
+
+	std::printf("%zu textures, %u stored compressed, %u worker threads\n\n", files.size(), compressed,
+		jobs.WorkerCount());
+	std::printf("%-22s %10s %9s %9s\n", "source", "stored MB", "ms", "MB/s");
+
+	double ms = 0;
+	std::uint64_t bytes = 0;
+	if(Time([&]() { return LoadLoose(files); }, ms, bytes))
+		Report("loose files", looseStored, ms, bytes);
+	if(Time([&]() { return LoadArchive(archives[0], nullptr); }, ms, bytes))
+		Report("archive", StoredBits(archives[0]), ms, bytes);
+	if(Time([&]() { return LoadArchive(archives[1], nullptr); }, ms, bytes))
+		Report("archive lz4, 1 thread", StoredBits(archives[1]), ms, bytes);
+	if(Time([&]() { return LoadArchive(archives[1], &jobs); }, ms, bytes))
+		Report("archive lz4, jobs", StoredBits(archives[1]), ms, bytes);
+
+	return 0;
+}
@@ -0,0 +1,119 @@
+//***************************************************************************************
+// BCDecodeBench.cpp
+//
+// Throughput of BCDecoder::Decode on a 2048x2048 surface of each block format, to RGBA8
+// and to float, on the calling thread alone and spread over a JobSystem.  The blocks
+// are random bytes, with the mode bits of BC6H and BC7 drawn evenly from the valid
+// modes so that every decode path is exercised rather than the reserved modes that
+// decode to zero.  Reported in megapixels per second, best of several passes.
+//***************************************************************************************
+
+#include "BCDecoder.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+
+namespace
+{
+	const std::uint32_t Size = 2048;
+	const int Passes = 3;
+
+	struct Format
+	{
+		const char* Name;
+		DXGI_FORMAT Dxgi;
+	};
+
+	// Random blocks of format covering a Size x Size surface.
+	std::vector<std::uint8_t> MakeBlocks(DXGI_FORMAT format, std::uint32_t blockSize)
+	{
+		// Mode bits as the decoder reads them from the low bits of the first byte.
+		static const std::uint8_t BC6HModes[] =
+		{
+			0x00, 0x01, 0x02, 0x06, 0x0a, 0x0e, 0x12, 0x16, 0x1a, 0x1e, 0x03, 0x07, 0x0b, 0x0f
+		};
+
+		std::mt19937 rng(99);
+		const std::size_t blockCount = std::size_t(Size / 4) * (Size / 4);
+		std::vector<std::uint8_t> blocks(blockCount * blockSize);
+		for(std::uint8_t& b : blocks)
+			b = (std::uint8_t)rng();
+
+		for(std::size_t i = 0; i < blockCount; ++i)
+		{
+			std::uint8_t& first = blocks[i * blockSize];
+			if(format == DXGI_FORMAT_BC6H_UF16)
+			{
+				std::uint8_t mode = BC6HModes[rng() % sizeof(BC6HModes)];
+				std::uint8_t mask = (mode & 0x02) ? 0x1f : 0x03;
+				first = (std::uint8_t)((first & ~mask) | mode);
+			}
+			else if(format == DXGI_FORMAT_BC7_UNORM)
+			{
+				// Mode m is m zero bits followed by a one.
+				std::uint32_t mode = rng() % 8;
+				first = (std::uint8_t)((first & (0xfe << mode)) | (1 << mode));
+			}
+		}
+		return blocks;
+	}
+
+	double BestMs(const std::function<bool()>& decode)
+	{
+		double best = 1e30;
+		for(int pass = 0; pass < Passes; ++pass)
+		{
+			auto start = std::chrono::steady_clock::now();
+			if(!decode())
+				return 0;
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	double MPixPerSecond(double ms)
+	{
+		return (ms > 0) ? double(Size) * Size / 1e6 / (ms / 1000.0) : 0;
+	}
+}
+
+int main()
+{
+	const Format formats[] =
+	{
+		{ "BC1", DXGI_FORMAT_BC1_UNORM },
+		{ "BC2", DXGI_FORMAT_BC2_UNORM },
+		{ "BC3", DXGI_FORMAT_BC3_UNORM },
+		{ "BC4", DXGI_FORMAT_BC4_UNORM },
+		{ "BC5", DXGI_FORMAT_BC5_UNORM },
+		{ "BC6H", DXGI_FORMAT_BC6H_UF16 },
+		{ "BC7", DXGI_FORMAT_BC7_UNORM },
+	};
+
+	JobSystem jobs;
+	std::printf("%ux%u surface, MPix/s, %u worker threads\n\n", Size, Size, jobs.WorkerCount());
+	std::printf("%-6s %10s %10s %10s %10s\n", "format", "rgba8", "rgba8 jobs", "float", "float jobs");
+
+	RgbaImage image;
+	RgbaFloatImage floatImage;
+	for(const Format& f : formats)
+	{
+		const std::uint32_t blockSize = BCDecoder::BlockSize(f.Dxgi);
+		const std::vector<std::uint8_t> blocks = MakeBlocks(f.Dxgi, blockSize);
+		const std::size_t rowPitch = std::size_t(Size / 4) * blockSize;
+		const std::uint8_t* bits = blocks.data();
+
+		double rgba = BestMs([&]() { return BCDecoder::Decode(f.Dxgi, bits, rowPitch, Size, Size, image); });
+		double rgbaJobs = BestMs([&]() { return BCDecoder::Decode(f.Dxgi, bits, rowPitch, Size, Size, image, &jobs); });
+		double flt = BestMs([&]() { return BCDecoder::Decode(f.Dxgi, bits, rowPitch, Size, Size, floatImage); });
+		double fltJobs = BestMs([&]() { return BCDecoder::Decode(f.Dxgi, bits, rowPitch, Size, Size, floatImage, &jobs); });
+
+		std::printf("%-6s %10.0f %10.0f %10.0f %10.0f\n", f.Name, MPixPerSecond(rgba), MPixPerSecond(rgbaJobs),
+			MPixPerSecond(flt), MPixPerSecond(fltJobs));
+	}
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+//***************************************************************************************
+// BuddyAllocatorTests.cpp
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include "BuddyAllocator.h"
+#include <iterator>
+#include <map>
+#include <random>
+
+TEST(BuddyAllocatorSplitsAndMerges)
+{
+	BuddyAllocator buddy(64 * 1024, 4096);
+
+	std::uint64_t a = buddy.Allocate(4096);
+	std::uint64_t b = buddy.Allocate(4096);
+	CHECK(a == 0);
+	CHECK(b == 4096);
+	CHECK(buddy.BlockSize(a) == 4096);
+
+	// The first allocation split the range down to 4KB; the halves left over are one
+	// free block per order above it.
+	BuddyAllocator::Stats s = buddy.GetStats();
+	CHECK(s.AllocationCount == 2);
+	CHECK(s.FreeBlockCount == 3);
+	CHECK(s.LargestFreeBlock == 32 * 1024);
+
+	buddy.Free(a);
+	buddy.Free(b);
+	s = buddy.GetStats();
+	CHECK(buddy.Empty());
+	CHECK(s.FreeBlockCount == 1);
+	CHECK(s.LargestFreeBlock == 64 * 1024);
+}
+
+TEST(BuddyAllocatorRoundsToBlockSizes)
+{
+	BuddyAllocator buddy(1024 * 1024, 256);
+
+	std::uint64_t a = buddy.Allocate(300);
+	CHECK(buddy.BlockSize(a) == 512);
+
+	// A larger alignment needs a block at least that large.
+	std::uint64_t b = buddy.Allocate(100, 8192);
+	CHECK(b % 8192 == 0);
+	CHECK(buddy.BlockSize(b) == 8192);
+
+	BuddyAllocator::Stats s = buddy.GetStats();
+	CHECK(s.RequestedBytes == 400);
+	CHECK(s.AllocatedBytes == 512 + 8192);
+	CHECK(s.InternalFragmentation() > 0.9);
+}
+
+TEST(BuddyAllocatorFailsWhenFull)
+{
+	BuddyAllocator buddy(16 * 1024, 4096);
+
+	CHECK(buddy.Allocate(32 * 1024) == BuddyAllocator::InvalidOffset);
+
+	std::uint64_t blocks[4];
+	for(std::uint64_t& block : blocks)
+		block = buddy.Allocate(4096);
+	CHECK(buddy.Allocate(1) == BuddyAllocator::InvalidOffset);
+	CHECK(buddy.GetStats().FailedAllocations == 2);
+
+	// Two free 4KB blocks that are not buddies cannot hold 8KB.
+	buddy.Free(blocks[1]);
+	buddy.Free(blocks[2]);
+	CHECK(buddy.Allocate(8192) == BuddyAllocator::InvalidOffset);
+	CHECK(buddy.GetStats().ExternalFragmentation() == 0.5);
+
+	buddy.Free(blocks[3]);
+	CHECK(buddy.Allocate(8192) == 8192);
+}
+
+TEST(BuddyAllocatorRandomBlocksDoNotOverlap)
+{
+	const std::uint64_t capacity = 64ull << 20;
+	BuddyAllocator buddy(capacity, 4096);
+	std::mt19937_64 rng(7);
+
+	// Offset -> block size of every live allocation.
+	std::map<std::uint64_t, std::uint64_t> live;
+	int bad = 0;
+	for(int i = 0; i < 100000; ++i)
+	{
+		if(live.empty() || rng() % 3 != 0)
+		{
+			std::uint64_t size = 1 + rng() % (1u << (8 + rng() % 14));
+			std::uint64_t alignment = 1ull << (rng() % 17);
+			std::uint64_t offset = buddy.Allocate(size, alignment);
+			if(offset == BuddyAllocator::InvalidOffset)
+				continue;
+
+			std::uint64_t block = buddy.BlockSize(offset);
+			if(offset % alignment != 0 || offset % block != 0 || block < size || offset + block > capacity)
+				++bad;
+
+			auto next = live.lower_bound(offset);
+			if(next != live.end() && next->first < offset + block)
+				++bad;
+			if(next != live.begin() && std::prev(next)->first + std::prev(next)->second > offset)
+				++bad;
+
+			live[offset] = block;
+		}
+		else
+		{
+			auto it = live.begin();
+			std::advance(it, rng() % live.size());
+			buddy.Free(it->first);
+			live.erase(it);
+		}
+	}
+	CHECK(bad == 0);
+	CHECK(buddy.GetStats().AllocationCount == live.size());
+
+	for(const auto& allocation : live)
+		buddy.Free(allocation.first);
+
+	BuddyAllocator::Stats s = buddy.GetStats();
+	CHECK(buddy.Empty());
+	CHECK(s.FreeBlockCount == 1);
+	CHECK(s.LargestFreeBlock == capacity);
+}
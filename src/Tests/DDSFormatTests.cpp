@@ -0,0 +1,126 @@
+//***************************************************************************************
+// DDSFormatTests.cpp
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include "DDSFormat.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	DDSTextureDesc MakeDesc(std::uint32_t width, std::uint32_t height, std::uint32_t mipCount,
+		std::uint32_t arraySize, DXGI_FORMAT format)
+	{
+		DDSTextureDesc desc;
+		desc.Dimension = DDS_DIMENSION_TEXTURE2D;
+		desc.Width = width;
+		desc.Height = height;
+		desc.Depth = 1;
+		desc.MipCount = mipCount;
+		desc.ArraySize = arraySize;
+		desc.Format = format;
+		return desc;
+	}
+}
+
+TEST(DDSLayoutKeepsWholeChain)
+{
+	DDSTextureDesc desc = MakeDesc(256, 128, 9, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
+
+	DDSLayout layout;
+	REQUIRE(GetDDSLayout(desc, 0, layout));
+	CHECK(layout.SkipMip == 0);
+	CHECK(layout.MipCount == 9);
+	REQUIRE(layout.Subresources.size() == 9);
+
+	std::uint64_t offset = 0;
+	for(std::uint32_t i = 0; i < 9; ++i)
+	{
+		const DDSSubresource& sub = layout.Subresources[i];
+		std::uint32_t w = std::max(256u >> i, 1u);
+		std::uint32_t h = std::max(128u >> i, 1u);
+		CHECK(sub.Width == w && sub.Height == h && sub.Depth == 1);
+		CHECK(sub.RowPitch == w * 4);
+		CHECK(sub.Offset == offset);
+		CHECK(sub.Size == std::uint64_t(w) * h * 4);
+		offset += sub.Size;
+	}
+	CHECK(layout.KeptBytes == offset);
+	CHECK(layout.TotalBytes == offset);
+}
+
+TEST(DDSLayoutMaxSizeSkipsLeadingMipsOfEverySlice)
+{
+	DDSTextureDesc desc = MakeDesc(256, 128, 9, 2, DXGI_FORMAT_R8G8B8A8_UNORM);
+
+	DDSLayout full;
+	REQUIRE(GetDDSLayout(desc, 0, full));
+
+	// 256x128 and 128x64 are above 64; the chain is kept from 64x32 down.
+	DDSLayout layout;
+	REQUIRE(GetDDSLayout(desc, 64, layout));
+	CHECK(layout.SkipMip == 2);
+	CHECK(layout.MipCount == 7);
+	REQUIRE(layout.Subresources.size() == 14);
+	CHECK(layout.TotalBytes == full.TotalBytes);
+
+	// Offsets still point into the whole file, so slice 1 starts after all of slice 0.
+	const std::uint64_t sliceBytes = full.TotalBytes / 2;
+	CHECK(layout.Subresources[0].Width == 64 && layout.Subresources[0].Height == 32);
+	CHECK(layout.Subresources[0].Offset == full.Subresources[2].Offset);
+	CHECK(layout.Subresources[7].Offset == sliceBytes + full.Subresources[2].Offset);
+	CHECK(layout.KeptBytes == 2 * (sliceBytes - full.Subresources[0].Size - full.Subresources[1].Size));
+}
+
+TEST(DDSLayoutRoundsBlockCompressedMipsToBlocks)
+{
+	DDSTextureDesc desc = MakeDesc(16, 16, 5, 1, DXGI_FORMAT_BC1_UNORM);
+
+	DDSLayout layout;
+	REQUIRE(GetDDSLayout(desc, 0, layout));
+	REQUIRE(layout.Subresources.size() == 5);
+
+	// 8 bytes per 4x4 block; the 2x2 and 1x1 mips still take a whole block.
+	const std::uint64_t sizes[] = { 128, 32, 8, 8, 8 };
+	for(int i = 0; i < 5; ++i)
+		CHECK(layout.Subresources[i].Size == sizes[i]);
+	CHECK(layout.Subresources[0].RowPitch == 32);
+	CHECK(layout.Subresources[0].NumRows == 4);
+}
+
+TEST(DDSLayoutFailsWhenMaxSizeKeepsNothing)
+{
+	// A single-mip texture is always kept, as the loaders keep it.
+	DDSTextureDesc desc = MakeDesc(256, 256, 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
+	DDSLayout layout;
+	CHECK(GetDDSLayout(desc, 16, layout));
+
+	// With a chain, a maxsize below the smallest mip leaves nothing.
+	desc = MakeDesc(256, 256, 3, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
+	CHECK(!GetDDSLayout(desc, 16, layout));
+}
+
+TEST(DDSLayoutMatchesSampleFile)
+{
+	std::ifstream file(Tests::TextureDirectory() + "WoodCrate01.dds", std::ios::binary);
+	REQUIRE(file);
+	std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	const DDS_HEADER* header = nullptr;
+	std::size_t headerSize = 0;
+	REQUIRE(ValidateDDSHeader(data.data(), data.size(), &header, &headerSize));
+
+	DDSTextureDesc desc;
+	REQUIRE(GetDDSTextureDesc(header, desc) == DDSStatus::Ok);
+
+	DDSLayout layout;
+	REQUIRE(GetDDSLayout(desc, 0, layout));
+	CHECK(layout.TotalBytes == data.size() - headerSize);
+	CHECK(layout.KeptBytes == layout.TotalBytes);
+	CHECK(layout.MipCount == desc.MipCount);
+}
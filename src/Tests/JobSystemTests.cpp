@@ -0,0 +1,98 @@
+//***************************************************************************************
+// JobSystemTests.cpp
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(JobSystemParallelForRunsEveryIndex)
+{
+	JobSystem jobs(3);
+
+	std::vector<std::atomic<int>> hits(1000);
+	jobs.ParallelFor((std::uint32_t)hits.size(), [&](std::uint32_t i) { hits[i].fetch_add(1); });
+
+	for(std::atomic<int>& hit : hits)
+		CHECK(hit.load() == 1);
+}
+
+TEST(JobSystemNestedWaitDoesNotDeadlock)
+{
+	// Every worker waits inside a job on jobs that only the waiting threads can run.
+	JobSystem jobs(2);
+
+	std::atomic<int> total{ 0 };
+	jobs.ParallelFor(8, [&](std::uint32_t)
+	{
+		jobs.ParallelFor(8, [&](std::uint32_t) { total.fetch_add(1); });
+	});
+
+	CHECK(total.load() == 64);
+}
+
+TEST(JobSystemWaitRethrowsJobException)
+{
+	JobSystem jobs(2);
+
+	JobCounter counter;
+	std::atomic<int> finished{ 0 };
+	for(int i = 0; i < 16; ++i)
+	{
+		jobs.Schedule([&finished, i]()
+		{
+			if(i == 5)
+				throw std::runtime_error("job 5");
+			finished.fetch_add(1);
+		}, &counter);
+	}
+
+	bool caught = false;
+	try
+	{
+		jobs.Wait(counter);
+	}
+	catch(const std::runtime_error& e)
+	{
+		caught = std::string(e.what()) == "job 5";
+	}
+
+	CHECK(caught);
+	CHECK(counter.IsDone());
+	CHECK(finished.load() == 15);
+
+	// The exception was consumed, so the counter can be reused.
+	jobs.Schedule([&finished]() { finished.fetch_add(1); }, &counter);
+	jobs.Wait(counter);
+	CHECK(finished.load() == 16);
+}
+
+TEST(JobSystemParallelForRethrowsOnCaller)
+{
+	JobSystem jobs(3);
+
+	for(std::uint32_t thrower : { 0u, 7u })
+	{
+		std::atomic<int> finished{ 0 };
+		bool caught = false;
+		try
+		{
+			jobs.ParallelFor(32, [&](std::uint32_t i)
+			{
+				if(i == thrower)
+					throw std::runtime_error("index");
+				finished.fetch_add(1);
+			});
+		}
+		catch(const std::runtime_error&)
+		{
+			caught = true;
+		}
+
+		CHECK(caught);
+		CHECK(finished.load() == 31);
+	}
+}
@@ -0,0 +1,93 @@
+//***************************************************************************************
+// Lz4Tests.cpp
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include "Lz4.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Compresses and decompresses src and returns the compressed size, or 0 on failure.
+	std::size_t RoundTrip(const std::vector<std::uint8_t>& src)
+	{
+		std::vector<std::uint8_t> packed(Lz4CompressBound(src.size()));
+		std::size_t packedSize = Lz4Compress(src.data(), src.size(), packed.data(), packed.size());
+		if(packedSize == 0)
+			return 0;
+
+		std::vector<std::uint8_t> unpacked(src.size());
+		if(!Lz4Decompress(packed.data(), packedSize, unpacked.data(), unpacked.size()) || unpacked != src)
+			return 0;
+
+		return packedSize;
+	}
+}
+
+TEST(Lz4RoundTripsRepetitiveData)
+{
+	std::vector<std::uint8_t> src(100000);
+	for(std::size_t i = 0; i < src.size(); ++i)
+		src[i] = (std::uint8_t)((i / 7) % 13);
+
+	std::size_t packedSize = RoundTrip(src);
+	CHECK(packedSize != 0);
+	CHECK(packedSize < src.size() / 4);
+
+	std::vector<std::uint8_t> zeros(65536, 0);
+	packedSize = RoundTrip(zeros);
+	CHECK(packedSize != 0);
+	CHECK(packedSize < 512);
+}
+
+TEST(Lz4RoundTripsIncompressibleData)
+{
+	std::mt19937 rng(42);
+	for(std::size_t size : { 1, 5, 12, 13, 100, 4096, 70000 })
+	{
+		std::vector<std::uint8_t> src(size);
+		for(std::uint8_t& b : src)
+			b = (std::uint8_t)rng();
+
+		std::size_t packedSize = RoundTrip(src);
+		CHECK(packedSize != 0);
+		CHECK(packedSize <= Lz4CompressBound(size));
+	}
+}
+
+TEST(Lz4RejectsCorruptInput)
+{
+	std::vector<std::uint8_t> src(4096);
+	for(std::size_t i = 0; i < src.size(); ++i)
+		src[i] = (std::uint8_t)(i % 31);
+
+	std::vector<std::uint8_t> packed(Lz4CompressBound(src.size()));
+	std::size_t packedSize = Lz4Compress(src.data(), src.size(), packed.data(), packed.size());
+	REQUIRE(packedSize != 0);
+
+	std::vector<std::uint8_t> dst(src.size() + 1);
+	CHECK(!Lz4Decompress(packed.data(), packedSize, dst.data(), src.size() + 1));
+	CHECK(!Lz4Decompress(packed.data(), packedSize, dst.data(), src.size() - 1));
+	CHECK(!Lz4Decompress(packed.data(), packedSize - 1, dst.data(), src.size()));
+
+	// Random damage must fail or decode to something, never touch memory out of bounds.
+	std::mt19937 rng(7);
+	for(int i = 0; i < 1000; ++i)
+	{
+		std::vector<std::uint8_t> damaged(packed.begin(), packed.begin() + packedSize);
+		damaged[rng() % packedSize] ^= (std::uint8_t)(1 + rng() % 255);
+		Lz4Decompress(damaged.data(), damaged.size(), dst.data(), src.size());
+	}
+}
+
+TEST(Lz4CompressFailsWhenOutputDoesNotFit)
+{
+	std::vector<std::uint8_t> src(1000);
+	std::mt19937 rng(3);
+	for(std::uint8_t& b : src)
+		b = (std::uint8_t)rng();
+
+	std::vector<std::uint8_t> packed(src.size() / 2);
+	CHECK(Lz4Compress(src.data(), src.size(), packed.data(), packed.size()) == 0);
+}
@@ -0,0 +1,40 @@
+//***************************************************************************************
+// TestFramework.h
+//
+// Minimal test registry for the portable tests.  TEST(Name) defines and registers a
+// test function; CHECK records a failure and carries on, REQUIRE returns from the
+// test.  TestMain.cpp runs every registered test and exits nonzero if any failed.
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+
+namespace Tests
+{
+	using TestFunction = void(*)();
+
+	struct Registrar
+	{
+		Registrar(const char* name, TestFunction function);
+	};
+
+	void ReportFailure(const char* file, int line, const std::string& message);
+
+	// src/Textures, with a trailing separator.
+	std::string TextureDirectory();
+
+	// Where tests may write files, with a trailing separator.
+	std::string OutputDirectory();
+}
+
+#define TEST(name) \
+	static void name(); \
+	static Tests::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(cond) \
+	do { if(!(cond)) Tests::ReportFailure(__FILE__, __LINE__, #cond); } while(0)
+
+#define REQUIRE(cond) \
+	do { if(!(cond)) { Tests::ReportFailure(__FILE__, __LINE__, #cond); return; } } while(0)
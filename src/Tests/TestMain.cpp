@@ -0,0 +1,75 @@
+//***************************************************************************************
+// TestMain.cpp
+//
+// Runs the tests registered with TEST, or only those whose names are given on the
+// command line.
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	struct TestEntry
+	{
+		const char* Name;
+		Tests::TestFunction Function;
+	};
+
+	std::vector<TestEntry>& Registry()
+	{
+		static std::vector<TestEntry> registry;
+		return registry;
+	}
+
+	int gFailures = 0;
+}
+
+Tests::Registrar::Registrar(const char* name, TestFunction function)
+{
+	Registry().push_back({ name, function });
+}
+
+void Tests::ReportFailure(const char* file, int line, const std::string& message)
+{
+	std::printf("%s(%d): check failed: %s\n", file, line, message.c_str());
+	++gFailures;
+}
+
+std::string Tests::TextureDirectory()
+{
+	return TEXTURE_DIR;
+}
+
+std::string Tests::OutputDirectory()
+{
+	return TEST_OUTPUT_DIR;
+}
+
+int main(int argc, char** argv)
+{
+	int run = 0;
+	int failed = 0;
+	for(const TestEntry& test : Registry())
+	{
+		bool selected = (argc < 2);
+		for(int i = 1; i < argc && !selected; ++i)
+			selected = std::strcmp(argv[i], test.Name) == 0;
+		if(!selected)
+			continue;
+
+		int before = gFailures;
+		test.Function();
+		++run;
+		if(gFailures != before)
+		{
+			++failed;
+			std::printf("FAILED %s\n", test.Name);
+		}
+	}
+
+	std::printf("%d of %d tests passed\n", run - failed, run);
+	return failed == 0 ? 0 : 1;
+}
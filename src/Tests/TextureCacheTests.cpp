@@ -0,0 +1,200 @@
+//***************************************************************************************
+// TextureCacheTests.cpp
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include "TextureCache.h"
+#include <map>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Serves every file as desc and records what the cache asked for.
+	class FakeBackend : public TextureCache::IBackend
+	{
+	public:
+		explicit FakeBackend(const DDSTextureDesc& desc) : Desc(desc) {}
+
+		std::uint32_t Load(const std::string&, std::uint32_t maxsize)override
+		{
+			Live[++NextId] = maxsize;
+			return NextId;
+		}
+
+		void Resize(std::uint32_t texture, std::uint32_t maxsize)override
+		{
+			Live[texture] = maxsize;
+			Resizes.push_back(maxsize);
+		}
+
+		void Release(std::uint32_t texture)override
+		{
+			Live.erase(texture);
+		}
+
+		bool GetDesc(std::uint32_t, DDSTextureDesc& desc)override
+		{
+			desc = Desc;
+			return true;
+		}
+
+		DDSTextureDesc Desc;
+		std::uint32_t NextId = 0;
+		std::map<std::uint32_t, std::uint32_t> Live; // Texture id to maxsize.
+		std::vector<std::uint32_t> Resizes;
+	};
+
+	DDSTextureDesc MakeDesc(std::uint32_t width, std::uint32_t height, std::uint32_t mipCount)
+	{
+		DDSTextureDesc desc;
+		desc.Dimension = DDS_DIMENSION_TEXTURE2D;
+		desc.Width = width;
+		desc.Height = height;
+		desc.Depth = 1;
+		desc.MipCount = mipCount;
+		desc.ArraySize = 1;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		return desc;
+	}
+}
+
+TEST(TextureCacheDeduplicatesKeys)
+{
+	FakeBackend backend(MakeDesc(64, 64, 7));
+	TextureCache cache(backend, 1 << 20);
+
+	TextureCache::Handle a = cache.Acquire("textures/a.dds");
+	TextureCache::Handle b = cache.Acquire("textures/a.dds");
+	TextureCache::Handle c = cache.Acquire("textures/a.dds", 32);
+	CHECK(a == b);
+	CHECK(a != c);
+	CHECK(backend.Live.size() == 2);
+	CHECK(cache.GetStats().Hits == 1);
+	CHECK(cache.GetStats().Misses == 2);
+
+	cache.Update();
+	CHECK(cache.Bytes(a) == TextureCache::Footprint(backend.Desc, 0));
+	CHECK(cache.Bytes(c) == TextureCache::Footprint(backend.Desc, 32));
+	CHECK(cache.GetStats().UsedBytes == cache.Bytes(a) + cache.Bytes(c));
+
+	cache.Release(a);
+	cache.Release(b);
+	cache.Release(c);
+}
+
+TEST(TextureCacheEvictsUnreferencedLeastRecentlyUsedFirst)
+{
+	FakeBackend backend(MakeDesc(64, 64, 7));
+	const std::uint64_t bytes = TextureCache::Footprint(backend.Desc, 0);
+	TextureCache cache(backend, 2 * bytes);
+
+	TextureCache::Handle a = cache.Acquire("a");
+	TextureCache::Handle b = cache.Acquire("b");
+	cache.Release(a);
+	cache.Release(b);
+	cache.Use(a);
+	cache.Update();
+	CHECK(cache.GetStats().Evictions == 0);
+
+	// A third texture pushes the total over; b was used least recently.
+	TextureCache::Handle c = cache.Acquire("c");
+	cache.Update();
+	CHECK(cache.GetStats().Evictions == 1);
+	CHECK(cache.GetStats().UsedBytes == 2 * bytes);
+	CHECK(backend.Live.size() == 2);
+
+	// b is gone, so acquiring it again misses.
+	std::uint64_t misses = cache.GetStats().Misses;
+	cache.Release(cache.Acquire("b"));
+	CHECK(cache.GetStats().Misses == misses + 1);
+
+	cache.Release(c);
+}
+
+TEST(TextureCacheShrinksReferencedTexturesAndGrowsThemBack)
+{
+	FakeBackend backend(MakeDesc(256, 256, 9));
+	TextureCache cache(backend, 1 << 20, 32);
+
+	TextureCache::Handle handle = cache.Acquire("a");
+	cache.Update();
+	const std::uint64_t fullBytes = cache.Bytes(handle);
+
+	// Referenced textures lose one mip per sweep, down to minMipSize.
+	cache.SetBudget(TextureCache::Footprint(backend.Desc, 64));
+	cache.Update();
+	CHECK(cache.CurrentMaxSize(handle) == 64);
+	CHECK(cache.Bytes(handle) == TextureCache::Footprint(backend.Desc, 64));
+	CHECK(cache.GetStats().MipDrops == 2);
+
+	cache.SetBudget(1);
+	cache.Update();
+	CHECK(cache.CurrentMaxSize(handle) == 32);
+	CHECK(cache.GetStats().OverBudgetFrames == 1);
+
+	// With room again, one mip comes back per Update.
+	backend.Resizes.clear();
+	cache.SetBudget(1 << 20);
+	for(int i = 0; i < 5; ++i)
+		cache.Update();
+	const std::vector<std::uint32_t> expected = { 64, 128, 0 };
+	CHECK(backend.Resizes == expected);
+	CHECK(cache.CurrentMaxSize(handle) == 0);
+	CHECK(cache.Bytes(handle) == fullBytes);
+	CHECK(cache.GetStats().MipRestores == 3);
+
+	cache.Release(handle);
+}
+
+TEST(TextureCacheGrowsNonPowerOfTwoChainsOneMipAtATime)
+{
+	// 300, 150, 75, 37, 18, 9, 4, 2, 1: twice a mip is not always the mip above it.
+	FakeBackend backend(MakeDesc(300, 4, 9));
+	TextureCache cache(backend, 1, 1);
+
+	TextureCache::Handle handle = cache.Acquire("a");
+	for(int i = 0; i < 10; ++i)
+		cache.Update();
+	CHECK(cache.CurrentMaxSize(handle) == 1);
+
+	backend.Resizes.clear();
+	cache.SetBudget(1 << 20);
+	for(int i = 0; i < 10; ++i)
+		cache.Update();
+	const std::vector<std::uint32_t> expected = { 2, 4, 9, 18, 37, 75, 150, 0 };
+	CHECK(backend.Resizes == expected);
+	CHECK(cache.GetStats().MipRestores == expected.size());
+	CHECK(cache.Bytes(handle) == TextureCache::Footprint(backend.Desc, 0));
+
+	cache.Release(handle);
+}
+
+TEST(TextureCacheDoesNotResizeToTheSameMips)
+{
+	// maxsize 100 keeps the 64 mip of a 128 chain and everything below, as 64 does.
+	FakeBackend backend(MakeDesc(128, 128, 8));
+	TextureCache cache(backend, 1 << 20, 1);
+
+	TextureCache::Handle handle = cache.Acquire("a", 100);
+	cache.Update();
+	CHECK(cache.CurrentMaxSize(handle) == 100);
+
+	cache.SetBudget(TextureCache::Footprint(backend.Desc, 32));
+	cache.Update();
+	CHECK(cache.CurrentMaxSize(handle) == 32);
+
+	// Growing back to 64 restores the last mip; going on to the requested 100 would
+	// reload the same mips, so the entry is just marked unshrunk.
+	backend.Resizes.clear();
+	cache.SetBudget(1 << 20);
+	for(int i = 0; i < 3; ++i)
+		cache.Update();
+	const std::vector<std::uint32_t> expected = { 64 };
+	CHECK(backend.Resizes == expected);
+	CHECK(cache.CurrentMaxSize(handle) == 100);
+	CHECK(cache.Bytes(handle) == TextureCache::Footprint(backend.Desc, 100));
+
+	cache.Release(handle);
+}
@@ -0,0 +1,184 @@
+//***************************************************************************************
+// TextureStreamerTests.cpp
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include "TextureStreamer.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace DirectX;
+
+namespace
+{
+	using State = TextureStreamer::State;
+
+	std::vector<std::uint8_t> ReadFile(const std::string& fileName)
+	{
+		std::ifstream file(fileName, std::ios::binary);
+		return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	}
+
+	// Whether texture holds the subresources of the DDS file data that survive maxsize.
+	bool MatchesFile(const TextureStreamer::LoadedTexture& texture, const std::vector<std::uint8_t>& data,
+		std::uint32_t maxsize)
+	{
+		const DDS_HEADER* header = nullptr;
+		std::size_t headerSize = 0;
+		DDSTextureDesc desc;
+		DDSLayout layout;
+		if(!ValidateDDSHeader(data.data(), data.size(), &header, &headerSize) ||
+			GetDDSTextureDesc(header, desc) != DDSStatus::Ok || !GetDDSLayout(desc, maxsize, layout))
+		{
+			return false;
+		}
+
+		if(texture.Layout.Subresources.size() != layout.Subresources.size() ||
+			texture.Bits.size() != layout.KeptBytes)
+		{
+			return false;
+		}
+
+		for(std::size_t i = 0; i < layout.Subresources.size(); ++i)
+		{
+			const DDSSubresource& kept = texture.Layout.Subresources[i];
+			const DDSSubresource& file = layout.Subresources[i];
+			if(kept.Width != file.Width || kept.Height != file.Height || kept.Size != file.Size ||
+				std::memcmp(texture.Bits.data() + kept.Offset, data.data() + headerSize + file.Offset, (std::size_t)file.Size) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const char* const SampleTextures[] = { "WoodCrate01.dds", "checkboard.dds", "grasscube1024.dds" };
+}
+
+TEST(TextureStreamerLoadTextureCopiesKeptSubresources)
+{
+	for(const char* name : SampleTextures)
+	{
+		const std::string fileName = Tests::TextureDirectory() + name;
+		const std::vector<std::uint8_t> data = ReadFile(fileName);
+		REQUIRE(!data.empty());
+
+		for(std::uint32_t maxsize : { 0u, 64u })
+		{
+			TextureStreamer::LoadedTexture texture;
+			std::string error;
+			REQUIRE(TextureStreamer::LoadTexture(fileName, maxsize, texture, error));
+			CHECK(MatchesFile(texture, data, maxsize));
+
+			// Offsets are rebased onto Bits, which holds the kept subresources back to back.
+			std::uint64_t offset = 0;
+			for(const DDSSubresource& sub : texture.Layout.Subresources)
+			{
+				CHECK(sub.Offset == offset);
+				offset += sub.Size;
+			}
+			CHECK(offset == texture.Bits.size());
+		}
+	}
+}
+
+TEST(TextureStreamerLoadTextureReportsErrors)
+{
+	TextureStreamer::LoadedTexture texture;
+	std::string error;
+	CHECK(!TextureStreamer::LoadTexture(Tests::TextureDirectory() + "missing.dds", 0, texture, error));
+	CHECK(!error.empty());
+
+	// A bitmap is not a DDS file.
+	error.clear();
+	CHECK(!TextureStreamer::LoadTexture(Tests::TextureDirectory() + "tree0.bmp", 0, texture, error));
+	CHECK(!error.empty());
+}
+
+TEST(TextureStreamerArchiveLoadsMatchLooseFiles)
+{
+	JobSystem jobs(2);
+
+	for(bool compress : { false, true })
+	{
+		const std::string archiveName = Tests::OutputDirectory() +
+			(compress ? "StreamerTestLz4.tarc" : "StreamerTest.tarc");
+
+		TextureArchiveBuilder builder;
+		std::string error;
+		for(const char* name : SampleTextures)
+			REQUIRE(builder.AddFile(name, Tests::TextureDirectory() + name, error));
+		builder.SetCompression(compress, 16 * 1024);
+		REQUIRE(builder.Write(archiveName, error, &jobs));
+
+		TextureArchive archive;
+		REQUIRE(archive.Open(archiveName, error));
+		REQUIRE(archive.EntryCount() == 3);
+
+		bool anyCompressed = false;
+		for(const char* name : SampleTextures)
+		{
+			const std::vector<std::uint8_t> data = ReadFile(Tests::TextureDirectory() + name);
+			std::uint32_t entry = archive.Find(name);
+			REQUIRE(entry != TextureArchive::NotFound);
+			anyCompressed = anyCompressed || archive.IsCompressed(entry);
+
+			for(std::uint32_t maxsize : { 0u, 64u })
+			{
+				TextureStreamer::LoadedTexture texture;
+				CHECK(TextureStreamer::LoadTexture(archive, entry, maxsize, texture, error, &jobs));
+				CHECK(MatchesFile(texture, data, maxsize));
+
+				TextureStreamer::LoadedTexture serial;
+				CHECK(TextureStreamer::LoadTexture(archive, entry, maxsize, serial, error));
+				CHECK(serial.Bits == texture.Bits);
+			}
+		}
+		CHECK(anyCompressed == compress);
+	}
+}
+
+TEST(TextureStreamerHandlesGoStaleOnRelease)
+{
+	const std::string fileName = Tests::TextureDirectory() + "WoodCrate01.dds";
+	TextureStreamer streamer(2);
+
+	TextureStreamer::Handle first = streamer.Request(fileName);
+	streamer.WaitIdle();
+	CHECK(streamer.GetState(first) == State::Loaded);
+
+	std::vector<TextureStreamer::LoadedTexture> loaded;
+	CHECK(streamer.TakeLoaded(loaded) == 1);
+	CHECK(loaded[0].Id == first);
+	CHECK(streamer.GetState(first) == State::Uploading);
+
+	// Released while uploading: the slot is held until the upload stage reports back.
+	streamer.Release(first);
+	CHECK(streamer.GetState(first) == State::Invalid);
+	streamer.MarkResident(first);
+
+	TextureStreamer::Handle second = streamer.Request(fileName);
+	CHECK(TextureStreamer::SlotIndex(second) == TextureStreamer::SlotIndex(first));
+	CHECK(second != first);
+	CHECK(streamer.GetState(first) == State::Invalid);
+
+	streamer.WaitIdle();
+	CHECK(streamer.GetState(second) == State::Loaded);
+
+	// A loaded texture released before it is taken is discarded.
+	streamer.Release(second);
+	loaded.clear();
+	CHECK(streamer.TakeLoaded(loaded) == 0);
+
+	TextureStreamer::Handle missing = streamer.Request(Tests::TextureDirectory() + "missing.dds");
+	streamer.WaitIdle();
+	CHECK(streamer.GetState(missing) == State::Failed);
+	CHECK(!streamer.GetError(missing).empty());
+	streamer.Release(missing);
+
+	TextureStreamer::Stats stats = streamer.GetStats();
+	CHECK(stats.Requests == 3);
+	CHECK(stats.Loaded == 2);
+	CHECK(stats.Failed == 1);
+}